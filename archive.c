@@ -0,0 +1,415 @@
+/*
+ * archive.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "archive.h"
+#include "chebfile.h"
+#include "elp2000-82b.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAX_QUANTIZED 4.0e18        // maximum magnitude of quantized values, leaving room for their differences
+#define STREAM_WORDS (1 + ARCHIVE_MAX_ORDER + ARCHIVE_BLOCK_EPOCHS + 1)    // maximum size of a stream, words
+
+/*
+ * A datatype describing the header of an encoded coordinate of a block (a stream). The header is followed by order
+ * leading values of the difference table and by words of packed residuals, the last of which is padding.
+ */
+typedef struct {
+    uint8_t order;              // order of differences
+    uint8_t width;              // width of a packed residual, bits
+    uint16_t reserved;          // zero
+    uint32_t words;             // amount of words of packed residuals
+} stream_header;
+
+/*
+ * Returns amount of words holding n residuals of the given width, including a word of padding which lets the
+ * unpacking routine read the word following the last residual unconditionally.
+ */
+static uint32_t packed_words(int width, int n)
+{
+    return (uint32_t)(((uint64_t)width * n + 63) / 64) + 1;
+}
+
+/*
+ * Replaces values a[k..n-1] by their differences of order k + 1, given differences of order k. Values are unsigned,
+ * so that differences wrap around rather than overflow.
+ */
+static void difference(uint64_t a[], int n, int k)
+{
+    int i;                      // loop index variable
+
+    for (i = n - 1; i > k; i--)
+        a[i] -= a[i - 1];
+}
+
+/*
+ * Encodes n quantized values of a coordinate of a block into the given buffer. Returns amount of words written.
+ */
+static size_t encode_stream(const int64_t q[], int n, uint64_t out[])
+{
+    uint64_t a[ARCHIVE_BLOCK_EPOCHS];   // difference table
+    uint64_t zigzag;                    // residual mapped to an unsigned integer
+    uint64_t bits;                      // bit offset of the current residual
+    stream_header header;               // header of the stream
+    size_t cost, best_cost;             // sizes of the stream, words
+    int width, best_width;              // widths of residuals
+    int order, best_order;              // orders of differences
+    int i;                              // loop index variable
+
+    // trying orders of differences one by one, each computed from the previous one
+    for (i = 0; i < n; i++)
+        a[i] = (uint64_t)q[i];
+    for (order = 0, best_order = 0, best_width = 64, best_cost = SIZE_MAX; order <= ARCHIVE_MAX_ORDER && order <= n;
+         order++){
+        for (i = order, width = 0; i < n; i++){
+            zigzag = (a[i] << 1) ^ (uint64_t)((int64_t)a[i] >> 63);
+            while (width < 64 && (zigzag >> width) != 0)
+                width++;
+        }
+        cost = order + packed_words(width, n - order);
+        if (cost < best_cost){
+            best_cost = cost;
+            best_order = order;
+            best_width = width;
+        }
+        if (order < n)
+            difference(a, n, order);
+    }
+
+    for (i = 0; i < n; i++)
+        a[i] = (uint64_t)q[i];
+    for (order = 0; order < best_order; order++)
+        difference(a, n, order);
+
+    memset(&header, 0, sizeof(header));
+    header.order = best_order;
+    header.width = best_width;
+    header.words = packed_words(best_width, n - best_order);
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + 1, a, sizeof(uint64_t) * best_order);
+
+    // packing residuals from the lowest bits of the words up; a residual may span two words
+    out += 1 + best_order;
+    memset(out, 0, sizeof(uint64_t) * header.words);
+    for (i = best_order, bits = 0; i < n && best_width > 0; i++, bits += best_width){
+        zigzag = (a[i] << 1) ^ (uint64_t)((int64_t)a[i] >> 63);
+        out[bits >> 6] |= zigzag << (bits & 63);
+        if ((bits & 63) + best_width > 64)
+            out[(bits >> 6) + 1] |= zigzag >> (64 - (bits & 63));
+    }
+
+    return 1 + best_order + header.words;
+}
+
+/*
+ * Decodes the first n values of a coordinate of a block from the stream starting at the given word, which must not
+ * reach beyond the given end. Returns pointer to the following stream, or NULL if the stream is malformed.
+ */
+static const uint64_t *decode_stream(const uint64_t *in, const uint64_t *end, int block_epochs, int n, int64_t q[])
+{
+    uint64_t a[ARCHIVE_BLOCK_EPOCHS];   // difference table
+    const uint64_t *words;              // packed residuals
+    stream_header header;               // header of the stream
+    uint64_t mask;                      // mask of the bits of a residual
+    uint64_t bits;                      // bit offset of the current residual
+    int order, width;                   // order of differences and width of residuals
+    int i, k;                           // loop index variables
+
+    if (end - in < 1)
+        return NULL;
+    memcpy(&header, in, sizeof(header));
+    order = header.order;
+    width = header.width;
+    if (order > ARCHIVE_MAX_ORDER || order > block_epochs || width > 64 ||
+        header.words != packed_words(width, block_epochs - order) || end - in < 1 + order + (ptrdiff_t)header.words)
+        return NULL;
+
+    memcpy(a, in + 1, sizeof(uint64_t) * (order < n ? order : n));
+
+    // unpacking residuals; each of them is computed independently of the others, the word following the last one is
+    // padding, and shifting by 1 and 63 - s rather than by 64 - s keeps shifts in range when s is zero
+    words = in + 1 + order;
+    mask = width == 64 ? ~0ULL : (1ULL << width) - 1;
+    for (i = order; i < n; i++){
+        bits = (uint64_t)(i - order) * width;
+        a[i] = ((words[bits >> 6] >> (bits & 63)) | ((words[(bits >> 6) + 1] << 1) << (63 - (bits & 63)))) & mask;
+    }
+    for (i = order; i < n; i++)
+        a[i] = (a[i] >> 1) ^ (0 - (a[i] & 1));
+
+    // restoring values by prefix sums, from the highest order of differences down
+    for (k = order; k > 0; k--)
+        for (i = k; i < n; i++)
+            a[i] += a[i - 1];
+
+    for (i = 0; i < n; i++)
+        q[i] = (int64_t)a[i];
+
+    return in + 1 + order + header.words;
+}
+
+int archive_write(const char *path, double start, double step, int64_t epochs, int frame, double tolerance,
+                  const chebyshev_ephemeris *source)
+{
+    archive_header header;              // header of the file
+    double t[ARCHIVE_BLOCK_EPOCHS];     // epochs of a block
+    double positions[3 * ARCHIVE_BLOCK_EPOCHS];     // positions at epochs of a block
+    int64_t q[3][ARCHIVE_BLOCK_EPOCHS]; // quantized coordinates of a block
+    uint64_t *index;                    // offsets of the blocks and offset of the index, followed by checksums
+    uint64_t *block;                    // encoded block
+    size_t words;                       // size of the encoded block, words
+    double quantum;                     // quantization step
+    double value;                       // quantized coordinate before rounding
+    uint64_t blocks;                    // amount of blocks
+    uint64_t b;                         // index of the current block
+    int64_t first;                      // first epoch of the current block
+    int n;                              // amount of epochs of the current block
+    int i, k;                           // loop index variables
+    char *temporary;                    // temporary name of the file
+    FILE *file;                         // output file
+    int fd;                             // descriptor of the output file
+    int error;                          // error of writing
+
+    if (epochs < 1 || !(step > 0.0) || !(tolerance > 0.0) || frame < 0 || frame >= TOTAL_ELP_FRAMES)
+        return ARCHIVE_FORMAT_ERROR;
+    // approximations are extrapolated silently, thus they must cover all epochs in the frame of the archive
+    if (source != NULL && (source->frame != frame || !(start >= source->start) ||
+                           !(start + (epochs - 1) * step <= source->start + source->granules * source->granule)))
+        return ARCHIVE_FORMAT_ERROR;
+
+    blocks = (epochs + ARCHIVE_BLOCK_EPOCHS - 1) / ARCHIVE_BLOCK_EPOCHS;
+    quantum = 2.0 * tolerance;
+    index = malloc(sizeof(uint64_t) * (2 * blocks + 1));
+    block = malloc(sizeof(uint64_t) * 3 * STREAM_WORDS);
+    if (index == NULL || block == NULL || (fd = chebyshev_file_create_temporary(path, &temporary)) < 0){
+        free(index);
+        free(block);
+        return ARCHIVE_IO_ERROR;
+    }
+    if ((file = fdopen(fd, "wb")) == NULL){
+        close(fd);
+        unlink(temporary);
+        free(index);
+        free(block);
+        free(temporary);
+        return ARCHIVE_IO_ERROR;
+    }
+
+    // the header is written last, when offsets and checksums are known
+    memset(&header, 0, sizeof(header));
+    error = fwrite(&header, sizeof(header), 1, file) != 1 ? ARCHIVE_IO_ERROR : 0;
+
+    for (b = 0, index[0] = sizeof(header); b < blocks && !error; b++){
+        first = b * ARCHIVE_BLOCK_EPOCHS;
+        n = epochs - first < ARCHIVE_BLOCK_EPOCHS ? epochs - first : ARCHIVE_BLOCK_EPOCHS;
+        for (i = 0; i < n; i++)
+            t[i] = start + (first + i) * step;
+        if (source != NULL)
+            for (i = 0; i < n; i++)
+                chebyshev_evaluate(source, t[i], &positions[3 * i], NULL);
+        else
+            geocentric_moon_positions(t, n, frame, positions);
+
+        for (i = 0; i < n && !error; i++)
+            for (k = 0; k < 3; k++){
+                value = positions[3 * i + k] / quantum;
+                if (!(fabs(value) < MAX_QUANTIZED))
+                    error = ARCHIVE_FORMAT_ERROR;
+                q[k][i] = error ? 0 : llround(value);
+            }
+
+        for (k = 0, words = 0; k < 3; k++)
+            words += encode_stream(q[k], n, block + words);
+        index[blocks + 1 + b] = chebyshev_file_checksum(block, sizeof(uint64_t) * words);
+        index[b + 1] = index[b] + sizeof(uint64_t) * words;
+        if (!error && fwrite(block, sizeof(uint64_t), words, file) != words)
+            error = ARCHIVE_IO_ERROR;
+    }
+
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.byte_order = ARCHIVE_BYTE_ORDER;
+    header.version = ARCHIVE_VERSION;
+    header.header_size = sizeof(header);
+    header.frame = frame;
+    header.block_epochs = ARCHIVE_BLOCK_EPOCHS;
+    header.epochs = epochs;
+    header.start = start;
+    header.step = step;
+    header.tolerance = tolerance;
+    header.blocks = blocks;
+    header.index_offset = index[blocks];
+    header.index_checksum = chebyshev_file_checksum(index, sizeof(uint64_t) * (2 * blocks + 1));
+    header.header_checksum = chebyshev_file_checksum(&header, offsetof(archive_header, header_checksum));
+
+    if (!error && (fwrite(index, sizeof(uint64_t), 2 * blocks + 1, file) != 2 * blocks + 1 ||
+                   fseek(file, 0, SEEK_SET) || fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) ||
+                   fsync(fileno(file))))
+        error = ARCHIVE_IO_ERROR;
+    if (fclose(file) != 0 && !error)
+        error = ARCHIVE_IO_ERROR;
+
+    // publishing the complete file under its name
+    if (!error && rename(temporary, path) != 0)
+        error = ARCHIVE_IO_ERROR;
+    if (error)
+        unlink(temporary);
+
+    free(index);
+    free(block);
+    free(temporary);
+
+    return error;
+}
+
+int archive_open(const char *path, archive *a)
+{
+    const archive_header *header;   // header of the mapped file
+    const uint64_t *offsets;        // offsets of the blocks
+    struct stat status;             // status of the file
+    void *mapping;                  // mapped file
+    uint64_t b;                     // loop index variable
+    int fd;                         // descriptor of the file
+    int error;                      // error found in the header or the index
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return ARCHIVE_IO_ERROR;
+    if (fstat(fd, &status) < 0){
+        close(fd);
+        return ARCHIVE_IO_ERROR;
+    }
+    if ((size_t)status.st_size < sizeof(archive_header)){
+        close(fd);
+        return ARCHIVE_FORMAT_ERROR;
+    }
+
+    mapping = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return ARCHIVE_IO_ERROR;
+
+    // checking the header, then the index, so that decoding needs to check only the blocks themselves
+    header = mapping;
+    offsets = (const uint64_t *)((const char *)mapping + header->index_offset);
+    error = 0;
+    if (memcmp(header->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0)
+        error = ARCHIVE_FORMAT_ERROR;
+    else if (header->byte_order != ARCHIVE_BYTE_ORDER)
+        error = ARCHIVE_BYTE_ORDER_ERROR;
+    else if (header->version != ARCHIVE_VERSION || header->header_size != sizeof(archive_header))
+        error = ARCHIVE_VERSION_ERROR;
+    else if (header->header_checksum != chebyshev_file_checksum(header, offsetof(archive_header, header_checksum)))
+        error = ARCHIVE_CHECKSUM_ERROR;
+    else if (header->frame < 0 || header->frame >= TOTAL_ELP_FRAMES || header->block_epochs < 1 ||
+             header->block_epochs > ARCHIVE_BLOCK_EPOCHS || header->epochs < 1 ||
+             header->blocks != (uint64_t)(header->epochs + header->block_epochs - 1) / header->block_epochs ||
+             header->index_offset % sizeof(uint64_t) != 0 || header->index_offset < sizeof(archive_header) ||
+             header->index_offset > (uint64_t)status.st_size ||
+             ((uint64_t)status.st_size - header->index_offset) / sizeof(uint64_t) < 2 * header->blocks + 1)
+        error = ARCHIVE_FORMAT_ERROR;
+    else if (header->index_checksum != chebyshev_file_checksum(offsets, sizeof(uint64_t) * (2 * header->blocks + 1)))
+        error = ARCHIVE_CHECKSUM_ERROR;
+    else if (offsets[0] != sizeof(archive_header) || offsets[header->blocks] != header->index_offset)
+        error = ARCHIVE_FORMAT_ERROR;
+    for (b = 0; b < header->blocks && !error; b++)
+        if (offsets[b + 1] < offsets[b] || offsets[b + 1] % sizeof(uint64_t) != 0)
+            error = ARCHIVE_FORMAT_ERROR;
+
+    if (error){
+        munmap(mapping, status.st_size);
+        return error;
+    }
+
+    a->header = header;
+    a->offsets = offsets;
+    a->checksums = offsets + header->blocks + 1;
+    a->size = status.st_size;
+
+    return 0;
+}
+
+int archive_verify(const archive *a)
+{
+    uint64_t b;                 // loop index variable
+
+    for (b = 0; b < a->header->blocks; b++)
+        if (chebyshev_file_checksum((const char *)a->header + a->offsets[b], a->offsets[b + 1] - a->offsets[b]) !=
+            a->checksums[b])
+            return ARCHIVE_CHECKSUM_ERROR;
+
+    return 0;
+}
+
+/*
+ * Decodes positions of the first n epochs of the given block into the given array. Returns zero on success or
+ * ARCHIVE_FORMAT_ERROR if the block is malformed.
+ */
+static int decode_block(const archive *a, uint64_t block, int n, double positions[])
+{
+    const uint64_t *in = (const uint64_t *)((const char *)a->header + a->offsets[block]);
+    const uint64_t *end = (const uint64_t *)((const char *)a->header + a->offsets[block + 1]);
+    int64_t q[ARCHIVE_BLOCK_EPOCHS];    // quantized values of a coordinate
+    int64_t remaining;                  // amount of epochs starting with the block
+    double quantum;                     // quantization step
+    int epochs;                         // amount of epochs of the block
+    int i, k;                           // loop index variables
+
+    remaining = a->header->epochs - (int64_t)block * a->header->block_epochs;
+    epochs = remaining < a->header->block_epochs ? remaining : a->header->block_epochs;
+    quantum = 2.0 * a->header->tolerance;
+
+    for (k = 0; k < 3; k++){
+        if ((in = decode_stream(in, end, epochs, n, q)) == NULL)
+            return ARCHIVE_FORMAT_ERROR;
+        for (i = 0; i < n; i++)
+            positions[3 * i + k] = q[i] * quantum;
+    }
+
+    return 0;
+}
+
+int archive_decode_block(const archive *a, uint64_t block, double positions[])
+{
+    int64_t remaining;          // amount of epochs starting with the block
+    int n;                      // amount of epochs of the block
+
+    if (block >= a->header->blocks)
+        return ARCHIVE_FORMAT_ERROR;
+
+    remaining = a->header->epochs - (int64_t)block * a->header->block_epochs;
+    n = remaining < a->header->block_epochs ? remaining : a->header->block_epochs;
+
+    return decode_block(a, block, n, positions) < 0 ? ARCHIVE_FORMAT_ERROR : n;
+}
+
+int archive_position(const archive *a, int64_t epoch, double position[])
+{
+    double positions[3 * ARCHIVE_BLOCK_EPOCHS];     // positions of the epochs of the block up to the given one
+    int i;                                          // index of the epoch within its block
+
+    if (epoch < 0 || epoch >= a->header->epochs)
+        return ARCHIVE_FORMAT_ERROR;
+
+    i = epoch % a->header->block_epochs;
+    if (decode_block(a, epoch / a->header->block_epochs, i + 1, positions) < 0)
+        return ARCHIVE_FORMAT_ERROR;
+    memcpy(position, &positions[3 * i], sizeof(double) * 3);
+
+    return 0;
+}
+
+void archive_close(archive *a)
+{
+    munmap((void *)a->header, a->size);
+    a->header = NULL;
+    a->offsets = a->checksums = NULL;
+}
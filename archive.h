@@ -0,0 +1,125 @@
+/*
+ * archive.h
+ *
+ * This file contains routines to write dense series of positions of the Moon, equally spaced in time, into compact
+ * archive files and to read positions of single epochs back without decoding the whole file.
+ *
+ * Each coordinate is quantized to integer multiples of twice the tolerance, thus decoded positions differ from the
+ * encoded ones by at most the tolerance. Epochs are split into blocks of ARCHIVE_BLOCK_EPOCHS. Within a block each
+ * coordinate is predicted by a polynomial of low order through the previous epochs: the quantized values are replaced
+ * by their differences of order k (0 to ARCHIVE_MAX_ORDER), leaving the first k values of the difference table as they
+ * are. The order giving the smallest block is chosen for each block and coordinate. The residuals are mapped to
+ * unsigned integers (zigzag) and packed with the least amount of bits holding all of them. Since all residuals of a
+ * block have the same width, they are unpacked independently of each other, which suits vectorizing compilers;
+ * positions are then restored by k passes of prefix sums.
+ *
+ * A file starts with a header of fixed layout, followed by the blocks and the index of their offsets and checksums, so
+ * that a reader maps the file, finds the block of an epoch by the index and decodes only the epochs of the block up to
+ * the requested one. Values are stored in the byte order of the writer, which is tagged in the header.
+ */
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "chebyshev.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARCHIVE_MAGIC "ELPARCH"             // signature of the files, followed by a zero byte
+#define ARCHIVE_VERSION 1                   // version of the layout of the files
+#define ARCHIVE_BYTE_ORDER 0x01020304       // tag of the byte order, read back as 0x04030201 on foreign systems
+#define ARCHIVE_BLOCK_EPOCHS 1024           // amount of epochs of a block
+#define ARCHIVE_MAX_ORDER 3                 // maximum order of the predicting polynomials
+
+/*
+ * An enumeration of errors of the routines handling archives.
+ */
+enum Archive_errors {
+    ARCHIVE_IO_ERROR = -1,              // file could not be opened, read, written or mapped
+    ARCHIVE_FORMAT_ERROR = -2,          // file is not an archive, is truncated or the arguments are invalid
+    ARCHIVE_VERSION_ERROR = -3,         // file has unsupported version
+    ARCHIVE_BYTE_ORDER_ERROR = -4,      // file was written on a system of the other byte order
+    ARCHIVE_CHECKSUM_ERROR = -5         // file is corrupted
+};
+
+/*
+ * A datatype describing the header of an archive.
+ */
+typedef struct {
+    char magic[8];                  // ARCHIVE_MAGIC
+    uint32_t byte_order;            // ARCHIVE_BYTE_ORDER
+    uint32_t version;               // ARCHIVE_VERSION
+    uint32_t header_size;           // size of the header, bytes
+    int32_t frame;                  // coordinates and reference frame of positions (one of ELP_frames)
+    int32_t block_epochs;           // amount of epochs of a block
+    int32_t reserved;               // zero
+    int64_t epochs;                 // amount of epochs
+    double start;                   // first epoch, Julian centuries since J2000
+    double step;                    // interval between epochs, Julian centuries
+    double tolerance;               // maximum error of decoded positions in units of the coordinates of the frame
+    uint64_t blocks;                // amount of blocks
+    uint64_t index_offset;          // offset of the index from the beginning of the file, bytes
+    uint64_t index_checksum;        // checksum of the index
+    uint64_t header_checksum;       // checksum of all the previous fields of the header
+} archive_header;
+
+/*
+ * A datatype describing a mapped archive.
+ */
+typedef struct {
+    const archive_header *header;   // header of the file
+    const uint64_t *offsets;        // offsets of the blocks from the beginning of the file and offset of the index
+    const uint64_t *checksums;      // checksums of the blocks
+    size_t size;                    // size of the mapping, bytes
+} archive;
+
+/*
+ * Writes positions of the Moon in the given frame at the given amount of epochs start + i·step (Julian centuries since
+ * J2000) into an archive with the given path, within the given tolerance. Positions are computed from the given
+ * Chebyshev approximation, which must cover the epochs within a fraction of the tolerance, or from the series if it is
+ * NULL. The file is written under a temporary name and renamed when complete.
+ * Returns zero on success or one of Archive_errors; ARCHIVE_FORMAT_ERROR also if the approximation is of another frame
+ * or does not span all epochs.
+ */
+int archive_write(const char *path, double start, double step, int64_t epochs, int frame, double tolerance,
+                  const chebyshev_ephemeris *source);
+
+/*
+ * Maps the archive with the given path into memory, read only, and checks its header and index.
+ * Returns zero on success or one of Archive_errors.
+ */
+int archive_open(const char *path, archive *a);
+
+/*
+ * Checks the checksums of all blocks of a mapped archive, reading the whole file.
+ * Returns zero if the file is intact or ARCHIVE_CHECKSUM_ERROR otherwise.
+ */
+int archive_verify(const archive *a);
+
+/*
+ * Decodes positions of all epochs of the given block into the given array, three coordinates per epoch.
+ * Returns the amount of decoded epochs or ARCHIVE_FORMAT_ERROR if the block does not exist or is malformed.
+ */
+int archive_decode_block(const archive *a, uint64_t block, double positions[]);
+
+/*
+ * Decodes position of the Moon at the given epoch (start + epoch·step) of the archive.
+ * Returns zero on success or ARCHIVE_FORMAT_ERROR if the epoch does not exist or its block is malformed.
+ */
+int archive_position(const archive *a, int64_t epoch, double position[]);
+
+/*
+ * Unmaps a mapped archive.
+ */
+void archive_close(archive *a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARCHIVE_H
@@ -41,6 +41,10 @@
 #ifndef ARGUMENTS_H
 #define ARGUMENTS_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define TOTAL_ELP2000_ARGUMENTS 5       // total amount of ELP arguments: W₁, W₂, W₃, T and ϖ'
 #define TOTAL_DELAUNAY_ARGUMENTS 4      // total amount of Delaunay arguments: D, l', l and F
 #define TOTAL_PLANETARY_ARGUMENTS 8     // total amount of planetary arguments for each planet in the Solar system
@@ -48,6 +52,23 @@
 #define FULL_SERIES_TOTAL_TERMS 5
 #define LINEAR_SERIES_TOTAL_TERMS 2
 
+/*
+ * Precession constant in J2000 (p), measured in arcseconds per Julian century.
+ */
+extern const double precession_constant;
+
+/*
+ * Coefficients of the polynomials of ELP 2000 arguments W₁, W₂, W₃, T and ϖ', FULL_SERIES_TOTAL_TERMS coefficients per
+ * argument, measured in arcseconds.
+ */
+extern const double elp2000_arguments_coefficients[TOTAL_ELP2000_ARGUMENTS * FULL_SERIES_TOTAL_TERMS];
+
+/*
+ * Coefficients of the linear polynomials of planetary arguments, LINEAR_SERIES_TOTAL_TERMS coefficients per planet,
+ * measured in arcseconds.
+ */
+extern const double planetary_arguments_coefficients[TOTAL_PLANETARY_ARGUMENTS * LINEAR_SERIES_TOTAL_TERMS];
+
 /*
  * An enumeration indexing ELP 2000 arguments.
  */
@@ -104,4 +125,8 @@ void compute_elp2000_arguments(double t, int n, double arguments[]);
  */
 void compute_planetary_arguments(double t, double arguments[]);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // ARGUMENTS_H
\ No newline at end of file
@@ -0,0 +1,317 @@
+/*
+ * async.c
+ */
+
+#include "async.h"
+#include "elp2000-82b.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * A datatype holding a submitted request.
+ */
+struct async_request {
+    const double *t;                // time instants
+    int n;                          // amount of time instants
+    int frame;                      // reference frame of the output
+    double threshold;               // amplitude threshold of the terms to be computed
+    double *positions;              // output positions, three values per time instant
+    async_callback callback;        // routine called on completion, NULL for requests waited for through handles
+    void *data;                     // user defined data given to the callback
+    int complete;                   // non zero once positions are computed
+    struct async_request *next;     // next request in the queue or in the batch
+};
+
+/*
+ * State of the queue of requests and of the dispatcher thread. All fields are protected by the mutex.
+ */
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t submitted;       // signalled when a request is queued or the dispatcher is to stop
+    pthread_cond_t completed;       // signalled when requests are complete or the dispatcher has stopped
+    async_request *head;            // first queued request
+    async_request *tail;            // last queued request
+    int queued_epochs;              // amount of time instants of all queued requests
+    int window;                     // coalescing window, measured in microseconds
+    int max_batch_epochs;           // amount of time instants that completes a batch
+    int running;                    // non zero while the dispatcher thread is running
+    int stopping;                   // non zero while the dispatcher thread is asked to stop
+} queue = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .completed = PTHREAD_COND_INITIALIZER,
+    .window = ASYNC_COALESCING_WINDOW,
+    .max_batch_epochs = ASYNC_MAX_BATCH_EPOCHS
+};
+
+static pthread_once_t queue_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Initializes the condition the dispatcher waits on, measuring its timeouts with the monotonic clock.
+ */
+static void initialize_queue(void)
+{
+    pthread_condattr_t attributes;  // attributes of the condition
+
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&queue.submitted, &attributes);
+    pthread_condattr_destroy(&attributes);
+}
+
+/*
+ * Completes the given request: calls and frees callback requests and marks others complete.
+ */
+static void complete_request(async_request *request)
+{
+    if (request->callback != NULL){
+        request->callback(request->data);
+        free(request);
+        return;
+    }
+
+    pthread_mutex_lock(&queue.mutex);
+    request->complete = 1;
+    pthread_cond_broadcast(&queue.completed);
+    pthread_mutex_unlock(&queue.mutex);
+}
+
+/*
+ * Computes a batch of requests. Requests with the same frame and threshold are computed together with a single call
+ * to geocentric_moon_positions_truncated.
+ */
+static void compute_batch(async_request *batch)
+{
+    async_request *group;           // requests with the same frame and threshold as the first one of the batch
+    async_request **last;           // link to the last request of the group
+    async_request **link;           // link to the current request of the batch
+    async_request *request;         // current request
+    double *t, *positions;          // time instants and positions of the group
+    int n;                          // amount of time instants of the group
+
+    while (batch != NULL){
+        // moving requests with the same frame and threshold as the first one from the batch into the group
+        group = batch;
+        batch = batch->next;
+        group->next = NULL;
+        last = &group->next;
+        n = group->n;
+        for (link = &batch; *link != NULL;){
+            request = *link;
+            if (request->frame == group->frame && request->threshold == group->threshold){
+                *link = request->next;
+                request->next = NULL;
+                *last = request;
+                last = &request->next;
+                n += request->n;
+            } else
+                link = &request->next;
+        }
+
+        // gathering time instants of the group, computing them at once and scattering positions back
+        t = group->next != NULL ? malloc(n * sizeof(double)) : NULL;
+        positions = t != NULL ? malloc(3 * n * sizeof(double)) : NULL;
+        if (positions != NULL){
+            for (request = group, n = 0; request != NULL; n += request->n, request = request->next)
+                memcpy(&t[n], request->t, request->n * sizeof(double));
+            geocentric_moon_positions_truncated(t, n, group->frame, group->threshold, positions);
+            for (request = group, n = 0; request != NULL; n += request->n, request = request->next)
+                memcpy(request->positions, &positions[3 * n], 3 * request->n * sizeof(double));
+        } else {
+            for (request = group; request != NULL; request = request->next)
+                geocentric_moon_positions_truncated(request->t, request->n, request->frame, request->threshold,
+                                                    request->positions);
+        }
+        free(t);
+        free(positions);
+
+        while (group != NULL){
+            request = group;
+            group = group->next;
+            complete_request(request);
+        }
+    }
+}
+
+static void *dispatcher(void *argument)
+{
+    async_request *batch;           // requests taken from the queue
+    struct timespec deadline;       // end of the coalescing window
+
+    (void)argument;
+    pthread_mutex_lock(&queue.mutex);
+
+    for (;;){
+        while (queue.head == NULL && !queue.stopping)
+            pthread_cond_wait(&queue.submitted, &queue.mutex);
+        if (queue.head == NULL)
+            break;
+
+        // waiting for more requests until the window ends or the batch is large enough
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += queue.window * 1000L;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+        deadline.tv_nsec %= 1000000000L;
+        while (!queue.stopping && queue.queued_epochs < queue.max_batch_epochs)
+            if (pthread_cond_timedwait(&queue.submitted, &queue.mutex, &deadline) == ETIMEDOUT)
+                break;
+
+        batch = queue.head;
+        queue.head = queue.tail = NULL;
+        queue.queued_epochs = 0;
+
+        pthread_mutex_unlock(&queue.mutex);
+        compute_batch(batch);
+        pthread_mutex_lock(&queue.mutex);
+    }
+
+    queue.running = 0;
+    pthread_cond_broadcast(&queue.completed);
+    pthread_mutex_unlock(&queue.mutex);
+
+    return NULL;
+}
+
+/*
+ * Queues the given request, starting the dispatcher thread if needed. Returns zero on success.
+ */
+static int queue_request(async_request *request)
+{
+    pthread_t thread;               // dispatcher thread
+    pthread_attr_t attributes;      // attributes of the dispatcher thread
+
+    pthread_once(&queue_once, initialize_queue);
+    pthread_mutex_lock(&queue.mutex);
+
+    if (!queue.running){
+        pthread_attr_init(&attributes);
+        pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+        queue.running = pthread_create(&thread, &attributes, dispatcher, NULL) == 0;
+        pthread_attr_destroy(&attributes);
+        if (!queue.running){
+            pthread_mutex_unlock(&queue.mutex);
+            return -1;
+        }
+    }
+
+    request->next = NULL;
+    if (queue.tail != NULL)
+        queue.tail->next = request;
+    else
+        queue.head = request;
+    queue.tail = request;
+    queue.queued_epochs += request->n;
+
+    pthread_cond_signal(&queue.submitted);
+    pthread_mutex_unlock(&queue.mutex);
+
+    return 0;
+}
+
+/*
+ * Allocates a request with the given parameters.
+ */
+static async_request *create_request(const double t[], int n, int frame, double threshold, double positions[],
+                                     async_callback callback, void *data)
+{
+    async_request *request;         // resulting request
+
+    request = calloc(1, sizeof(async_request));
+    if (request == NULL)
+        return NULL;
+
+    request->t = t;
+    request->n = n;
+    request->frame = frame;
+    request->threshold = threshold;
+    request->positions = positions;
+    request->callback = callback;
+    request->data = data;
+
+    return request;
+}
+
+async_request *async_submit(const double t[], int n, int frame, double threshold, double positions[])
+{
+    async_request *request;         // submitted request
+
+    request = create_request(t, n, frame, threshold, positions, NULL, NULL);
+    if (request != NULL && queue_request(request) != 0){
+        free(request);
+        return NULL;
+    }
+
+    return request;
+}
+
+int async_submit_callback(const double t[], int n, int frame, double threshold, double positions[],
+                          async_callback callback, void *data)
+{
+    async_request *request;         // submitted request
+
+    if (callback == NULL)
+        return -1;
+
+    request = create_request(t, n, frame, threshold, positions, callback, data);
+    if (request == NULL)
+        return -1;
+    if (queue_request(request) != 0){
+        free(request);
+        return -1;
+    }
+
+    return 0;
+}
+
+int async_is_complete(async_request *request)
+{
+    int complete;                   // non zero if the request is complete
+
+    pthread_mutex_lock(&queue.mutex);
+    complete = request->complete;
+    pthread_mutex_unlock(&queue.mutex);
+
+    return complete;
+}
+
+void async_wait(async_request *request)
+{
+    pthread_mutex_lock(&queue.mutex);
+    while (!request->complete)
+        pthread_cond_wait(&queue.completed, &queue.mutex);
+    pthread_mutex_unlock(&queue.mutex);
+}
+
+void async_release(async_request *request)
+{
+    if (request == NULL)
+        return;
+
+    async_wait(request);
+    free(request);
+}
+
+void async_configure(int window, int max_batch_epochs)
+{
+    pthread_mutex_lock(&queue.mutex);
+    queue.window = window > 0 ? window : 0;
+    queue.max_batch_epochs = max_batch_epochs > 0 ? max_batch_epochs : 1;
+    pthread_mutex_unlock(&queue.mutex);
+}
+
+void async_shutdown(void)
+{
+    pthread_once(&queue_once, initialize_queue);
+    pthread_mutex_lock(&queue.mutex);
+
+    queue.stopping = 1;
+    pthread_cond_signal(&queue.submitted);
+    while (queue.running)
+        pthread_cond_wait(&queue.completed, &queue.mutex);
+    queue.stopping = 0;
+
+    pthread_mutex_unlock(&queue.mutex);
+}
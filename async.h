@@ -0,0 +1,82 @@
+/*
+ * async.h
+ *
+ * This file contains routines to submit requests for positions of the Moon without blocking the calling thread.
+ *
+ * A request consists of time instants, reference frame (one of ELP_frames, see elp2000-82b.h), amplitude threshold of
+ * the terms to be computed (see geocentric_moon_positions_truncated) and an output array. Requests are queued and
+ * computed by a dispatcher thread, which is started on the first submission. Requests arriving close together in time
+ * are coalesced into a single batch: the dispatcher waits for a short coalescing window after the first request of a
+ * batch arrives, then computes all queued requests with the same frame and threshold with a single call to
+ * geocentric_moon_positions_truncated, so that the series are read once for all of them.
+ *
+ * A request is either waited for through the handle returned by async_submit, or completed by a callback given to
+ * async_submit_callback, which is called from the dispatcher thread.
+ */
+
+#ifndef ASYNC_H
+#define ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ASYNC_COALESCING_WINDOW 200     // default coalescing window, measured in microseconds
+#define ASYNC_MAX_BATCH_EPOCHS 4096     // default amount of time instants that completes a batch before its window ends
+
+/*
+ * A datatype defining a handle of a submitted request.
+ */
+typedef struct async_request async_request;
+
+/*
+ * A datatype defining a routine called when a request is complete, given the user defined data of the request.
+ */
+typedef void (*async_callback)(void *data);
+
+/*
+ * Submits a request for positions of the Moon at n time instants t in the given frame computed with the given
+ * threshold. Arrays t and positions (3n values) must stay valid until the request is complete.
+ * Returns the handle of the request, which must be released with async_release, or NULL on failure.
+ */
+async_request *async_submit(const double t[], int n, int frame, double threshold, double positions[]);
+
+/*
+ * Submits a request the same way as async_submit does, but instead of returning a handle calls the given callback with
+ * the given data from the dispatcher thread when positions are computed.
+ * Returns zero on success, or a negative value on failure.
+ */
+int async_submit_callback(const double t[], int n, int frame, double threshold, double positions[],
+                          async_callback callback, void *data);
+
+/*
+ * Returns non zero if the given request is complete.
+ */
+int async_is_complete(async_request *request);
+
+/*
+ * Waits for the given request to complete.
+ */
+void async_wait(async_request *request);
+
+/*
+ * Waits for the given request to complete and releases its handle.
+ */
+void async_release(async_request *request);
+
+/*
+ * Sets the coalescing window, measured in microseconds, and the amount of time instants that completes a batch before
+ * its window ends. Affects batches started after the call.
+ */
+void async_configure(int window, int max_batch_epochs);
+
+/*
+ * Completes all queued requests and stops the dispatcher thread. Requests submitted afterwards start it again.
+ */
+void async_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ASYNC_H
@@ -0,0 +1,332 @@
+/*
+ * autotune.c
+ */
+
+#include "autotune.h"
+#include "chebfile.h"
+#include "elp2000-82b.h"
+#include "gemm.h"
+#include "threadpool.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PATH_LENGTH 4096                // maximum length of the path of the file of tunings
+#define LINE_LENGTH 512                 // length of the buffer of a line of the file of tunings
+#define TOTAL_BLOCK_CANDIDATES 5        // amount of candidate sizes of blocks of terms
+#define TOTAL_CHUNK_CANDIDATES 5        // amount of candidate sizes of chunks of epochs
+
+static const int block_candidates[TOTAL_BLOCK_CANDIDATES] = {64, 128, 256, 512, 1024};
+static const int chunk_candidates[TOTAL_CHUNK_CANDIDATES] = {16, 32, 64, 128, 256};
+
+static elp_tuning current = {"unknown", 0, GEMM_BLOCK_TERMS, GEMM_CHUNK_EPOCHS, 0.0};  // tuning used
+static pthread_once_t loading_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Returns the time of the monotonic clock in seconds.
+ */
+static double current_time(void)
+{
+    struct timespec now;        // current time
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/*
+ * Writes the path of the file of tunings into the given buffer of PATH_LENGTH characters: the given path, or the
+ * default file if it is NULL. Returns zero on success or a negative value if there is no default file.
+ */
+static int find_path(const char *path, char buffer[])
+{
+    const char *home;           // home directory
+
+    if (path == NULL)
+        path = getenv("ELP2000_TUNING_FILE");
+    if (path != NULL)
+        return snprintf(buffer, PATH_LENGTH, "%s", path) < PATH_LENGTH ? 0 : -1;
+
+    if ((home = getenv("HOME")) == NULL)
+        return -1;
+
+    return snprintf(buffer, PATH_LENGTH, "%s/%s", home, AUTOTUNE_DEFAULT_FILE) < PATH_LENGTH ? 0 : -1;
+}
+
+/*
+ * Returns non zero if the parameters of the tuning are valid.
+ */
+static int is_valid(const elp_tuning *tuning)
+{
+    return tuning->threads >= 0 && tuning->threads <= MAX_POOL_THREADS + 1 && tuning->block_terms > 0 &&
+           tuning->block_terms % GEMM_TILE_TERMS == 0 && tuning->chunk_epochs > 0 &&
+           tuning->chunk_epochs % GEMM_TILE_EPOCHS == 0 && tuning->chunk_epochs <= GEMM_MAX_CHUNK_EPOCHS &&
+           tuning->gemm_ratio >= 0.0;
+}
+
+/*
+ * Reads the last valid line of the model of the given tuning from the file of the given path into the tuning.
+ * Returns zero on success or a negative value if the file could not be read or has no valid line of the model.
+ */
+static int read_tuning(const char *path, elp_tuning *tuning)
+{
+    char line[LINE_LENGTH];     // line of the file
+    char *tab;                  // separator of the model and the parameters
+    elp_tuning candidate;       // tuning of a line
+    FILE *file;                 // file of tunings
+    int found;                  // non zero if a valid line was found
+
+    if ((file = fopen(path, "r")) == NULL)
+        return -1;
+
+    candidate = *tuning;
+    for (found = 0; fgets(line, sizeof(line), file) != NULL; ){
+        if ((tab = strchr(line, '\t')) == NULL)
+            continue;
+        *tab = '\0';
+        if (strcmp(line, tuning->model) != 0)
+            continue;
+        if (sscanf(tab + 1, "%d %d %d %lg", &candidate.threads, &candidate.block_terms, &candidate.chunk_epochs,
+                   &candidate.gemm_ratio) == 4 && is_valid(&candidate)){
+            *tuning = candidate;
+            found = 1;
+        }
+    }
+    fclose(file);
+
+    return found ? 0 : -1;
+}
+
+/*
+ * Persists the tuning in the file of the given path, keeping lines of other models.
+ * Returns zero on success or a negative value on failure.
+ */
+static int write_tuning(const char *path, const elp_tuning *tuning)
+{
+    char *temporary;                    // temporary name of the file
+    char line[LINE_LENGTH];             // part of a line of the old file
+    char *tab;                          // separator of the model and the parameters
+    FILE *input, *output;               // old and new files
+    size_t length;                      // length of the part of a line
+    int start;                          // non zero if the part starts a line
+    int skipping;                       // non zero while a line of the same model is skipped
+    int fd;                             // descriptor of the new file
+    int failed;                         // non zero if writing failed
+
+    if ((fd = chebyshev_file_create_temporary(path, &temporary)) < 0)
+        return -1;
+    if ((output = fdopen(fd, "w")) == NULL){
+        close(fd);
+        unlink(temporary);
+        free(temporary);
+        return -1;
+    }
+
+    // copying lines of other models, which may be longer than the buffer
+    if ((input = fopen(path, "r")) != NULL){
+        for (start = 1, skipping = 0; fgets(line, sizeof(line), input) != NULL; start = line[length - 1] == '\n'){
+            length = strlen(line);
+            if (start){
+                tab = strchr(line, '\t');
+                skipping = tab != NULL && (size_t)(tab - line) == strlen(tuning->model) &&
+                           strncmp(line, tuning->model, tab - line) == 0;
+            }
+            if (!skipping)
+                fputs(line, output);
+        }
+        fclose(input);
+    }
+
+    fprintf(output, "%s\t%d %d %d %.6g\n", tuning->model, tuning->threads, tuning->block_terms, tuning->chunk_epochs,
+            tuning->gemm_ratio);
+    failed = ferror(output);
+    failed = fclose(output) != 0 || failed;
+
+    // publishing the complete file under its name
+    if (!failed)
+        failed = rename(temporary, path);
+    if (failed)
+        unlink(temporary);
+    free(temporary);
+
+    return failed ? -1 : 0;
+}
+
+/*
+ * Finds the model of the host and loads its tuning from the default file, if there is one.
+ */
+static void load_default_tuning(void)
+{
+    char path[PATH_LENGTH];     // path of the default file
+
+    elp_tuning_model(current.model);
+    if (find_path(NULL, path) == 0)
+        read_tuning(path, &current);
+}
+
+/*
+ * Returns the least time of AUTOTUNE_REPEATS batches of n positions computed by the full series.
+ */
+static double measure_series(const double t[], int n, double positions[])
+{
+    double best, start;         // least time and the time a measurement started at
+    int i;                      // loop index variable
+
+    for (i = 0, best = HUGE_VAL; i < AUTOTUNE_REPEATS; i++){
+        start = current_time();
+        geocentric_moon_positions(t, n, ELP2000_SPHERICAL, positions);
+        best = fmin(best, current_time() - start);
+    }
+
+    return best;
+}
+
+/*
+ * Returns the least time of AUTOTUNE_REPEATS batches of n positions computed by matrix products with the given sizes
+ * of blocks and chunks.
+ */
+static double measure_gemm(const double t[], int n, int block_terms, int chunk_epochs, double positions[])
+{
+    double best, start;         // least time and the time a measurement started at
+    int i;                      // loop index variable
+
+    for (i = 0, best = HUGE_VAL; i < AUTOTUNE_REPEATS; i++){
+        start = current_time();
+        if (geocentric_moon_positions_gemm_blocked(t, n, ELP2000_SPHERICAL, 0.0, block_terms, chunk_epochs,
+                                                   positions) != 0)
+            return HUGE_VAL;
+        best = fmin(best, current_time() - start);
+    }
+
+    return best;
+}
+
+int elp_autotune(const char *path, elp_tuning *tuning)
+{
+    char buffer[PATH_LENGTH];   // path of the file of tunings
+    elp_tuning tuned;           // tuning found
+    double *t, *positions;      // time instants and positions of measured batches
+    double series, gemm, time;  // least times of the full series and matrix products, time of a candidate
+    long cores;                 // amount of online processor cores
+    int n;                      // amount of positions of a batch
+    int threads;                // candidate amount of threads
+    int i, j;                   // loop index variables
+
+    pthread_once(&loading_once, load_default_tuning);
+
+    cores = sysconf(_SC_NPROCESSORS_ONLN);
+    cores = cores < 1 ? 1 : cores > MAX_POOL_THREADS + 1 ? MAX_POOL_THREADS + 1 : cores;
+    n = AUTOTUNE_EPOCHS * (int)cores;
+    t = malloc(sizeof(double) * n);
+    positions = malloc(sizeof(double) * 3 * n);
+    if (t == NULL || positions == NULL){
+        free(t);
+        free(positions);
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+        t[i] = i / 36525.0;
+
+    // warming up, which also lets the batch routines start the pool and pack the series before measurements
+    tuned = current;
+    geocentric_moon_positions(t, AUTOTUNE_EPOCHS, ELP2000_SPHERICAL, positions);
+    geocentric_moon_positions_gemm_blocked(t, AUTOTUNE_EPOCHS, ELP2000_SPHERICAL, 0.0, GEMM_BLOCK_TERMS,
+                                           GEMM_CHUNK_EPOCHS, positions);
+
+    // amount of threads, measured by the full series
+    for (threads = 1, series = HUGE_VAL; ; threads *= 2){
+        threads = threads > cores ? (int)cores : threads;
+        thread_pool_stop();
+        if (threads > 1 && thread_pool_start(threads - 1, 0) != 0)
+            break;
+        if ((time = measure_series(t, n, positions)) < series){
+            series = time;
+            tuned.threads = threads;
+        }
+        if (threads == cores)
+            break;
+    }
+    thread_pool_stop();
+    if (tuned.threads > 1)
+        thread_pool_start(tuned.threads - 1, 0);
+
+    // sizes of blocks and chunks of matrix products
+    for (i = 0, gemm = HUGE_VAL; i < TOTAL_BLOCK_CANDIDATES; i++)
+        for (j = 0; j < TOTAL_CHUNK_CANDIDATES; j++)
+            if ((time = measure_gemm(t, n, block_candidates[i], chunk_candidates[j], positions)) < gemm){
+                gemm = time;
+                tuned.block_terms = block_candidates[i];
+                tuned.chunk_epochs = chunk_candidates[j];
+            }
+    tuned.gemm_ratio = gemm < HUGE_VAL && series > 0.0 ? gemm / series : 0.0;
+
+    free(t);
+    free(positions);
+
+    // using the tuning from now on, the pool being restarted the same way as by batch routines
+    current = tuned;
+    thread_pool_stop();
+    thread_pool_start_from_environment(current.threads);
+    if (tuning != NULL)
+        *tuning = tuned;
+
+    if (find_path(path, buffer) != 0)
+        return -1;
+
+    return write_tuning(buffer, &tuned);
+}
+
+int elp_tuning_load(const char *path)
+{
+    char buffer[PATH_LENGTH];   // path of the file of tunings
+    elp_tuning tuning;          // tuning read
+
+    pthread_once(&loading_once, load_default_tuning);
+
+    tuning = current;
+    if (find_path(path, buffer) != 0 || read_tuning(buffer, &tuning) != 0)
+        return -1;
+    current = tuning;
+
+    return 0;
+}
+
+const elp_tuning *elp_tuning_current(void)
+{
+    pthread_once(&loading_once, load_default_tuning);
+
+    return &current;
+}
+
+void elp_tuning_model(char model[])
+{
+    char line[LINE_LENGTH];     // line of the description of processors
+    char *value, *end;          // value of the line of the model and its end
+    FILE *file;                 // description of processors
+
+    snprintf(model, AUTOTUNE_MODEL_LENGTH, "unknown");
+    if ((file = fopen("/proc/cpuinfo", "r")) == NULL)
+        return;
+
+    while (fgets(line, sizeof(line), file) != NULL){
+        if (strncmp(line, "model name", strlen("model name")) != 0 || (value = strchr(line, ':')) == NULL)
+            continue;
+        for (value++; *value == ' ' || *value == '\t'; value++)
+            ;
+        for (end = value + strlen(value); end > value && (end[-1] == '\n' || end[-1] == ' '); end--)
+            ;
+        *end = '\0';
+        // tabs separate models from parameters in the file of tunings
+        for (end = value; *end != '\0'; end++)
+            *end = *end == '\t' ? ' ' : *end;
+        if (*value != '\0')
+            snprintf(model, AUTOTUNE_MODEL_LENGTH, "%s", value);
+        break;
+    }
+    fclose(file);
+}
@@ -0,0 +1,75 @@
+/*
+ * autotune.h
+ *
+ * This file contains routines to tune the parameters of batch computations for the host: the amount of threads of the
+ * pool, the sizes of blocks of terms and chunks of epochs of the batch backend of matrix products (see gemm.h) and the
+ * relative speed of the kernels computing the series, which the planner (see planner.h) uses to choose between them.
+ *
+ * elp_autotune measures batches of positions on the host and keeps the fastest parameters. Tunings are persisted in a
+ * text file holding a line per processor model, so that a file may be shared by hosts of different models; a line
+ * holds the model (as given by /proc/cpuinfo), a tab and the parameters separated by spaces. The file is rewritten
+ * under a temporary name and renamed, thus readers never see a partial file.
+ *
+ * The tuning of the model of the host is loaded on first use from the file named by environment variable
+ * ELP2000_TUNING_FILE, or from AUTOTUNE_DEFAULT_FILE in the home directory if the variable is not set. Without a file
+ * or a line of the model, the defaults GEMM_BLOCK_TERMS and GEMM_CHUNK_EPOCHS and one thread per online processor core
+ * are used. Environment variable ELP2000_THREADS still overrides the tuned amount of threads.
+ */
+
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUTOTUNE_DEFAULT_FILE ".elp2000-tuning"     // name of the file of tunings in the home directory
+#define AUTOTUNE_MODEL_LENGTH 128                   // maximum length of the name of a processor model, with zero
+#define AUTOTUNE_EPOCHS 256                         // amount of positions of a measured batch per thread
+#define AUTOTUNE_REPEATS 2                          // amount of measurements of each candidate, the fastest is kept
+
+/*
+ * A datatype holding the parameters tuned for a processor model.
+ */
+typedef struct {
+    char model[AUTOTUNE_MODEL_LENGTH];  // processor model
+    int threads;                // amount of threads including the calling one, zero for one per online core
+    int block_terms;            // amount of terms of a block of panels of matrix products
+    int chunk_epochs;           // amount of epochs of a chunk of matrix products
+    double gemm_ratio;          // time of matrix products relative to the full series; zero if unknown
+} elp_tuning;
+
+/*
+ * Measures batches of positions with each candidate amount of threads (powers of two up to the amount of online cores)
+ * and each candidate size of blocks and chunks of matrix products, then measures the full series and matrix products
+ * with the fastest parameters. The tuning is written into the given structure (unless it is NULL), used from now on
+ * and persisted in the file of the given path, replacing the line of the same model; NULL path selects the default
+ * file. The pool of threads is restarted with the tuned amount of threads. Takes a few seconds per thread candidate;
+ * must not be called while other threads compute positions.
+ * Returns zero on success or a negative value if the tuning could not be persisted; the tuning is used anyway.
+ */
+int elp_autotune(const char *path, elp_tuning *tuning);
+
+/*
+ * Loads the tuning of the model of the host from the file of the given path, NULL selecting the default file, and
+ * uses it from now on. Must not be called while other threads compute positions.
+ * Returns zero on success or a negative value if the file could not be read or has no valid line of the model.
+ */
+int elp_tuning_load(const char *path);
+
+/*
+ * Returns the tuning used, loading it from the default file on first call.
+ */
+const elp_tuning *elp_tuning_current(void);
+
+/*
+ * Writes the name of the processor model of the host into the given buffer of AUTOTUNE_MODEL_LENGTH characters,
+ * "unknown" if it could not be found.
+ */
+void elp_tuning_model(char model[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUTOTUNE_H
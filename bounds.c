@@ -0,0 +1,294 @@
+/*
+ * bounds.c
+ */
+
+#include "bounds.h"
+#include "theory.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define TOTAL_POWERS 3                  // amount of powers of t the series are multiplied by
+#define ROUNDING_MARGIN 1e-12           // margin for rounding errors relative to the magnitude of the dominant part
+
+/*
+ * A datatype describing a term of the series ranked by its amplitude.
+ */
+typedef struct {
+    double amplitude;           // absolute value of the amplitude
+    int serie;                  // index of the serie
+    int term;                   // index of the term within the serie
+} ranked_term;
+
+/*
+ * A datatype describing terms of the series contributing to a coordinate with a given power of t.
+ */
+typedef struct {
+    ranked_term *terms;         // terms in decreasing absolute values of amplitudes
+    double *tails;              // sums of absolute values of amplitudes from each term on, n + 1 values
+    int n;                      // amount of terms
+} ranked_group;
+
+static ranked_group groups[TOTAL_SPHERICAL_COORDINATES][TOTAL_POWERS];  // ranked terms per coordinate and power
+static int ranking_failed;                                              // non zero if terms could not be allocated
+static pthread_once_t ranking_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Compares ranked terms by decreasing amplitudes.
+ */
+static int compare_ranked_terms(const void *a, const void *b)
+{
+    double aa = ((const ranked_term *)a)->amplitude;   // amplitude of the first term
+    double ab = ((const ranked_term *)b)->amplitude;   // amplitude of the second term
+
+    return aa > ab ? -1 : aa < ab ? 1 : 0;
+}
+
+/*
+ * Ranks terms of all series by coordinates and powers of t.
+ */
+static void rank_terms(void)
+{
+    ranked_group *group;        // current group of terms
+    int i, j, l, p;             // loop index variables
+
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++)
+        groups[elp2000_series[i].coordinate][elp2000_series[i].power].n += elp2000_series[i].n;
+
+    for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++)
+        for (p = 0; p < TOTAL_POWERS; p++){
+            group = &groups[l][p];
+            group->terms = malloc(sizeof(ranked_term) * (group->n + 1));
+            group->tails = malloc(sizeof(double) * (group->n + 1));
+            if (group->terms == NULL || group->tails == NULL){
+                ranking_failed = 1;
+                return;
+            }
+            group->n = 0;
+        }
+
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        group = &groups[elp2000_series[i].coordinate][elp2000_series[i].power];
+        for (j = 0; j < elp2000_series[i].n; j++, group->n++){
+            group->terms[group->n].amplitude = fabs(serie_term_amplitude(&elp2000_series[i], j));
+            group->terms[group->n].serie = i;
+            group->terms[group->n].term = j;
+        }
+    }
+
+    for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++)
+        for (p = 0; p < TOTAL_POWERS; p++){
+            group = &groups[l][p];
+            qsort(group->terms, group->n, sizeof(ranked_term), compare_ranked_terms);
+            for (j = group->n, group->tails[j] = 0.0; j > 0; j--)
+                group->tails[j - 1] = group->tails[j] + group->terms[j - 1].amplitude;
+        }
+}
+
+/*
+ * Bounds the absolute value of the r-th derivative of a polynomial of degree FULL_SERIES_TOTAL_TERMS - 1 given by its
+ * coefficients over |t| ≤ extent.
+ */
+static double bound_derivative(const double coefficients[], int r, double extent)
+{
+    double bound;               // accumulating variable holding the bound
+    double factor;              // falling factorial of the power
+    int j, k;                   // loop index variables
+
+    for (k = r, bound = 0.0; k < FULL_SERIES_TOTAL_TERMS; k++){
+        for (j = 0, factor = 1.0; j < r; j++)
+            factor *= k - j;
+        bound += factor * fabs(coefficients[k]) * pow(extent, k - r);
+    }
+
+    return bound;
+}
+
+/*
+ * Bounds absolute values of the second derivatives of the full Delaunay arguments over |t| ≤ extent, measured in
+ * arcseconds per squared Julian century.
+ */
+static void bound_delaunay_accelerations(double extent, double accelerations[])
+{
+    double polynomials[TOTAL_DELAUNAY_ARGUMENTS][FULL_SERIES_TOTAL_TERMS];  // polynomials of the Delaunay arguments
+    const double *w1, *w2, *w3, *tt, *obp;                                  // polynomials of the ELP2000 arguments
+    int i, k;                                                               // loop index variables
+
+    w1 = &elp2000_arguments_coefficients[W1 * FULL_SERIES_TOTAL_TERMS];
+    w2 = &elp2000_arguments_coefficients[W2 * FULL_SERIES_TOTAL_TERMS];
+    w3 = &elp2000_arguments_coefficients[W3 * FULL_SERIES_TOTAL_TERMS];
+    tt = &elp2000_arguments_coefficients[T * FULL_SERIES_TOTAL_TERMS];
+    obp = &elp2000_arguments_coefficients[OBP * FULL_SERIES_TOTAL_TERMS];
+
+    // Delaunay arguments are combined the same way as in compute_delaunay_arguments
+    for (k = 0; k < FULL_SERIES_TOTAL_TERMS; k++){
+        polynomials[D][k] = w1[k] - tt[k];
+        polynomials[LP][k] = tt[k] - obp[k];
+        polynomials[L][k] = w1[k] - w2[k];
+        polynomials[F][k] = w1[k] - w3[k];
+    }
+
+    for (i = 0; i < TOTAL_DELAUNAY_ARGUMENTS; i++)
+        accelerations[i] = bound_derivative(polynomials[i], 2, extent);
+}
+
+/*
+ * Bounds the absolute value of the second derivative of the term with index i of the given serie, multiplied by its
+ * power of t, over the window [t0, t1] given the largest absolute value of t over it (extent), rates of the arguments
+ * at the middle of the window and bounds of accelerations of the Delaunay arguments.
+ */
+static double bound_term_curvature(const serie *s, int i, double t0, double t1, double extent,
+                                   const serie_arguments *rates, const double accelerations[])
+{
+    serie_arguments unit;       // arguments of the theory, a single Delaunay argument being one
+    double rate;                // bound of the absolute value of the rate of the argument, radians per century
+    double acceleration;        // bound of the absolute value of its acceleration, radians per squared century
+    double multiplier;          // multiplier of a Delaunay argument
+    double bound;               // bound of the second derivative divided by the amplitude
+    int j, p;                   // loop index variable and the power of t
+
+    rate = fabs(compute_serie_term_argument(s, rates, i));
+    acceleration = 0.0;
+
+    // only the Main Problem uses the full Delaunay arguments, the other arguments are linear
+    if (s->type == SERIE_A_SIN || s->type == SERIE_A_COS){
+        for (j = 0; j < TOTAL_DELAUNAY_ARGUMENTS; j++)
+            unit.delaunay[j] = 0.0;
+        for (j = 0; j < TOTAL_DELAUNAY_ARGUMENTS; j++){
+            unit.delaunay[j] = 1.0;
+            multiplier = fabs(compute_serie_term_argument(s, &unit, i));
+            unit.delaunay[j] = 0.0;
+            rate += multiplier * accelerations[j] * 0.5 * (t1 - t0);
+            acceleration += multiplier * accelerations[j];
+        }
+    }
+    rate *= M_PI / 648000.0;
+    acceleration *= M_PI / 648000.0;
+
+    // (t^p sin φ)'' = p(p - 1)t^(p-2)sin φ + 2pt^(p-1)φ'cos φ + t^p(φ''cos φ - φ'²sin φ)
+    p = s->power;
+    bound = pow(extent, p) * (acceleration + rate * rate);
+    if (p >= 1)
+        bound += 2.0 * p * pow(extent, p - 1) * rate;
+    if (p >= 2)
+        bound += p * (p - 1) * pow(extent, p - 2);
+
+    return fabs(serie_term_amplitude(s, i)) * bound;
+}
+
+int geocentric_moon_bounds(double t0, double t1, int terms, double lower[], double upper[])
+{
+    ranked_term *dominant[TOTAL_SPHERICAL_COORDINATES];    // dominant terms of each coordinate
+    int counts[TOTAL_SPHERICAL_COORDINATES];               // amounts of dominant terms of each coordinate
+    double tails[TOTAL_SPHERICAL_COORDINATES];             // bounds of the rest of the terms of each coordinate
+    double curvatures[TOTAL_SPHERICAL_COORDINATES];        // bounds of second derivatives of the dominant parts
+    double magnitudes[TOTAL_SPHERICAL_COORDINATES];        // bounds of absolute values of the dominant parts
+    double minimum[TOTAL_SPHERICAL_COORDINATES], maximum[TOTAL_SPHERICAL_COORDINATES];  // extrema at the samples
+    double accelerations[TOTAL_DELAUNAY_ARGUMENTS];        // bounds of accelerations of the Delaunay arguments
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];     // ELP2000 arguments at a sample
+    double extent;                                         // largest absolute value of t over the window
+    double best;                                           // greatest bound of a candidate term
+    double value, contribution;                            // value of the dominant part and of a term
+    double t, h;                                           // time instant of a sample and interval between samples
+    double slack;                                          // deviation of the dominant part from its chords
+    const ranked_group *group;                             // current group of terms
+    const serie *s;                                        // serie of the current term
+    serie_arguments arguments;                             // arguments of the series at a sample or their rates
+    int taken[TOTAL_POWERS];                               // amounts of terms taken from each group
+    int samples, needed;                                   // amounts of intervals between samples
+    int i, j, k, l, p;                                     // loop index variables
+
+    if (!(t1 >= t0) || !isfinite(t0) || !isfinite(t1) || terms < 0)
+        return -1;
+
+    pthread_once(&ranking_once, rank_terms);
+    if (ranking_failed)
+        return -1;
+
+    for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++){
+        dominant[l] = malloc(sizeof(ranked_term) * (terms > 0 ? terms : 1));
+        if (dominant[l] == NULL){
+            while (l-- > 0)
+                free(dominant[l]);
+            return -1;
+        }
+    }
+
+    extent = fabs(t0) > fabs(t1) ? fabs(t0) : fabs(t1);
+    compute_serie_argument_rates(0.5 * (t0 + t1), &arguments);
+    bound_delaunay_accelerations(extent, accelerations);
+
+    // picking terms of the greatest bounds |A|T^p by merging groups of each power, the rest of them forms the tail
+    for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++){
+        for (p = 0; p < TOTAL_POWERS; p++)
+            taken[p] = 0;
+        for (counts[l] = 0, curvatures[l] = magnitudes[l] = 0.0; counts[l] < terms; counts[l]++){
+            for (p = 0, j = -1, best = -1.0; p < TOTAL_POWERS; p++){
+                group = &groups[l][p];
+                if (taken[p] < group->n && group->terms[taken[p]].amplitude * pow(extent, p) > best){
+                    best = group->terms[taken[p]].amplitude * pow(extent, p);
+                    j = p;
+                }
+            }
+            if (j < 0)
+                break;
+            dominant[l][counts[l]] = groups[l][j].terms[taken[j]++];
+            magnitudes[l] += best;
+            curvatures[l] += bound_term_curvature(&elp2000_series[dominant[l][counts[l]].serie],
+                                                  dominant[l][counts[l]].term, t0, t1, extent, &arguments,
+                                                  accelerations);
+        }
+        for (p = 0, tails[l] = 0.0; p < TOTAL_POWERS; p++)
+            tails[l] += groups[l][p].tails[taken[p]] * pow(extent, p);
+    }
+
+    // mean mean longitude of the Moon (W₁) is a part of the dominant part of longitude
+    magnitudes[LONGITUDE] += bound_derivative(&elp2000_arguments_coefficients[W1 * FULL_SERIES_TOTAL_TERMS], 0,
+                                              extent);
+    curvatures[LONGITUDE] += bound_derivative(&elp2000_arguments_coefficients[W1 * FULL_SERIES_TOTAL_TERMS], 2,
+                                              extent);
+
+    // spacing samples so that the slack of each coordinate stays within its tail
+    for (l = 0, samples = 1; l < TOTAL_SPHERICAL_COORDINATES; l++){
+        slack = tails[l] > BOUNDS_MIN_SLACK ? tails[l] : BOUNDS_MIN_SLACK;
+        value = ceil((t1 - t0) * sqrt(curvatures[l] / (8.0 * slack)));
+        needed = value < BOUNDS_MAX_SAMPLES ? (int)value : BOUNDS_MAX_SAMPLES;
+        if (needed > samples)
+            samples = needed;
+    }
+    h = (t1 - t0) / samples;
+
+    for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++){
+        minimum[l] = HUGE_VAL;
+        maximum[l] = -HUGE_VAL;
+    }
+
+    for (k = 0; k <= samples; k++){
+        t = k < samples ? t0 + k * h : t1;
+        compute_serie_arguments(t, &arguments);
+        compute_elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+        for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++){
+            for (i = 0, value = l == LONGITUDE ? elp2000_arguments[W1] : 0.0; i < counts[l]; i++){
+                s = &elp2000_series[dominant[l][i].serie];
+                contribution = serie_term_amplitude(s, dominant[l][i].term) *
+                               sin((compute_serie_term_argument(s, &arguments, dominant[l][i].term) +
+                                    serie_term_phase(s, dominant[l][i].term)) * (M_PI / 648000.0));
+                for (p = 0; p < s->power; p++)
+                    contribution *= t;
+                value += contribution;
+            }
+            minimum[l] = value < minimum[l] ? value : minimum[l];
+            maximum[l] = value > maximum[l] ? value : maximum[l];
+        }
+    }
+
+    for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++){
+        slack = curvatures[l] * h * h / 8.0 + tails[l] + ROUNDING_MARGIN * magnitudes[l];
+        lower[l] = minimum[l] - slack;
+        upper[l] = maximum[l] + slack;
+        free(dominant[l]);
+    }
+
+    return 0;
+}
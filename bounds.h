@@ -0,0 +1,43 @@
+/*
+ * bounds.h
+ *
+ * This file contains a routine to find guaranteed bounds of the spherical coordinates of the Moon over a time window,
+ * meant for pruning candidates cheaply before computing exact positions.
+ *
+ * Terms of the series contributing to a coordinate are ranked by the bounds |A|T^p of their absolute values over the
+ * window, T being the largest absolute value of t within it. The given amount of dominant terms (and W₁ for longitude)
+ * is computed at equally spaced samples of the window, the rest of the terms is bounded by the sum of their bounds.
+ * Between two samples the dominant part f deviates from the chord through the samples by at most Mh²/8, where h is the
+ * interval between samples and M bounds |f''| over the window; M is found from the amplitudes, rates and accelerations
+ * of the arguments of the dominant terms. Samples are spaced so that this slack does not exceed the bound of the rest
+ * of the terms (or BOUNDS_MIN_SLACK), unless more than BOUNDS_MAX_SAMPLES samples would be needed.
+ *
+ * Thus each coordinate of the theory stays within the bounds over the whole window: the bounds hold for the values of
+ * the series, not only at the samples, with a margin for the rounding errors of computing them.
+ */
+
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOUNDS_MIN_SLACK 0.01           // least slack between samples, arcseconds or kilometers
+#define BOUNDS_MAX_SAMPLES 1048576      // maximum amount of intervals between samples of a window
+
+/*
+ * Finds bounds of longitude, latitude and distance of the Moon in the ELP 2000 reference frame (see
+ * geocentric_moon_position) over the time window [t0, t1] (Julian centuries since J2000), computing the given amount
+ * of dominant terms per coordinate at samples of the window. Lower and upper bounds are written into the given arrays
+ * of three values, measured in arcseconds for longitude and latitude and in kilometers for distance. More terms give
+ * narrower bounds at a greater cost; a few dozens suit windows of days.
+ * Returns zero on success or a negative value if the arguments are invalid or memory could not be allocated.
+ */
+int geocentric_moon_bounds(double t0, double t1, int terms, double lower[], double upper[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOUNDS_H
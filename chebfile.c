@@ -0,0 +1,204 @@
+/*
+ * chebfile.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "chebfile.h"
+#include "elp2000-82b.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CHECKSUM_BASIS 0xcbf29ce484222325ULL    // FNV-1a offset basis
+#define CHECKSUM_PRIME 0x100000001b3ULL         // FNV-1a prime
+
+uint64_t chebyshev_file_checksum(const void *data, size_t size)
+{
+    const unsigned char *bytes = data;
+    uint64_t checksum;          // accumulating variable holding the checksum
+    uint64_t word;              // current eight bytes of the data
+    size_t i;                   // loop index variable
+
+    // FNV-1a applied to words of eight bytes rather than to single bytes, which is eight times faster on large files;
+    // the rest of the data is processed byte by byte
+    for (i = 0, checksum = CHECKSUM_BASIS; i + sizeof(word) <= size; i += sizeof(word)){
+        memcpy(&word, bytes + i, sizeof(word));
+        checksum = (checksum ^ word) * CHECKSUM_PRIME;
+        checksum ^= checksum >> 29;
+    }
+    for (; i < size; i++)
+        checksum = (checksum ^ bytes[i]) * CHECKSUM_PRIME;
+
+    return checksum;
+}
+
+/*
+ * Writes size bytes of data into the given file descriptor, retrying on partial writes.
+ * Returns zero on success or a negative value on failure.
+ */
+static int write_all(int fd, const void *data, size_t size)
+{
+    const char *bytes = data;
+    ssize_t written;            // amount of bytes written by a single call
+
+    while (size > 0){
+        if ((written = write(fd, bytes, size)) < 0)
+            return -1;
+        bytes += written;
+        size -= written;
+    }
+
+    return 0;
+}
+
+int chebyshev_file_create_temporary(const char *path, char **temporary)
+{
+    int fd;                     // descriptor of the file
+
+    if ((*temporary = malloc(strlen(path) + sizeof(".tmp.XXXXXX"))) == NULL)
+        return -1;
+    sprintf(*temporary, "%s.tmp.XXXXXX", path);
+
+    if ((fd = mkstemp(*temporary)) < 0 || fchmod(fd, 0644) < 0){
+        if (fd >= 0){
+            close(fd);
+            unlink(*temporary);
+        }
+        free(*temporary);
+        *temporary = NULL;
+        return -1;
+    }
+
+    return fd;
+}
+
+int chebyshev_file_write(const char *path, const chebyshev_ephemeris *ephemeris)
+{
+    static const char zeros[4096];      // padding between the header and the coefficients
+    chebyshev_file_header header;       // header of the file
+    char *temporary;                    // temporary name of the file
+    size_t padding;                     // amount of padding bytes left to write
+    int fd;                             // descriptor of the file
+    int failed;                         // non zero if writing failed
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHEBYSHEV_FILE_MAGIC, sizeof(CHEBYSHEV_FILE_MAGIC));
+    header.byte_order = CHEBYSHEV_FILE_BYTE_ORDER;
+    header.version = CHEBYSHEV_FILE_VERSION;
+    header.header_size = sizeof(header);
+    header.frame = ephemeris->frame;
+    header.degree = ephemeris->degree;
+    header.granules = ephemeris->granules;
+    header.start = ephemeris->start;
+    header.end = ephemeris->start + ephemeris->granules * ephemeris->granule;
+    header.granule = ephemeris->granule;
+    header.tolerance = ephemeris->tolerance;
+    header.coefficients_offset = CHEBYSHEV_FILE_ALIGNMENT;
+    header.coefficients_size = sizeof(double) * 3 * (ephemeris->degree + 1) * (uint64_t)ephemeris->granules;
+    header.coefficients_checksum = chebyshev_file_checksum(ephemeris->coefficients, header.coefficients_size);
+    header.header_checksum = chebyshev_file_checksum(&header, offsetof(chebyshev_file_header, header_checksum));
+
+    if ((fd = chebyshev_file_create_temporary(path, &temporary)) < 0)
+        return CHEBYSHEV_FILE_IO_ERROR;
+
+    failed = write_all(fd, &header, sizeof(header));
+    for (padding = CHEBYSHEV_FILE_ALIGNMENT - sizeof(header); !failed && padding > 0; ){
+        failed = write_all(fd, zeros, padding < sizeof(zeros) ? padding : sizeof(zeros));
+        padding -= padding < sizeof(zeros) ? padding : sizeof(zeros);
+    }
+    if (!failed)
+        failed = write_all(fd, ephemeris->coefficients, header.coefficients_size);
+    if (!failed)
+        failed = fsync(fd);
+    failed = close(fd) < 0 || failed;
+
+    // publishing the complete file under its name
+    if (!failed)
+        failed = rename(temporary, path);
+    if (failed)
+        unlink(temporary);
+    free(temporary);
+
+    return failed ? CHEBYSHEV_FILE_IO_ERROR : 0;
+}
+
+int chebyshev_file_map(const char *path, chebyshev_file *file)
+{
+    const chebyshev_file_header *header;    // header of the mapped file
+    struct stat status;                     // status of the file
+    void *mapping;                          // mapped file
+    int fd;                                 // descriptor of the file
+    int error;                              // error found in the header
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return CHEBYSHEV_FILE_IO_ERROR;
+    if (fstat(fd, &status) < 0){
+        close(fd);
+        return CHEBYSHEV_FILE_IO_ERROR;
+    }
+    if ((size_t)status.st_size < sizeof(chebyshev_file_header)){
+        close(fd);
+        return CHEBYSHEV_FILE_FORMAT_ERROR;
+    }
+
+    mapping = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return CHEBYSHEV_FILE_IO_ERROR;
+
+    // checking the header; the byte order is checked before the version, since the version of a foreign file cannot
+    // be read
+    header = mapping;
+    error = 0;
+    if (memcmp(header->magic, CHEBYSHEV_FILE_MAGIC, sizeof(CHEBYSHEV_FILE_MAGIC)) != 0)
+        error = CHEBYSHEV_FILE_FORMAT_ERROR;
+    else if (header->byte_order != CHEBYSHEV_FILE_BYTE_ORDER)
+        error = CHEBYSHEV_FILE_BYTE_ORDER_ERROR;
+    else if (header->version != CHEBYSHEV_FILE_VERSION || header->header_size != sizeof(chebyshev_file_header))
+        error = CHEBYSHEV_FILE_VERSION_ERROR;
+    else if (header->header_checksum !=
+             chebyshev_file_checksum(header, offsetof(chebyshev_file_header, header_checksum)))
+        error = CHEBYSHEV_FILE_CHECKSUM_ERROR;
+    else if (header->frame < 0 || header->frame >= TOTAL_ELP_FRAMES || header->degree < CHEBYSHEV_MIN_DEGREE ||
+             header->degree > CHEBYSHEV_MAX_DEGREE || header->granules < 1 || !(header->granule > 0.0) ||
+             header->coefficients_offset % sizeof(double) != 0 ||
+             header->coefficients_size != sizeof(double) * 3 * (header->degree + 1) * (uint64_t)header->granules ||
+             header->coefficients_offset + header->coefficients_size > (uint64_t)status.st_size)
+        error = CHEBYSHEV_FILE_FORMAT_ERROR;
+
+    if (error){
+        munmap(mapping, status.st_size);
+        return error;
+    }
+
+    file->header = header;
+    file->size = status.st_size;
+    file->ephemeris.start = header->start;
+    file->ephemeris.granule = header->granule;
+    file->ephemeris.granules = header->granules;
+    file->ephemeris.degree = header->degree;
+    file->ephemeris.frame = header->frame;
+    file->ephemeris.tolerance = header->tolerance;
+    file->ephemeris.coefficients = (const double *)((const char *)mapping + header->coefficients_offset);
+
+    return 0;
+}
+
+int chebyshev_file_verify(const chebyshev_file *file)
+{
+    return chebyshev_file_checksum(file->ephemeris.coefficients, file->header->coefficients_size) ==
+           file->header->coefficients_checksum ? 0 : CHEBYSHEV_FILE_CHECKSUM_ERROR;
+}
+
+void chebyshev_file_unmap(chebyshev_file *file)
+{
+    munmap((void *)file->header, file->size);
+    file->header = NULL;
+    file->ephemeris.coefficients = NULL;
+}
@@ -0,0 +1,119 @@
+/*
+ * chebfile.h
+ *
+ * This file contains routines to store Chebyshev approximations of positions of the Moon (see chebyshev.h) in binary
+ * files and to map them into memory, so that many processes evaluate positions from the same pages of the page cache
+ * without fitting or parsing anything.
+ *
+ * A file starts with a header of fixed layout followed by the coefficients of all granules, exactly as they are laid
+ * out in memory by the fitting routines. Coefficients start at an offset aligned to CHEBYSHEV_FILE_ALIGNMENT bytes,
+ * which is a multiple of the page sizes of common systems, thus a mapped file is used as is. Values are stored in the
+ * byte order of the writer, which is tagged in the header; files of the other byte order are rejected rather than
+ * converted. The header is protected by its own checksum, checked each time a file is mapped, while the checksum of
+ * the coefficients is checked on demand only, since it needs to read the whole file.
+ */
+
+#ifndef CHEBFILE_H
+#define CHEBFILE_H
+
+#include "chebyshev.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHEBYSHEV_FILE_MAGIC "ELPCHEB"          // signature of the files, followed by a zero byte
+#define CHEBYSHEV_FILE_VERSION 1                // version of the layout of the files
+#define CHEBYSHEV_FILE_BYTE_ORDER 0x01020304    // tag of the byte order, read back as 0x04030201 on foreign systems
+#define CHEBYSHEV_FILE_ALIGNMENT 65536          // alignment of the coefficients, bytes
+
+/*
+ * An enumeration of errors of the routines handling files.
+ */
+enum Chebyshev_file_errors {
+    CHEBYSHEV_FILE_IO_ERROR = -1,           // file could not be opened, read, written or mapped
+    CHEBYSHEV_FILE_FORMAT_ERROR = -2,       // file is not a Chebyshev file or is truncated
+    CHEBYSHEV_FILE_VERSION_ERROR = -3,      // file has unsupported version
+    CHEBYSHEV_FILE_BYTE_ORDER_ERROR = -4,   // file was written on a system of the other byte order
+    CHEBYSHEV_FILE_CHECKSUM_ERROR = -5      // file is corrupted
+};
+
+/*
+ * A datatype describing the header of a file. The header occupies the beginning of the file, the rest of the first
+ * CHEBYSHEV_FILE_ALIGNMENT bytes is filled with zeros.
+ */
+typedef struct {
+    char magic[8];                  // CHEBYSHEV_FILE_MAGIC
+    uint32_t byte_order;            // CHEBYSHEV_FILE_BYTE_ORDER
+    uint32_t version;               // CHEBYSHEV_FILE_VERSION
+    uint32_t header_size;           // size of the header, bytes
+    int32_t frame;                  // coordinates and reference frame of positions (one of ELP_frames)
+    int32_t degree;                 // degree of the polynomials
+    int32_t granules;               // amount of granules
+    double start;                   // beginning of the time span, Julian centuries since J2000
+    double end;                     // end of the time span covered by the granules, Julian centuries since J2000
+    double granule;                 // length of a granule, Julian centuries
+    double tolerance;               // maximum approximation error in units of the coordinates of the frame
+    uint64_t coefficients_offset;   // offset of the coefficients from the beginning of the file, bytes
+    uint64_t coefficients_size;     // size of the coefficients, bytes
+    uint64_t coefficients_checksum; // checksum of the coefficients
+    uint64_t header_checksum;       // checksum of all the previous fields of the header
+} chebyshev_file_header;
+
+/*
+ * A datatype describing a mapped file: its header, the approximation referring to the mapped coefficients and the
+ * size of the mapping.
+ */
+typedef struct {
+    const chebyshev_file_header *header;    // header of the file
+    chebyshev_ephemeris ephemeris;          // approximation stored in the file
+    size_t size;                            // size of the mapping, bytes
+} chebyshev_file;
+
+/*
+ * Computes a 64 bit checksum of size bytes of data, used to detect corrupted files.
+ */
+uint64_t chebyshev_file_checksum(const void *data, size_t size);
+
+/*
+ * Creates a file of a unique temporary name next to the given path, open for reading and writing with permissions
+ * 0644, so that a complete file is published by renaming it to the path. The name, the path followed by ".tmp." and a
+ * random suffix, is allocated and written into the given pointer, to be released by free; names never collide between
+ * processes or threads writing the same path.
+ * Returns the descriptor of the file, or a negative value if it could not be created (the name is then NULL).
+ */
+int chebyshev_file_create_temporary(const char *path, char **temporary);
+
+/*
+ * Writes the given approximation into a file with the given path. The file is written under a temporary name and
+ * renamed when complete, so that readers never see a partially written file.
+ * Returns zero on success or one of Chebyshev_file_errors.
+ */
+int chebyshev_file_write(const char *path, const chebyshev_ephemeris *ephemeris);
+
+/*
+ * Maps the file with the given path into memory, read only and shared with other processes, and checks its header.
+ * The approximation of the mapped file is ready for chebyshev_evaluate.
+ * Returns zero on success or one of Chebyshev_file_errors.
+ */
+int chebyshev_file_map(const char *path, chebyshev_file *file);
+
+/*
+ * Checks the checksum of the coefficients of a mapped file, reading the whole file.
+ * Returns zero if the file is intact or CHEBYSHEV_FILE_CHECKSUM_ERROR otherwise.
+ */
+int chebyshev_file_verify(const chebyshev_file *file);
+
+/*
+ * Unmaps a mapped file.
+ */
+void chebyshev_file_unmap(chebyshev_file *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHEBFILE_H
@@ -0,0 +1,287 @@
+/*
+ * chebyshev.c
+ */
+
+#include "chebyshev.h"
+#include "elp2000-82b.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define JULIAN_CENTURY_DAYS 36525.0     // length of a Julian century, measured in days
+#define FIT_BLOCK_GRANULES 1024         // amount of granules whose nodes are computed with a single batch
+
+// granule lengths tried by chebyshev_choose, measured in days
+static const double candidate_granules[] = {32.0, 16.0, 8.0, 4.0, 2.0, 1.0};
+
+/*
+ * Computes time instants of the n Chebyshev nodes of a granule starting at the given time instant.
+ */
+static void compute_nodes(double start, double granule, int n, double t[])
+{
+    int j;                      // loop index variable
+
+    for (j = 0; j < n; j++)
+        t[j] = start + 0.5 * granule * (1.0 + cos(M_PI * (j + 0.5) / n));
+}
+
+/*
+ * Computes coefficients of Chebyshev series of degree n - 1 interpolating three coordinates given at n Chebyshev nodes
+ * (three values per node). Coefficients are written by degree first, three values per degree.
+ */
+static void interpolate(const double positions[], int n, double coefficients[])
+{
+    double acc[3];              // accumulating variables holding coefficients of each coordinate
+    double c;                   // value of a Chebyshev polynomial at a node
+    int j, k, l;                // loop index variables
+
+    for (k = 0; k < n; k++){
+        for (acc[0] = acc[1] = acc[2] = 0.0, j = 0; j < n; j++){
+            c = cos(M_PI * k * (j + 0.5) / n);
+            for (l = 0; l < 3; l++)
+                acc[l] += positions[j * 3 + l] * c;
+        }
+        for (l = 0; l < 3; l++)
+            coefficients[k * 3 + l] = (k == 0 ? 1.0 : 2.0) * acc[l] / n;
+    }
+}
+
+/*
+ * Finds the amount of granules of the given length covering the time span [t0, t1].
+ */
+static int count_granules(double t0, double t1, double granule)
+{
+    double n = ceil((t1 - t0) / granule);
+
+    return n < 1.0 ? 1 : n > 2147483647.0 / 3 / (CHEBYSHEV_MAX_DEGREE + 1) ? -1 : (int)n;
+}
+
+int chebyshev_fit(double t0, double t1, int frame, double granule, int degree, chebyshev_ephemeris *ephemeris)
+{
+    double *coefficients;       // coefficients of all granules
+    double *t;                  // time instants of the nodes of a block of granules
+    double *positions;          // positions of the Moon at the nodes of a block of granules
+    double tail, value;         // estimate of the approximation error
+    int n;                      // amount of coefficients of each coordinate
+    int granules;               // amount of granules
+    int first, m;               // first granule of a block and amount of granules in it
+    int block;                  // greatest amount of granules of a block
+    int i, k;                   // loop index variables
+
+    if (!(t1 >= t0) || !(granule > 0.0) || degree < CHEBYSHEV_MIN_DEGREE || degree > CHEBYSHEV_MAX_DEGREE ||
+        frame < 0 || frame >= TOTAL_ELP_FRAMES)
+        return -1;
+    if ((granules = count_granules(t0, t1, granule)) < 0)
+        return -1;
+
+    // buffers of nodes are sized by the amount of granules, since fits of single granules are on the latency path
+    n = degree + 1;
+    block = granules < FIT_BLOCK_GRANULES ? granules : FIT_BLOCK_GRANULES;
+    coefficients = malloc(sizeof(double) * 3 * n * granules);
+    t = malloc(sizeof(double) * n * block);
+    positions = malloc(sizeof(double) * 3 * n * block);
+    if (coefficients == NULL || t == NULL || positions == NULL){
+        free(coefficients);
+        free(t);
+        free(positions);
+        return -1;
+    }
+
+    // computing nodes of blocks of granules at once, so that the batch is spread over the pool of threads
+    for (first = 0, tail = 0.0; first < granules; first += m){
+        m = granules - first < block ? granules - first : block;
+        for (i = 0; i < m; i++)
+            compute_nodes(t0 + (first + i) * granule, granule, n, &t[i * n]);
+        geocentric_moon_positions(t, m * n, frame, positions);
+
+        for (i = 0; i < m; i++){
+            interpolate(&positions[i * 3 * n], n, &coefficients[(first + i) * 3 * n]);
+
+            // the error is estimated by magnitudes of the two highest coefficients
+            for (k = 0; k < 3; k++){
+                value = fabs(coefficients[((first + i) * n + degree) * 3 + k]) +
+                        fabs(coefficients[((first + i) * n + degree - 1) * 3 + k]);
+                tail = value > tail ? value : tail;
+            }
+        }
+    }
+
+    free(t);
+    free(positions);
+
+    ephemeris->start = t0;
+    ephemeris->granule = granule;
+    ephemeris->granules = granules;
+    ephemeris->degree = degree;
+    ephemeris->frame = frame;
+    ephemeris->tolerance = tail;
+    ephemeris->coefficients = coefficients;
+
+    return 0;
+}
+
+int chebyshev_choose(double t0, double t1, int frame, double tolerance, double *granule, int *degree)
+{
+    double t[CHEBYSHEV_SAMPLE_GRANULES * (CHEBYSHEV_MAX_DEGREE + 1)];          // nodes of the sampled granules
+    double positions[CHEBYSHEV_SAMPLE_GRANULES * (CHEBYSHEV_MAX_DEGREE + 1) * 3];
+    double coefficients[CHEBYSHEV_SAMPLE_GRANULES][(CHEBYSHEV_MAX_DEGREE + 1) * 3];
+    double tail[3];             // sums of magnitudes of the coefficients above the current degree
+    double length;              // length of the candidate granule, Julian centuries
+    double cost, best;          // amount of coefficients per day
+    int n = CHEBYSHEV_MAX_DEGREE + 1;
+    int granules;               // amount of granules of the candidate length
+    int samples;                // amount of sampled granules
+    int required;               // degree required by the candidate
+    int i, j, k, l;             // loop index variables
+
+    if (!(t1 >= t0) || !(tolerance > 0.0) || frame < 0 || frame >= TOTAL_ELP_FRAMES)
+        return -1;
+
+    for (i = 0, best = HUGE_VAL; i < (int)(sizeof(candidate_granules) / sizeof(candidate_granules[0])); i++){
+        length = candidate_granules[i] / JULIAN_CENTURY_DAYS;
+        if ((granules = count_granules(t0, t1, length)) < 0)
+            continue;
+
+        // interpolating sampled granules, spread evenly over the span, with polynomials of the maximum degree
+        samples = granules < CHEBYSHEV_SAMPLE_GRANULES ? granules : CHEBYSHEV_SAMPLE_GRANULES;
+        for (j = 0; j < samples; j++)
+            compute_nodes(t0 + (long long)j * granules / samples * length, length, n, &t[j * n]);
+        geocentric_moon_positions(t, samples * n, frame, positions);
+
+        // an interpolating polynomial of degree d differs from the function by at most twice the sum of magnitudes of
+        // the Chebyshev coefficients above d, which are estimated by the coefficients of the maximum degree
+        for (j = 0, required = CHEBYSHEV_MIN_DEGREE; j < samples; j++){
+            interpolate(&positions[j * 3 * n], n, coefficients[j]);
+            for (l = 0; l < 3; l++)
+                tail[l] = 0.0;
+            for (k = CHEBYSHEV_MAX_DEGREE; k >= CHEBYSHEV_MIN_DEGREE; k--){
+                if (2.0 * tail[0] > tolerance || 2.0 * tail[1] > tolerance || 2.0 * tail[2] > tolerance)
+                    break;
+                for (l = 0; l < 3; l++)
+                    tail[l] += fabs(coefficients[j][k * 3 + l]);
+            }
+            // k is the greatest degree whose tail exceeds the tolerance, thus degree k + 1 is needed; the highest
+            // coefficient is kept below the tolerance too, since coefficients above it are not known
+            k = k + 1;
+            if (2.0 * fabs(coefficients[j][CHEBYSHEV_MAX_DEGREE * 3]) > tolerance ||
+                2.0 * fabs(coefficients[j][CHEBYSHEV_MAX_DEGREE * 3 + 1]) > tolerance ||
+                2.0 * fabs(coefficients[j][CHEBYSHEV_MAX_DEGREE * 3 + 2]) > tolerance){
+                required = -1;
+                break;
+            }
+            required = k > required ? k : required;
+        }
+        if (required < 0)
+            continue;
+
+        cost = (required + 1) / candidate_granules[i];
+        if (cost < best){
+            best = cost;
+            *granule = length;
+            *degree = required;
+        }
+    }
+
+    return best < HUGE_VAL ? 0 : -1;
+}
+
+int chebyshev_fit_tolerance(double t0, double t1, int frame, double tolerance, chebyshev_ephemeris *ephemeris)
+{
+    double granule;             // chosen granule length
+    int degree;                 // chosen degree
+
+    if (chebyshev_choose(t0, t1, frame, tolerance, &granule, &degree) < 0)
+        return -1;
+    if (chebyshev_fit(t0, t1, frame, granule, degree, ephemeris) < 0)
+        return -1;
+
+    ephemeris->tolerance = tolerance;
+
+    return 0;
+}
+
+/*
+ * Finds the granule of an approximation covering time instant t, or the nearest one, and the time scaled to [-1, 1]
+ * within it (beyond it for time instants outside the span). Returns coefficients of the granule, or NULL if t is NaN.
+ */
+static const double *find_granule(const chebyshev_ephemeris *ephemeris, double t, double *x)
+{
+    double u;                   // time since the beginning of the span measured in granules
+    double clamped;             // u clamped to the granules of the span
+    int i;                      // index of the granule
+
+    u = (t - ephemeris->start) / ephemeris->granule;
+    if (isnan(u))
+        return NULL;
+
+    // both bounds are applied before the conversion, which is undefined for values out of the range of int
+    clamped = u < 0.0 ? 0.0 : u;
+    clamped = clamped < ephemeris->granules - 1 ? clamped : ephemeris->granules - 1;
+    i = (int)clamped;
+    *x = 2.0 * (u - i) - 1.0;
+
+    return &ephemeris->coefficients[i * 3 * (ephemeris->degree + 1)];
+}
+
+void chebyshev_evaluate(const chebyshev_ephemeris *ephemeris, double t, double position[], double velocity[])
+{
+    const double *c;            // coefficients of the granule
+    double x;                   // time scaled to [-1, 1] within the granule
+    double p[3], v[3];          // accumulating variables holding position and velocity
+    double tk, tk1, tk2;        // Chebyshev polynomials Tₖ, Tₖ₋₁ and Tₖ₋₂ at x
+    double dk, dk1, dk2;        // derivatives of Chebyshev polynomials Tₖ, Tₖ₋₁ and Tₖ₋₂ at x
+    double scale;               // derivative of x with respect to t
+    int k, l;                   // loop index variables
+
+    if ((c = find_granule(ephemeris, t, &x)) == NULL){
+        for (l = 0; l < 3; l++)
+            position[l] = NAN;
+        if (velocity != NULL)
+            for (l = 0; l < 3; l++)
+                velocity[l] = NAN;
+        return;
+    }
+
+    // T₀ = 1, T₁ = x, Tₖ = 2xTₖ₋₁ - Tₖ₋₂ and T'ₖ = 2Tₖ₋₁ + 2xT'ₖ₋₁ - T'ₖ₋₂
+    for (l = 0; l < 3; l++){
+        p[l] = c[l] + c[3 + l] * x;
+        v[l] = c[3 + l];
+    }
+    for (k = 2, tk1 = x, tk2 = 1.0, dk1 = 1.0, dk2 = 0.0; k <= ephemeris->degree; k++){
+        tk = 2.0 * x * tk1 - tk2;
+        dk = 2.0 * tk1 + 2.0 * x * dk1 - dk2;
+        for (l = 0; l < 3; l++){
+            p[l] += c[k * 3 + l] * tk;
+            v[l] += c[k * 3 + l] * dk;
+        }
+        tk2 = tk1;
+        tk1 = tk;
+        dk2 = dk1;
+        dk1 = dk;
+    }
+
+    scale = 2.0 / ephemeris->granule;
+    for (l = 0; l < 3; l++)
+        position[l] = p[l];
+    if (velocity != NULL)
+        for (l = 0; l < 3; l++)
+            velocity[l] = v[l] * scale;
+}
+
+void chebyshev_residual(const chebyshev_ephemeris *ephemeris, double t, double error[])
+{
+    const double *c;            // coefficients of the granule
+    double x;                   // time scaled to [-1, 1] within the granule
+    int l;                      // loop index variable
+
+    // the same estimate as the one of the fit, but of the granule only
+    c = find_granule(ephemeris, t, &x);
+    for (l = 0; l < 3; l++)
+        error[l] = c == NULL ? NAN : fabs(c[ephemeris->degree * 3 + l]) + fabs(c[(ephemeris->degree - 1) * 3 + l]);
+}
+
+void chebyshev_free(chebyshev_ephemeris *ephemeris)
+{
+    free((void *)ephemeris->coefficients);
+    ephemeris->coefficients = NULL;
+}
@@ -0,0 +1,93 @@
+/*
+ * chebyshev.h
+ *
+ * This file contains routines to fit Chebyshev polynomials to positions of the Moon computed by the ELP theory and to
+ * evaluate them instead of the series.
+ *
+ * A time span is split into granules of equal length. In each granule every coordinate of the given frame (one of
+ * ELP_frames, see elp2000-82b.h) is approximated by a Chebyshev series of the given degree
+ *
+ *                                  c₀T₀(x) + c₁T₁(x) + ... + cₙTₙ(x)
+ *
+ * where x ∈ [-1, 1] is the time scaled to the granule. Coefficients are found by interpolation at the Chebyshev nodes
+ * of each granule from positions computed by geocentric_moon_positions. The degree and the granule length may be given
+ * explicitly or chosen automatically to meet a tolerance with the least amount of coefficients.
+ *
+ * Evaluation finds the granule by a single division and sums the series with a loop of fixed length, without any data
+ * dependent branches. Velocities are computed together with positions by differentiating the series.
+ */
+
+#ifndef CHEBYSHEV_H
+#define CHEBYSHEV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CHEBYSHEV_MIN_DEGREE 1          // minimum degree of Chebyshev polynomials
+#define CHEBYSHEV_MAX_DEGREE 24         // maximum degree of Chebyshev polynomials
+#define CHEBYSHEV_SAMPLE_GRANULES 8     // amount of granules sampled while choosing degree and granule length
+
+/*
+ * A datatype describing Chebyshev approximation of positions of the Moon over a time span. Coefficients of granule i
+ * start at index 3(n + 1)i, where n is the degree, and are stored by degree first: for each k = 0..n three values
+ * cₖ of the three coordinates.
+ */
+typedef struct {
+    double start;                   // beginning of the time span, Julian centuries since J2000
+    double granule;                 // length of a granule, Julian centuries
+    int granules;                   // amount of granules
+    int degree;                     // degree of the polynomials
+    int frame;                      // coordinates and reference frame of positions (one of ELP_frames)
+    double tolerance;               // maximum approximation error in units of the coordinates of the frame
+    const double *coefficients;     // coefficients of all granules
+} chebyshev_ephemeris;
+
+/*
+ * Fits Chebyshev polynomials of the given degree to positions of the Moon in the given frame over the time span
+ * [t0, t1] (Julian centuries since J2000) split into granules of the given length (Julian centuries). The last granule
+ * may extend beyond t1. Tolerance of the result is estimated from the magnitudes of the highest coefficients.
+ * Returns zero on success or a negative value if the arguments are invalid or memory could not be allocated.
+ */
+int chebyshev_fit(double t0, double t1, int frame, double granule, int degree, chebyshev_ephemeris *ephemeris);
+
+/*
+ * Chooses the granule length (Julian centuries) and the degree of Chebyshev polynomials approximating positions of the
+ * Moon in the given frame over the time span [t0, t1] within the given tolerance, measured in arcseconds for angles and
+ * kilometers for distances. Granules of 1 to 32 days are tried, sampling CHEBYSHEV_SAMPLE_GRANULES granules of the
+ * span, and the combination with the least amount of coefficients per day is chosen.
+ * Returns zero on success or a negative value if no combination meets the tolerance.
+ */
+int chebyshev_choose(double t0, double t1, int frame, double tolerance, double *granule, int *degree);
+
+/*
+ * Fits Chebyshev polynomials to positions of the Moon in the given frame over the time span [t0, t1] within the given
+ * tolerance, choosing granule length and degree with chebyshev_choose.
+ * Returns zero on success or a negative value on failure.
+ */
+int chebyshev_fit_tolerance(double t0, double t1, int frame, double tolerance, chebyshev_ephemeris *ephemeris);
+
+/*
+ * Computes position of the Moon at time instant t (Julian centuries since J2000) and its velocity, measured in units
+ * of the coordinates per Julian century, from the given approximation. Velocity may be NULL. Time instants outside the
+ * time span are extrapolated from the nearest granule; NaN time gives NaN position and velocity.
+ */
+void chebyshev_evaluate(const chebyshev_ephemeris *ephemeris, double t, double position[], double velocity[]);
+
+/*
+ * Estimates the approximation error at time instant t (Julian centuries since J2000) by the magnitudes of the two
+ * highest coefficients of the granule covering it, writing three values in units of the coordinates into the given
+ * array. The estimate is the one of the tolerance of the fit, but of a single granule.
+ */
+void chebyshev_residual(const chebyshev_ephemeris *ephemeris, double t, double error[]);
+
+/*
+ * Releases coefficients of an approximation found by one of the fitting routines.
+ */
+void chebyshev_free(chebyshev_ephemeris *ephemeris);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CHEBYSHEV_H
@@ -0,0 +1,290 @@
+/*
+ * densegrid.c
+ */
+
+#include "densegrid.h"
+#include "elp2000-82b.h"
+#include "theory.h"
+#include "threadpool.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define FALLBACK_BLOCK_EPOCHS 1024      // amount of epochs computed at once by geocentric_moon_positions
+#define TOTAL_GROUPS 3                  // amount of sums of a coordinate: by powers of ms up to the second
+
+/*
+ * A datatype holding the context of a dense grid evaluation.
+ */
+typedef struct {
+    double start;               // first epoch, Julian centuries since J2000
+    double step;                // interval between epochs, Julian centuries
+    int64_t epochs;             // amount of epochs
+    int frame;                  // reference frame of the output
+    int chunk;                  // amount of epochs of a chunk
+    double *positions;          // output positions, three values per epoch
+} dense_grid;
+
+/*
+ * Computes halves of the second time derivatives of the Delaunay arguments at time instant t, measured in arcseconds
+ * per squared Julian century. Other arguments of the series are linear and their second derivatives vanish.
+ */
+static void compute_argument_curvatures(double t, serie_arguments *curvatures)
+{
+    double elp2000[TOTAL_ELP2000_ARGUMENTS];        // halves of second derivatives of ELP2000 arguments
+    double tn;                                      // n-th power of t at n-th iteration of the loop
+    int i, j;                                       // loop index variables
+
+    for (i = W1; i <= OBP; i++)
+        for (j = 2, elp2000[i] = 0.0, tn = 1.0; j < FULL_SERIES_TOTAL_TERMS; j++, tn *= t)
+            elp2000[i] += 0.5 * j * (j - 1) * elp2000_arguments_coefficients[i * FULL_SERIES_TOTAL_TERMS + j] * tn;
+
+    curvatures->delaunay[D] = elp2000[W1] - elp2000[T];
+    curvatures->delaunay[LP] = elp2000[T] - elp2000[OBP];
+    curvatures->delaunay[L] = elp2000[W1] - elp2000[W2];
+    curvatures->delaunay[F] = elp2000[W1] - elp2000[W3];
+    for (i = 0; i < TOTAL_DELAUNAY_ARGUMENTS; i++)
+        curvatures->reduced_delaunay[i] = 0.0;
+    curvatures->precession = 0.0;
+    for (i = 0; i < TOTAL_PLANETARY_ARGUMENTS; i++)
+        curvatures->planetary[i] = 0.0;
+}
+
+/*
+ * Computes the discrete Fourier transform Σxₖexp(2πijk/n) of n complex values (n is a power of two) in place by the
+ * iterative radix-2 algorithm. Complex values are stored as pairs of real and imaginary parts, the table of twiddle
+ * factors holds cos(2πk/n) and sin(2πk/n) for k < n/2.
+ */
+static void fourier_transform(double data[], int n, const double twiddles[])
+{
+    double xr, xi;              // product of a value and a twiddle factor
+    double swap;                // temporary value
+    int i, j, k, bit, length;   // loop index variables
+    int a, b, stride;           // indices of a butterfly and stride of twiddle factors
+
+    // reordering values by bit reversed indices
+    for (i = 1, j = 0; i < n; i++){
+        for (bit = n >> 1; j & bit; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+        if (i < j){
+            swap = data[2 * i], data[2 * i] = data[2 * j], data[2 * j] = swap;
+            swap = data[2 * i + 1], data[2 * i + 1] = data[2 * j + 1], data[2 * j + 1] = swap;
+        }
+    }
+
+    for (length = 2; length <= n; length <<= 1){
+        stride = n / length;
+        for (i = 0; i < n; i += length)
+            for (k = 0; k < length / 2; k++){
+                a = i + k;
+                b = a + length / 2;
+                xr = data[2 * b] * twiddles[2 * k * stride] - data[2 * b + 1] * twiddles[2 * k * stride + 1];
+                xi = data[2 * b] * twiddles[2 * k * stride + 1] + data[2 * b + 1] * twiddles[2 * k * stride];
+                data[2 * b] = data[2 * a] - xr;
+                data[2 * b + 1] = data[2 * a + 1] - xi;
+                data[2 * a] += xr;
+                data[2 * a + 1] += xi;
+            }
+    }
+}
+
+/*
+ * Computes positions of the given amount of epochs starting with the given one by geocentric_moon_positions.
+ */
+static void compute_directly(const dense_grid *grid, int64_t first, int64_t n)
+{
+    double t[FALLBACK_BLOCK_EPOCHS];    // time instants of a block
+    int64_t i;                          // loop index variable
+    int m;                              // amount of epochs of a block
+
+    for (; n > 0; first += m, n -= m){
+        m = n < FALLBACK_BLOCK_EPOCHS ? n : FALLBACK_BLOCK_EPOCHS;
+        for (i = 0; i < m; i++)
+            t[i] = grid->start + (first + i) * grid->step;
+        geocentric_moon_positions(t, m, grid->frame, &grid->positions[3 * first]);
+    }
+}
+
+/*
+ * Computes positions of a chunk of epochs by transforms of type 1 of the sums of all terms (see densegrid.h).
+ */
+static void compute_grid_chunk(void *context, int index)
+{
+    const dense_grid *grid = context;
+    serie_arguments arguments, rates, curvatures;   // arguments of the series and their derivatives at the center
+    double *sums[TOTAL_GROUPS];                     // grids of the sums of a coordinate by powers of ms
+    double *twiddles;                               // twiddle factors of the transform
+    double *coordinates;                            // spherical coordinates of the epochs of the chunk
+    double kernel[DENSE_GRID_SPREAD + 1];           // factors exp(-h²l²/4τ) of the spreading kernel
+    double weights[2 * DENSE_GRID_SPREAD];          // weights of the grid points around the frequency of a term
+    double factors[TOTAL_GROUPS];                   // binomial expansion of (t꜀ + ms)^p by powers of ms
+    double constants[TOTAL_GROUPS];                 // sums of constant terms of a coordinate by powers of ms
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];  // ELP2000 arguments
+    double tc;                                      // center of the chunk
+    double tau;                                     // variance parameter of the Gaussian kernel
+    double h;                                       // spacing of the grid of frequencies
+    double psi, theta, beta;                        // phase, frequency and curvature of a term, radians
+    double amplitude, cr, ci;                       // amplitude and complex coefficient of a term
+    double xr, xi;                                  // coefficient of a term in a sum
+    double d, e1, e2, e;                            // offset of a frequency from the grid and the kernel factors
+    double scale, value, sm;                        // deconvolution factor, value of a sum and the offset ms
+    const serie *s;                                 // current serie
+    int64_t first;                                  // first epoch of the chunk
+    int m, half, n, size;                           // amount of epochs, half of it, valid epochs and size of grids
+    int i, j, k, l, r, q;                           // loop index variables
+    int k0;                                         // grid point next to the frequency of a term
+    int used[TOTAL_GROUPS];                         // non zero if a grid holds any term
+
+    m = grid->chunk;
+    half = m / 2;
+    size = 2 * m;
+    first = (int64_t)index * m;
+    n = grid->epochs - first < m ? grid->epochs - first : m;
+
+    sums[0] = malloc(sizeof(double) * 2 * size * TOTAL_GROUPS);
+    twiddles = malloc(sizeof(double) * size);
+    coordinates = malloc(sizeof(double) * 3 * m);
+    if (sums[0] == NULL || twiddles == NULL || coordinates == NULL){
+        free(sums[0]);
+        free(twiddles);
+        free(coordinates);
+        compute_directly(grid, first, n);
+        return;
+    }
+    for (r = 1; r < TOTAL_GROUPS; r++)
+        sums[r] = sums[0] + 2 * size * r;
+    for (k = 0; k < size / 2; k++){
+        twiddles[2 * k] = cos(2.0 * M_PI * k / size);
+        twiddles[2 * k + 1] = sin(2.0 * M_PI * k / size);
+    }
+    for (k = 0; k < 3 * m; k++)
+        coordinates[k] = 0.0;
+
+    // Gaussian kernel for the oversampling ratio of 2 (L. Greengard, J.-Y. Lee. Accelerating the nonuniform fast
+    // Fourier transform. SIAM Review, vol. 46, 2004, pp. 443-454)
+    h = 2.0 * M_PI / size;
+    tau = M_PI * DENSE_GRID_SPREAD / (3.0 * m * m);
+    for (l = 0; l <= DENSE_GRID_SPREAD; l++)
+        kernel[l] = exp(-h * h * l * l / (4.0 * tau));
+
+    tc = grid->start + (first + half) * grid->step;
+    compute_serie_arguments(tc, &arguments);
+    compute_serie_argument_rates(tc, &rates);
+    compute_argument_curvatures(tc, &curvatures);
+
+    for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++){
+        for (k = 0; k < 2 * size * TOTAL_GROUPS; k++)
+            sums[0][k] = 0.0;
+        used[0] = used[1] = used[2] = 0;
+        constants[0] = constants[1] = constants[2] = 0.0;
+
+        for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+            s = &elp2000_series[i];
+            if (s->coordinate != l)
+                continue;
+            factors[0] = s->power == 0 ? 1.0 : s->power == 1 ? tc : tc * tc;
+            factors[1] = s->power == 0 ? 0.0 : s->power == 1 ? 1.0 : 2.0 * tc;
+            factors[2] = s->power == 2 ? 1.0 : 0.0;
+            for (r = 0; r < TOTAL_GROUPS; r++)
+                used[r] |= factors[r] != 0.0;
+            used[2] |= s->type == SERIE_A_SIN || s->type == SERIE_A_COS;
+
+            for (j = 0; j < s->n; j++){
+                psi = (compute_serie_term_argument(s, &arguments, j) + serie_term_phase(s, j)) * (M_PI / 648000.0);
+                theta = fmod(compute_serie_term_argument(s, &rates, j) * grid->step * (M_PI / 648000.0), 2.0 * M_PI);
+                if (theta < 0.0)
+                    theta += 2.0 * M_PI;
+                beta = compute_serie_term_argument(s, &curvatures, j) * (M_PI / 648000.0);
+                amplitude = serie_term_amplitude(s, j);
+                cr = amplitude * cos(psi);
+                ci = amplitude * sin(psi);
+
+                // constant terms, such as the mean distance, are added exactly rather than transformed
+                if (theta == 0.0 && beta == 0.0){
+                    for (r = 0; r < TOTAL_GROUPS; r++)
+                        constants[r] += ci * factors[r];
+                    continue;
+                }
+
+                // weights exp(-(lh - d)²/4τ) of grid points k0 + l are products of three factors, so that a single
+                // exponent of each kind is computed per term
+                k0 = (int)(theta / h);
+                d = theta - k0 * h;
+                e1 = exp(-d * d / (4.0 * tau));
+                e2 = exp(h * d / (2.0 * tau));
+                for (q = 0, e = e1; q <= DENSE_GRID_SPREAD; q++, e *= e2)
+                    weights[DENSE_GRID_SPREAD - 1 + q] = e * kernel[q];
+                for (q = 1, e = e1 / e2; q < DENSE_GRID_SPREAD; q++, e /= e2)
+                    weights[DENSE_GRID_SPREAD - 1 - q] = e * kernel[q];
+
+                for (r = 0; r < TOTAL_GROUPS; r++){
+                    // the quadratic correction βcos equals to the imaginary part of iβ times the coefficient
+                    xr = cr * factors[r] - (r == 2 ? beta * ci : 0.0);
+                    xi = ci * factors[r] + (r == 2 ? beta * cr : 0.0);
+                    if (xr == 0.0 && xi == 0.0)
+                        continue;
+                    for (q = 0; q < 2 * DENSE_GRID_SPREAD; q++){
+                        k = (k0 + q - DENSE_GRID_SPREAD + 1 + size) & (size - 1);
+                        sums[r][2 * k] += weights[q] * xr;
+                        sums[r][2 * k + 1] += weights[q] * xi;
+                    }
+                }
+            }
+        }
+
+        // transforming the grids and dividing them by the transform of the kernel
+        for (r = 0; r < TOTAL_GROUPS; r++)
+            if (used[r])
+                fourier_transform(sums[r], size, twiddles);
+        for (q = 0; q < n; q++){
+            j = q - half;
+            k = j < 0 ? size + j : j;
+            scale = sqrt(M_PI / tau) / size * exp(j * j * tau);
+            sm = j * grid->step;
+            for (r = TOTAL_GROUPS - 1, value = 0.0; r >= 0; r--)
+                value = value * sm + (used[r] ? sums[r][2 * k + 1] * scale : 0.0) + constants[r];
+            coordinates[3 * q + l] = value;
+        }
+    }
+
+    // adding mean mean longitude of the Moon (W₁) and referring positions to the requested frame
+    for (q = 0; q < n; q++){
+        tc = grid->start + (first + q) * grid->step;
+        compute_elp2000_arguments(tc, FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+        coordinates[3 * q + LONGITUDE] += elp2000_arguments[W1];
+        refer_position_to_frame(tc, &coordinates[3 * q], grid->frame, &grid->positions[3 * (first + q)]);
+    }
+
+    free(sums[0]);
+    free(twiddles);
+    free(coordinates);
+}
+
+int geocentric_moon_dense_grid(double start, double step, int64_t epochs, int frame, double positions[])
+{
+    dense_grid grid;            // context of the evaluation
+
+    if (epochs < 0 || !(step > 0.0) || frame < 0 || frame >= TOTAL_ELP_FRAMES)
+        return -1;
+
+    grid.start = start;
+    grid.step = step;
+    grid.epochs = epochs;
+    grid.frame = frame;
+    grid.positions = positions;
+
+    // chunks are shortened to keep the expansion of the Main Problem accurate
+    for (grid.chunk = DENSE_GRID_CHUNK; grid.chunk > DENSE_GRID_MIN_CHUNK && grid.chunk * step > DENSE_GRID_MAX_SPAN;)
+        grid.chunk /= 2;
+
+    if (epochs < grid.chunk || grid.chunk * step > DENSE_GRID_MAX_SPAN || (epochs - 1) / grid.chunk >= INT_MAX){
+        compute_directly(&grid, 0, epochs);
+        return 0;
+    }
+
+    thread_pool_run(compute_grid_chunk, &grid, (epochs + grid.chunk - 1) / grid.chunk);
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+/*
+ * densegrid.h
+ *
+ * This file contains a routine to compute positions of the Moon at large amounts of equally spaced epochs faster than
+ * by computing the series at each of them.
+ *
+ * Epochs are split into chunks of DENSE_GRID_CHUNK epochs. Within a chunk centered at t꜀ every term At^psin(φ(t)) at
+ * epoch t꜀ + ms (m = -M/2..M/2 - 1, s being the step) is expanded into
+ *
+ *              (t꜀ + ms)^p A[sin(φ꜀ + mθ) + β(ms)²cos(φ꜀ + mθ)],    θ = φ'(t꜀)s,    β = φ''(t꜀)/2,
+ *
+ * which is exact for the linear arguments of the perturbations, while the quadratic correction β accounts for the
+ * quartic arguments of the Main Problem (omitted higher powers stay below 10⁻⁸ arcseconds over a chunk). Collecting
+ * terms by coordinate and by power of ms, each coordinate becomes a few sums Σcⱼexp(imθⱼ) over all terms at M
+ * consecutive integers m: non-uniform discrete Fourier transforms of type 1. They are computed by Gaussian gridding:
+ * the coefficients are spread onto an oversampled uniform grid of 2M frequencies by a Gaussian kernel truncated to
+ * DENSE_GRID_SPREAD grid points at each side, the grid is transformed by a radix-2 FFT and the result is divided by the
+ * Fourier transform of the kernel; constant terms are added exactly. The cost of a chunk is O(terms + M log M) rather
+ * than O(terms × M), and errors of the sums stay about 10⁻¹¹ of the sums of amplitudes, i.e. a few 10⁻⁷ arcseconds
+ * and kilometers.
+ *
+ * Chunks are computed by the threads of the pool. Steps too long for chunks of at least DENSE_GRID_MIN_CHUNK epochs to
+ * span at most DENSE_GRID_MAX_SPAN, as well as too few epochs, are computed by geocentric_moon_positions.
+ */
+
+#ifndef DENSEGRID_H
+#define DENSEGRID_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DENSE_GRID_CHUNK 4096           // amount of epochs of a chunk, a power of two
+#define DENSE_GRID_MIN_CHUNK 256        // minimum amount of epochs of a chunk
+#define DENSE_GRID_MAX_SPAN 0.01        // maximum time span of a chunk, Julian centuries
+#define DENSE_GRID_SPREAD 12            // half width of the spreading kernel, grid points
+
+/*
+ * Computes positions of the Moon in the given coordinates and reference frame (one of ELP_frames) at the given amount
+ * of epochs start + i·step (Julian centuries since J2000), writing three values per epoch into the given array.
+ * Returns zero on success or a negative value if the arguments are invalid or memory could not be allocated.
+ */
+int geocentric_moon_dense_grid(double start, double step, int64_t epochs, int frame, double positions[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DENSEGRID_H
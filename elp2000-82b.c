@@ -3,226 +3,583 @@
  * Created by Serhii Tsyba (sertsy@gmail.com) on 21.04.10.
  */
 
-#include "mainprob.h"
-#include "earthfig.h"
-#include "planetary1.h"
-#include "planetary2.h"
-#include "tidal.h"
-#include "moonfig.h"
-#include "relativistic.h"
-#include "solarecc.h"
-
 #include "elp2000-82b.h"
-#include "series.h"
-#include "arguments.h"
+#include "autotune.h"
+#include "frames.h"
+#include "segcache.h"
+#include "shmcache.h"
+#include "theory.h"
+#include "threadpool.h"
+#include "tilecache.h"
 
 #include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define PARALLEL_CHUNK_TERMS 1024       // least amount of terms of a serie computed by a single parallel task
+#define MAX_PARALLEL_TASKS 128          // maximum amount of parallel tasks of a single evaluation
+#define BATCH_CHUNK_EPOCHS 16           // amount of time instants computed by a single batch task
+#define MAXIMUM_DISTANCE 410000.0       // bound of the distance of the Moon, kilometers
+
+/*
+ * A datatype describing a parallel task: a part of a serie consisting of n terms starting from the first one.
+ */
+typedef struct {
+    int serie;                  // index of the serie in elp2000_series
+    int first;                  // index of the first term
+    int n;                      // amount of terms
+} serie_chunk;
+
+/*
+ * A datatype holding a partial sum of a serie, aligned to a cache line so that concurrent tasks do not share one.
+ */
+typedef struct {
+    _Alignas(64) double value;
+} partial_sum;
+
+/*
+ * A datatype holding the context of a parallel evaluation.
+ */
+typedef struct {
+    serie_arguments arguments;                  // arguments of the series
+    partial_sum sums[MAX_PARALLEL_TASKS];       // partial sums of the series computed by each task
+} parallel_evaluation;
+
+/*
+ * A datatype holding the context of a batch evaluation.
+ */
+typedef struct {
+    const double *t;            // time instants
+    int n;                      // amount of time instants
+    int frame;                  // reference frame of the output
+    double threshold;           // amplitude threshold of the terms to be computed
+    double *positions;          // output positions, three values per time instant
+} batch_evaluation;
+
+static serie_chunk chunks[MAX_PARALLEL_TASKS];  // parts of the series computed by parallel tasks
+static int total_chunks;                        // amount of parts of the series
+static pthread_once_t chunks_once = PTHREAD_ONCE_INIT;
+static pthread_once_t batch_pool_once = PTHREAD_ONCE_INIT;
+static double *term_periods[TOTAL_ELP2000_SERIES];    // periods of the terms of the series, days
+static pthread_once_t term_periods_once = PTHREAD_ONCE_INIT;
+static double *amplitude_tails[TOTAL_ELP2000_SERIES]; // sorted absolute values of amplitudes and sums of their tails
+static pthread_once_t amplitude_tails_once = PTHREAD_ONCE_INIT;
+
+_Static_assert(MAX_PARALLEL_TASKS > TOTAL_ELP2000_SERIES, "every serie needs a parallel task of its own");
+
+/*
+ * Splits all series into parts of at most PARALLEL_CHUNK_TERMS terms, or more if the series need more than
+ * MAX_PARALLEL_TASKS parts. The split depends only on the sizes of the series, thus results of parallel evaluations do
+ * not depend on the amount of threads.
+ */
+static void split_series(void)
+{
+    int terms;                  // maximum amount of terms of a part
+    int total;                  // amount of terms of all series
+    int i, j;                   // loop index variables
+
+    // each serie ends with at most one part shorter than the others, thus total / terms + TOTAL_ELP2000_SERIES parts
+    // are enough
+    for (i = 0, total = 0; i < TOTAL_ELP2000_SERIES; i++)
+        total += elp2000_series[i].n;
+    terms = (total + MAX_PARALLEL_TASKS - TOTAL_ELP2000_SERIES - 1) / (MAX_PARALLEL_TASKS - TOTAL_ELP2000_SERIES);
+    terms = terms > PARALLEL_CHUNK_TERMS ? terms : PARALLEL_CHUNK_TERMS;
+
+    for (i = 0, total_chunks = 0; i < TOTAL_ELP2000_SERIES; i++){
+        for (j = 0; j < elp2000_series[i].n; j += terms){
+            chunks[total_chunks].serie = i;
+            chunks[total_chunks].first = j;
+            chunks[total_chunks].n = elp2000_series[i].n - j < terms ? elp2000_series[i].n - j : terms;
+            total_chunks++;
+        }
+    }
+}
+
+static void compute_chunk(void *context, int index)
+{
+    parallel_evaluation *evaluation = context;
+    const serie_chunk *chunk = &chunks[index];
+
+    evaluation->sums[index].value = compute_serie(&elp2000_series[chunk->serie], &evaluation->arguments,
+                                                  chunk->first, chunk->n);
+}
+
+/*
+ * Computes position of the Moon at time instant t in the given frame from the first running cache of Chebyshev
+ * approximations covering it: the shared memory object, the in-memory cache of segments or the persistent cache of
+ * tiles, and the estimate of its error unless the error array is NULL. Returns non zero if the position was computed,
+ * or zero if no cache is running or covers t.
+ */
+static int compute_cached_position(double t, int frame, double position[], double error[])
+{
+    if (shm_cache_running() && shm_cache_position(t, frame, position, NULL, error) == 0)
+        return 1;
+    if (segment_cache_running()){
+        segment_cache_position(t, frame, position, NULL, error);
+        return 1;
+    }
+    if (tile_cache_running()){
+        tile_cache_position(t, frame, position, NULL, error);
+        return 1;
+    }
+
+    return 0;
+}
 
 spherical_point geocentric_moon_position(double t)
 {
-    double delaunay_arguments[TOTAL_DELAUNAY_ARGUMENTS];        // Delaunay arguments
+    serie_arguments arguments;                                  // arguments of the series
     double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];          // ELP2000 arguments
-    double planetary_arguments[TOTAL_PLANETARY_ARGUMENTS];      // planetary arguments
-    double zeta;                                                // argument of the precession precession (ζ)
+    double coordinates[TOTAL_SPHERICAL_COORDINATES];            // longitude, latitude and distance
+    double value;                                               // value of a serie
+    int i, j;                                                   // loop index variables
     spherical_point sp;                                         // result position of the Moon
 
+    // computing position from the caches of Chebyshev approximations if any of them is running
+    if (compute_cached_position(t, ELP2000_SPHERICAL, coordinates, NULL)){
+        sp.longitude = coordinates[LONGITUDE];
+        sp.latitude = coordinates[LATITUDE];
+        sp.distance = coordinates[DISTANCE];
+        return sp;
+    }
+
     // each coordinate (longitude, latitude and radial distance) is computed by adding together results of each serie:
     // Main Porblem and all perturbations; then, Moon's mean mean longitude (W₁) must be added to the value of the
     // longitude to find the actual position
-    
-    // computing Delaunay arguments (non reduced)
-    compute_delaunay_arguments(t, FULL_SERIES_TOTAL_TERMS, delaunay_arguments);
-    
-    // computing Main Problem
-    sp.longitude = compute_serie_a_sin(delaunay_arguments, main_problem_longitude_multipliers,
-                                       main_problem_longitude_coefficients, TOTAL_MAIN_PROBLEM_LONGITUDE_TERMS);
-    sp.latitude = compute_serie_a_sin(delaunay_arguments, main_problem_latitude_multipliers,
-                                      main_problem_latitude_coefficients, TOTAL_MAIN_PROBLEM_LATITUDE_TERMS);
-    sp.distance = compute_serie_a_cos(delaunay_arguments, main_problem_distance_multipliers,
-                                      main_problem_distance_coefficients, TOTAL_MAIN_PROBLEM_DISTANCE_TERMS);
-
-    // recomputing reduced Delaunay arguments
-    compute_delaunay_arguments(t, LINEAR_SERIES_TOTAL_TERMS, delaunay_arguments);
-    // computing ELP2000 arguments
-    compute_elp2000_arguments(t, LINEAR_SERIES_TOTAL_TERMS, elp2000_arguments);
-    // computing precession argument
-    zeta = compute_precession_argument(t);
-
-    // computing Earth figure perturbations (constant)
-    sp.longitude += compute_serie_b(zeta, delaunay_arguments, earth_figure_longitude_0_multipliers,
-                                    earth_figure_longitude_0_coefficients, TOTAL_EARTH_FIGURE_LONGITUDE_0_TERMS);
-    sp.latitude += compute_serie_b(zeta, delaunay_arguments, earth_figure_latitude_0_multipliers,
-                                   earth_figure_latitude_0_coefficients, TOTAL_EARTH_FIGURE_LATITUDE_0_TERMS);
-    sp.distance += compute_serie_b(zeta, delaunay_arguments, earth_figure_distance_0_multipliers,
-                                   earth_figure_distance_0_coefficients, TOTAL_EARTH_FIGURE_DISTANCE_0_TERMS);
-
-    // computing Earth figure perturbations (linear)
-    sp.longitude += compute_serie_b(zeta, delaunay_arguments, earth_figure_longitude_0_multipliers,
-                                    earth_figure_longitude_0_coefficients, TOTAL_EARTH_FIGURE_LONGITUDE_0_TERMS) * t;
-    sp.latitude += compute_serie_b(zeta, delaunay_arguments, earth_figure_latitude_0_multipliers,
-                                   earth_figure_latitude_0_coefficients, TOTAL_EARTH_FIGURE_LATITUDE_0_TERMS) * t;
-    sp.distance += compute_serie_b(zeta, delaunay_arguments, earth_figure_distance_0_multipliers,
-                                   earth_figure_distance_0_coefficients,TOTAL_EARTH_FIGURE_DISTANCE_0_TERMS) * t;
-
-    // computing planetary arguments
-    compute_planetary_arguments(t, planetary_arguments);
-
-    // computing planetary 1 perturbations (constant)
-    sp.longitude += compute_serie_c(planetary_arguments, delaunay_arguments, planetary1_longitude_0_multipliers,
-                                    planetary1_longitude_0_coefficients, TOTAL_PLANETARY1_LONGITUDE_0_TERMS);
-    sp.latitude += compute_serie_c(planetary_arguments, delaunay_arguments, planetary1_latitude_0_multipliers,
-                                   planetary1_latitude_0_coefficients, TOTAL_PLANETARY1_LATITUDE_0_TERMS);
-    sp.distance += compute_serie_c(planetary_arguments, delaunay_arguments, planetary1_distance_0_multipliers,
-                                   planetary1_distance_0_coefficients, TOTAL_PLANETARY1_DISTANCE_0_TERMS);
-
-    // computing planetary 1 perturbations (linear)
-    sp.longitude += compute_serie_c(planetary_arguments, delaunay_arguments, planetary1_longitude_1_multipliers,
-                                    planetary1_longitude_1_coefficients, TOTAL_PLANETARY1_LONGITUDE_1_TERMS) * t;
-    sp.latitude += compute_serie_c(planetary_arguments, delaunay_arguments, planetary1_latitude_1_multipliers,
-                                   planetary1_latitude_1_coefficients, TOTAL_PLANETARY1_LATITUDE_1_TERMS) * t;
-    sp.distance += compute_serie_c(planetary_arguments, delaunay_arguments, planetary1_distance_1_multipliers,
-                                   planetary1_distance_1_coefficients, TOTAL_PLANETARY1_DISTANCE_1_TERMS) * t;
-
-    // computing planetary 2 perturbations (constant)
-    sp.longitude += compute_serie_d(planetary_arguments, delaunay_arguments, planetary2_longitude_0_multipliers,
-                                    planetary2_longitude_0_coefficients, TOTAL_PLANETARY2_LONGITUDE_0_TERMS);
-    sp.latitude += compute_serie_d(planetary_arguments, delaunay_arguments, planetary2_latitude_0_multipliers,
-                                   planetary2_latitude_0_coefficients, TOTAL_PLANETARY2_LATITUDE_0_TERMS);
-    sp.distance += compute_serie_d(planetary_arguments, delaunay_arguments, planetary2_distance_0_multipliers,
-                                   planetary2_distance_0_coefficients, TOTAL_PLANETARY2_DISTANCE_0_TERMS);
-
-    // computing planetary 2 perturbations (linear)
-    sp.longitude += compute_serie_d(planetary_arguments, delaunay_arguments, planetary2_longitude_1_multipliers,
-                           planetary2_longitude_1_coefficients, TOTAL_PLANETARY2_LONGITUDE_1_TERMS) * t;
-    sp.latitude += compute_serie_d(planetary_arguments, delaunay_arguments, planetary2_latitude_1_multipliers,
-                           planetary2_latitude_1_coefficients, TOTAL_PLANETARY2_LATITUDE_1_TERMS) * t;
-    sp.distance += compute_serie_d(planetary_arguments, delaunay_arguments, planetary2_distance_1_multipliers,
-                           planetary2_distance_1_coefficients, TOTAL_PLANETARY2_DISTANCE_1_TERMS) * t;
-
-    // computing tidal effects (constant)
-    sp.longitude += compute_serie_b(zeta, delaunay_arguments, tidal_longitude_0_multipliers,
-                           tidal_longitude_0_coefficients, TOTAL_TIDAL_LONGITUDE_0_TERMS);
-    sp.latitude += compute_serie_b(zeta, delaunay_arguments, tidal_latitude_0_multipliers,
-                           tidal_latitude_0_coefficients, TOTAL_TIDAL_LATITUDE_0_TERMS);
-    sp.distance += compute_serie_b(zeta, delaunay_arguments, tidal_distance_0_multipliers,
-                           tidal_distance_0_coefficients, TOTAL_TIDAL_DISTANCE_0_TERMS);
-
-    // computing tidal effects (linear)
-    sp.longitude += compute_serie_b(zeta, delaunay_arguments, tidal_longitude_1_multipliers,
-                           tidal_longitude_1_coefficients, TOTAL_TIDAL_LONGITUDE_1_TERMS) * t;
-    sp.latitude += compute_serie_b(zeta, delaunay_arguments, tidal_latitude_1_multipliers,
-                           tidal_latitude_1_coefficients, TOTAL_TIDAL_LATITUDE_1_TERMS) * t;
-    sp.distance += compute_serie_b(zeta, delaunay_arguments, tidal_distance_1_multipliers,
-                           tidal_distance_1_coefficients, TOTAL_TIDAL_DISTANCE_1_TERMS) * t;
-
-    // computing Moon figure perturbations
-    sp.longitude += compute_serie_b(zeta, delaunay_arguments, moon_figure_longitude_multipliers,
-                           moon_figure_longitude_coefficients, TOTAL_MOON_FIGURE_LONGITUDE_TERMS);
-    sp.latitude += compute_serie_b(zeta, delaunay_arguments, moon_figure_latitude_multipliers,
-                           moon_figure_latitude_coefficients, TOTAL_MOON_FIGURE_LATITUDE_TERMS);
-    sp.distance += compute_serie_b(zeta, delaunay_arguments, moon_figure_distance_multipliers,
-                           moon_figure_distance_coefficients, TOTAL_MOON_FIGURE_DISTANCE_TERMS);
-
-    // computing relativistic perturbations
-    sp.longitude += compute_serie_b(zeta, delaunay_arguments, relativistic_longitude_multipliers,
-                           relativistic_longitude_coefficients, TOTAL_RELATIVISTIC_LONGITUDE_TERMS);
-    sp.latitude += compute_serie_b(zeta, delaunay_arguments, relativistic_latitude_multipliers,
-                           relativistic_latitude_coefficients, TOTAL_RELATIVISTIC_LATITUDE_TERMS);
-    sp.distance += compute_serie_b(zeta, delaunay_arguments, relativistic_distance_multipliers,
-                           relativistic_distance_coefficients, TOTAL_RELATIVISTIC_DISTANCE_TERMS);
-
-    // computing planetary perturbations (solar eccentricity) (quadratic)
-    sp.longitude += compute_serie_b(zeta, delaunay_arguments, planetary_longitude_2_multipliers,
-                           planetary_longitude_2_coefficients, TOTAL_PLANETARY_LONGITUDE_2_TERMS) * t * t;
-    sp.latitude += compute_serie_b(zeta, delaunay_arguments, planetary_latitude_2_multipliers,
-                           planetary_latitude_2_coefficients, TOTAL_PLANETARY_LATITUDE_2_TERMS) * t * t;
-    sp.distance += compute_serie_b(zeta, delaunay_arguments, planetary_distance_2_multipliers,
-                           planetary_distance_2_coefficients, TOTAL_PLANETARY_DISTANCE_2_TERMS) * t * t;
-
-    // recomputing full ELP2000 arguments
+
+    // computing Delaunay, precession and planetary arguments
+    compute_serie_arguments(t, &arguments);
+
+    // computing all series, each multiplied by its power of t
+    coordinates[LONGITUDE] = coordinates[LATITUDE] = coordinates[DISTANCE] = 0.0;
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        value = compute_serie(&elp2000_series[i], &arguments, 0, elp2000_series[i].n);
+        for (j = 0; j < elp2000_series[i].power; j++)
+            value *= t;
+        coordinates[elp2000_series[i].coordinate] += value;
+    }
+
+    // computing full ELP2000 arguments
     compute_elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
-    
+
     // adding mean mean longitude of the Moon (W₁)
-    sp.longitude += elp2000_arguments[W1];
+    sp.longitude = coordinates[LONGITUDE] + elp2000_arguments[W1];
+    sp.latitude = coordinates[LATITUDE];
+    sp.distance = coordinates[DISTANCE];
 
     return sp;
 }
 
-spherical_point geocentric_moon_position_of_date(double t)
+spherical_point geocentric_moon_position_parallel(double t)
+{
+    parallel_evaluation evaluation;                             // context of the evaluation
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];          // ELP2000 arguments
+    double coordinates[TOTAL_SPHERICAL_COORDINATES];            // longitude, latitude and distance
+    double value;                                               // value of a serie
+    int i, j, k;                                                // loop index variables
+    spherical_point sp;                                         // result position of the Moon
+
+    pthread_once(&chunks_once, split_series);
+
+    // computing arguments once and sharing them with all tasks
+    compute_serie_arguments(t, &evaluation.arguments);
+    thread_pool_run(compute_chunk, &evaluation, total_chunks);
+
+    // adding partial sums together in a fixed order
+    coordinates[LONGITUDE] = coordinates[LATITUDE] = coordinates[DISTANCE] = 0.0;
+    for (i = 0, k = 0; i < TOTAL_ELP2000_SERIES; i++){
+        for (value = 0.0; k < total_chunks && chunks[k].serie == i; k++)
+            value += evaluation.sums[k].value;
+        for (j = 0; j < elp2000_series[i].power; j++)
+            value *= t;
+        coordinates[elp2000_series[i].coordinate] += value;
+    }
+
+    // adding mean mean longitude of the Moon (W₁)
+    compute_elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+    sp.longitude = coordinates[LONGITUDE] + elp2000_arguments[W1];
+    sp.latitude = coordinates[LATITUDE];
+    sp.distance = coordinates[DISTANCE];
+
+    return sp;
+}
+
+/*
+ * Refers position of the Moon in spherical coordinates from the ELP 2000 reference frame to the internal mean ecliptic
+ * and equinox of date.
+ */
+static spherical_point refer_to_date(double t, spherical_point sp)
 {
-    spherical_point sp;         // geocentric Moon position referred to ELP reference frame
     double p;                   // accumulated precession between J2000 and a given date
-    
-    // calculating Moon's position referred to ELP reference frame
-    sp = geocentric_moon_position(t);
-    
+
     // computing accumulated precession between J2000 and a given date
-    p = 5029.0966 * t + 1.1120 * t * t + 0.000077 * t * t * t - 0.00002353 * t * t * t * t;
-    
+    p = precession_coefficients[1] * t + precession_coefficients[2] * t * t + precession_coefficients[3] * t * t * t +
+        precession_coefficients[4] * t * t * t * t;
+
     // adding accumulated precession to the longitude of Moon's position
     sp.longitude += p;
-    
+
     return sp;
 }
 
-cartesian_3d_point geocentric_moon_position_cartesian(double t)
+/*
+ * Converts position of the Moon from spherical to rectangular coordinates.
+ */
+static cartesian_3d_point convert_to_cartesian(spherical_point sp)
 {
-    spherical_point sp;         // a value in spherical coordinates
     cartesian_3d_point rp;      // resulting value in rectangular coordiantes (reference frame of ELP2000)
 
-    // computing Moon's position in spherical coordinates
-    sp = geocentric_moon_position(t);
-    
     // converting longitude and latitude from arcseconds to radians (π = 368000")
     sp.longitude *= M_PI / 648000.0;
     sp.latitude *= M_PI / 648000.0;
-    
+
     // converting to rectangular coordinates
     rp.x = sp.distance * cos(sp.longitude) * cos(sp.latitude);
     rp.y = sp.distance * sin(sp.longitude) * cos(sp.latitude);
     rp.z = sp.distance * sin(sp.latitude);
-    
+
     return rp;
 }
 
-cartesian_3d_point geocentric_moon_position_cartesian_of_J2000(double t)
+/*
+ * Refers position of the Moon in rectangular coordinates from the ELP 2000 reference frame to the mean dynamical
+ * ecliptic and equinox of J2000.
+ */
+static cartesian_3d_point refer_to_J2000(double t, cartesian_3d_point rp)
 {
-    cartesian_3d_point rp;      // position of the Moon in rectangular coordinates referred to the ELP2000 reference frame
     cartesian_3d_point re2000p; // position of the Moon in rectangular coordinates referred to the internal mean ecliptic
                                 // and equinox of J2000
     double p, q;                // intermediate auxiliary convertion variables from Laskar's series
-    
-    // computing Moon's position in rectangular coordinates referred to the ELP2000 reference frame
-    rp = geocentric_moon_position_cartesian(t);
-    
+
     // computing p and q
-    p = 0.10180391e-4 * t + 0.47020439e-6 * t * t - 0.5417367e-9 * t * t * t -
-    0.2507948e-11 * t * t * t * t + 0.463486e-14 * t * t * t * t * t;
-    q = -0.113469002e-3 * t + 0.12372674e-6 * t * t + 0.12654170e-8 * t * t * t -
-    0.1371808e-11 * t * t * t * t - 0.320334e-14 * t * t * t * t * t;
-    
+    p = laskar_p_coefficients[1] * t + laskar_p_coefficients[2] * t * t + laskar_p_coefficients[3] * t * t * t +
+    laskar_p_coefficients[4] * t * t * t * t + laskar_p_coefficients[5] * t * t * t * t * t;
+    q = laskar_q_coefficients[1] * t + laskar_q_coefficients[2] * t * t + laskar_q_coefficients[3] * t * t * t +
+    laskar_q_coefficients[4] * t * t * t * t + laskar_q_coefficients[5] * t * t * t * t * t;
+
     // performing rotation of ELP2000 reference frame into mean dynamical ecliptic and equinox of J2000
     re2000p.x = (1 - 2 * p * p) * rp.x + 2 * p * q * rp.y + 2 * p * sqrt(1 - p * p - q * q) * rp.z;
     re2000p.y = 2 * p * q * rp.x + (1 - 2 * q * q) * rp.y -  2 * q * sqrt(1 - p * p - q * q) * rp.z;
     re2000p.z = -2 * p * sqrt(1 - p * p - q * q) * rp.x + 2 * q * sqrt(1 - p * p - q * q)  * rp.y + (1 - 2 * p * p - 2 * q * q) * rp.z;
-    
+
     return re2000p;
 }
 
-cartesian_3d_point geocentric_moon_position_cartesian_of_FK5(double t)
+/*
+ * Refers position of the Moon in rectangular coordinates from the mean dynamical ecliptic and equinox of J2000 to the
+ * FK5 equator.
+ */
+static cartesian_3d_point refer_to_FK5(cartesian_3d_point re2000p)
 {
-    cartesian_3d_point re2000p;     // position of the Moon in rectangular coordianted referred to the internal mean
-                                    // ecliptic and equinox of J2000
     cartesian_3d_point rfk5p;       // position of the Moon in rectangular coordinates referred to the FK5 equator ♈FK5
                                     // (mean equator and rotational mean equinox of J2000)
-    
-    // computing Moon's position in rectangular coordinates referred to the internal mean ecliptic and equinox of J2000
-    re2000p = geocentric_moon_position_cartesian_of_J2000(t);
-    
+
     // performing transformation to rectangular coordinates referred to the FK5 equator
-    rfk5p.x =  1.000000000000 * re2000p.x + 0.000000437913 * re2000p.y - 0.000000189859 * re2000p.z;
-    rfk5p.y = -0.000000477299 * re2000p.x + 0.917482137607 * re2000p.y - 0.397776981791 * re2000p.z;
-    rfk5p.z =  0.000000000000 * re2000p.x + 0.397776981701 * re2000p.y + 0.917482137607 * re2000p.z;
-    
+    rfk5p.x = fk5_rotation[0][0] * re2000p.x + fk5_rotation[0][1] * re2000p.y + fk5_rotation[0][2] * re2000p.z;
+    rfk5p.y = fk5_rotation[1][0] * re2000p.x + fk5_rotation[1][1] * re2000p.y + fk5_rotation[1][2] * re2000p.z;
+    rfk5p.z = fk5_rotation[2][0] * re2000p.x + fk5_rotation[2][1] * re2000p.y + fk5_rotation[2][2] * re2000p.z;
+
     return rfk5p;
-}
\ No newline at end of file
+}
+
+/*
+ * Refers position of the Moon given in spherical coordinates of the ELP 2000 reference frame to the given frame and
+ * writes it into the given array of three values.
+ */
+static void refer_to_frame(double t, spherical_point sp, int frame, double position[])
+{
+    cartesian_3d_point rp;      // position of the Moon in rectangular coordinates
+
+    switch (frame){
+        case OF_DATE_SPHERICAL:
+            sp = refer_to_date(t, sp);
+            // fall through
+        case ELP2000_SPHERICAL:
+            position[0] = sp.longitude;
+            position[1] = sp.latitude;
+            position[2] = sp.distance;
+            return;
+        case ELP2000_CARTESIAN:
+            rp = convert_to_cartesian(sp);
+            break;
+        case J2000_CARTESIAN:
+            rp = refer_to_J2000(t, convert_to_cartesian(sp));
+            break;
+        case FK5_CARTESIAN:
+        default:
+            rp = refer_to_FK5(refer_to_J2000(t, convert_to_cartesian(sp)));
+            break;
+    }
+
+    position[0] = rp.x;
+    position[1] = rp.y;
+    position[2] = rp.z;
+}
+
+spherical_point geocentric_moon_position_of_date(double t)
+{
+    return refer_to_date(t, geocentric_moon_position(t));
+}
+
+cartesian_3d_point geocentric_moon_position_cartesian(double t)
+{
+    return convert_to_cartesian(geocentric_moon_position(t));
+}
+
+cartesian_3d_point geocentric_moon_position_cartesian_of_J2000(double t)
+{
+    return refer_to_J2000(t, geocentric_moon_position_cartesian(t));
+}
+
+cartesian_3d_point geocentric_moon_position_cartesian_of_FK5(double t)
+{
+    return refer_to_FK5(geocentric_moon_position_cartesian_of_J2000(t));
+}
+
+void geocentric_moon_position_in_frame(double t, int frame, double position[])
+{
+    if (compute_cached_position(t, frame, position, NULL))
+        return;
+
+    refer_to_frame(t, geocentric_moon_position(t), frame, position);
+}
+
+void geocentric_moon_position_with_error(double t, int frame, double position[], double error[])
+{
+    if (compute_cached_position(t, frame, position, error))
+        return;
+
+    refer_to_frame(t, geocentric_moon_position(t), frame, position);
+    error[0] = error[1] = error[2] = 0.0;
+}
+
+/*
+ * Refers errors of spherical coordinates of the ELP 2000 reference frame to the given frame (one of ELP_frames).
+ * Errors of angles are kept in spherical frames, while each rectangular coordinate is bounded by the error of distance
+ * and the arcs of the errors of angles at the greatest distance of the Moon.
+ */
+static void refer_error_to_frame(const double spherical[], int frame, double error[])
+{
+    if (frame == ELP2000_SPHERICAL || frame == OF_DATE_SPHERICAL){
+        error[0] = spherical[0];
+        error[1] = spherical[1];
+        error[2] = spherical[2];
+    } else {
+        error[0] = error[1] = error[2] = spherical[2] + MAXIMUM_DISTANCE * (spherical[0] + spherical[1]) *
+                                                        (M_PI / 648000.0);
+    }
+}
+
+void refer_position_to_frame(double t, const double spherical[], int frame, double position[])
+{
+    spherical_point sp;         // position in spherical coordinates
+
+    sp.longitude = spherical[0];
+    sp.latitude = spherical[1];
+    sp.distance = spherical[2];
+    refer_to_frame(t, sp, frame, position);
+}
+
+/*
+ * Computes periods of all terms of the series from the rates of their arguments at J2000. Series whose periods could
+ * not be stored are computed in full by mean positions.
+ */
+static void compute_term_periods(void)
+{
+    serie_arguments rates;      // rates of the arguments
+    int i, j;                   // loop index variables
+
+    compute_serie_argument_rates(0.0, &rates);
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        term_periods[i] = malloc(sizeof(double) * elp2000_series[i].n);
+        for (j = 0; term_periods[i] != NULL && j < elp2000_series[i].n; j++)
+            term_periods[i][j] = serie_term_period(&elp2000_series[i], &rates, j);
+    }
+}
+
+void geocentric_moon_mean_position(double t, int frame, double cutoff, double position[], double error[])
+{
+    serie_arguments arguments;                                  // arguments of the series
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];          // ELP2000 arguments
+    double coordinates[TOTAL_SPHERICAL_COORDINATES];            // longitude, latitude and distance
+    double skipped[TOTAL_SPHERICAL_COORDINATES];                // bounds of the skipped terms of each coordinate
+    double value, bound;                                        // value of a serie and bound of its skipped terms
+    const double *periods;                                      // periods of the terms of the current serie
+    int i, j, k;                                                // loop index variables
+
+    pthread_once(&term_periods_once, compute_term_periods);
+
+    compute_serie_arguments(t, &arguments);
+
+    // computing runs of consecutive terms with periods not shorter than the cutoff, skipping all other terms
+    coordinates[LONGITUDE] = coordinates[LATITUDE] = coordinates[DISTANCE] = 0.0;
+    skipped[LONGITUDE] = skipped[LATITUDE] = skipped[DISTANCE] = 0.0;
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        periods = term_periods[i];
+        for (j = 0, value = bound = 0.0; j < elp2000_series[i].n; j = k){
+            for (k = j; k < elp2000_series[i].n && (periods == NULL || periods[k] >= cutoff); k++)
+                ;
+            if (k > j)
+                value += compute_serie(&elp2000_series[i], &arguments, j, k - j);
+            else
+                bound += fabs(serie_term_amplitude(&elp2000_series[i], k++));
+        }
+        for (j = 0; j < elp2000_series[i].power; j++){
+            value *= t;
+            bound *= fabs(t);
+        }
+        coordinates[elp2000_series[i].coordinate] += value;
+        skipped[elp2000_series[i].coordinate] += bound;
+    }
+
+    // adding mean mean longitude of the Moon (W₁)
+    compute_elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+    coordinates[LONGITUDE] += elp2000_arguments[W1];
+
+    refer_position_to_frame(t, coordinates, frame, position);
+    if (error != NULL)
+        refer_error_to_frame(skipped, frame, error);
+}
+
+/*
+ * Compares two values for sorting in decreasing order.
+ */
+static int compare_decreasing(const void *a, const void *b)
+{
+    double va = *(const double *)a;     // the first value
+    double vb = *(const double *)b;     // the second value
+
+    return va > vb ? -1 : va < vb ? 1 : 0;
+}
+
+/*
+ * Sorts absolute values of amplitudes of each serie in decreasing order and stores them followed by the sums of their
+ * tails: the sum of the amplitudes from the j-th one on is stored at index n + j. Series whose amplitudes could not be
+ * stored are bounded as a whole.
+ */
+static void compute_amplitude_tails(void)
+{
+    double *a;                  // sorted amplitudes and sums of tails of the current serie
+    int i, j, n;                // loop index variables and the size of the serie
+
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        n = elp2000_series[i].n;
+        if ((a = amplitude_tails[i] = malloc(sizeof(double) * (2 * n + 1))) == NULL)
+            continue;
+
+        for (j = 0; j < n; j++)
+            a[j] = fabs(serie_term_amplitude(&elp2000_series[i], j));
+        qsort(a, n, sizeof(double), compare_decreasing);
+        for (j = n, a[2 * n] = 0.0; j > 0; j--)
+            a[n + j - 1] = a[n + j] + a[j - 1];
+    }
+}
+
+void geocentric_moon_truncation_error(double t, int frame, double threshold, double error[])
+{
+    double skipped[TOTAL_SPHERICAL_COORDINATES];    // bounds of the skipped terms of each coordinate
+    double bound;                                   // bound of the skipped terms of a serie
+    const double *a;                                // sorted amplitudes and sums of tails of the current serie
+    int low, high, middle;                          // bounds of the range searched and its middle
+    int i, j, n;                                    // loop index variables and the size of the serie
+
+    pthread_once(&amplitude_tails_once, compute_amplitude_tails);
+
+    skipped[LONGITUDE] = skipped[LATITUDE] = skipped[DISTANCE] = 0.0;
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        n = elp2000_series[i].n;
+        if ((a = amplitude_tails[i]) == NULL){
+            for (j = 0, bound = 0.0; j < n; j++)
+                bound += fabs(serie_term_amplitude(&elp2000_series[i], j));
+        } else {
+            // finding the amount of terms not less than the threshold, the rest of them is skipped
+            for (low = 0, high = n; low < high;){
+                middle = (low + high) / 2;
+                if (a[middle] >= threshold)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            bound = a[n + low];
+        }
+        for (j = 0; j < elp2000_series[i].power; j++)
+            bound *= fabs(t);
+        skipped[elp2000_series[i].coordinate] += bound;
+    }
+
+    refer_error_to_frame(skipped, frame, error);
+}
+
+/*
+ * Computes a chunk of a batch: positions of the Moon at up to BATCH_CHUNK_EPOCHS consecutive time instants. Each serie
+ * is read once for the whole chunk.
+ */
+static void compute_batch_chunk(void *context, int index)
+{
+    batch_evaluation *batch = context;
+    serie_arguments arguments[BATCH_CHUNK_EPOCHS];              // arguments of the series at each time instant
+    double coordinates[BATCH_CHUNK_EPOCHS][TOTAL_SPHERICAL_COORDINATES];
+    double sums[BATCH_CHUNK_EPOCHS];                            // values of a serie at each time instant
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];          // ELP2000 arguments
+    const double *t;                                            // time instants of the chunk
+    int m;                                                      // amount of time instants in the chunk
+    int i, j, k;                                                // loop index variables
+    spherical_point sp;                                         // position of the Moon
+
+    t = batch->t + index * BATCH_CHUNK_EPOCHS;
+    m = batch->n - index * BATCH_CHUNK_EPOCHS < BATCH_CHUNK_EPOCHS ? batch->n - index * BATCH_CHUNK_EPOCHS :
+        BATCH_CHUNK_EPOCHS;
+
+    for (k = 0; k < m; k++){
+        compute_serie_arguments(t[k], &arguments[k]);
+        coordinates[k][LONGITUDE] = coordinates[k][LATITUDE] = coordinates[k][DISTANCE] = 0.0;
+    }
+
+    // computing all series, each multiplied by its power of t, in the same order as geocentric_moon_position does
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        compute_serie_block(&elp2000_series[i], arguments, m, batch->threshold, sums);
+        for (k = 0; k < m; k++){
+            for (j = 0; j < elp2000_series[i].power; j++)
+                sums[k] *= t[k];
+            coordinates[k][elp2000_series[i].coordinate] += sums[k];
+        }
+    }
+
+    // adding mean mean longitude of the Moon (W₁) and referring positions to the requested frame
+    for (k = 0; k < m; k++){
+        compute_elp2000_arguments(t[k], FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+        sp.longitude = coordinates[k][LONGITUDE] + elp2000_arguments[W1];
+        sp.latitude = coordinates[k][LATITUDE];
+        sp.distance = coordinates[k][DISTANCE];
+        refer_to_frame(t[k], sp, batch->frame, &batch->positions[(index * BATCH_CHUNK_EPOCHS + k) * 3]);
+    }
+}
+
+/*
+ * Starts the pool of threads for batches with the amount of threads tuned for the host, unless it was started by the
+ * user.
+ */
+static void start_batch_pool(void)
+{
+    if (thread_pool_size() == 0)
+        thread_pool_start_from_environment(elp_tuning_current()->threads);
+}
+
+void geocentric_moon_positions(const double t[], int n, int frame, double positions[])
+{
+    geocentric_moon_positions_truncated(t, n, frame, 0.0, positions);
+}
+
+void geocentric_moon_positions_truncated(const double t[], int n, int frame, double threshold, double positions[])
+{
+    batch_evaluation batch;     // context of the batch
+
+    pthread_once(&batch_pool_once, start_batch_pool);
+
+    batch.t = t;
+    batch.n = n;
+    batch.frame = frame;
+    batch.threshold = threshold;
+    batch.positions = positions;
+    thread_pool_run(compute_batch_chunk, &batch, (n + BATCH_CHUNK_EPOCHS - 1) / BATCH_CHUNK_EPOCHS);
+}
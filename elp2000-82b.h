@@ -18,6 +18,13 @@
  *      geocentric_moon_position_cartesian_of_K5 - computes position of the Moon in three dimensional cartesian
  *         coordiante system referred to the FK5 reference frame;
  *
+ * Routines geocentric_moon_position_in_frame and geocentric_moon_positions compute position of the Moon in any of the
+ * above coordinates and reference frames, given by ELP_frames, at a single time instant or at many time instants
+ * at once.
+ *
+ * Additionally geocentric_moon_position_parallel computes the same position as geocentric_moon_position spreading the
+ * computations over the threads of the pool (see threadpool.h). It is meant for latency critical single queries.
+ *
  * Each of these functions takes a single input argument t - a time instant measured in Julian centuries since the
  * beginning of the epoch J2000 and can be found by the following formula:
  *
@@ -61,6 +68,24 @@
 #ifndef ELP2000_H
 #define ELP2000_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOTAL_ELP_FRAMES 5              // total amount of supported output coordinates and reference frames
+
+/*
+ * An enumeration indexing output coordinates and reference frames of the routines computing positions of the Moon for
+ * a given frame.
+ */
+enum ELP_frames {
+    ELP2000_SPHERICAL = 0,      // spherical coordinates, ELP 2000 reference frame (geocentric_moon_position)
+    OF_DATE_SPHERICAL = 1,      // spherical coordinates, mean ecliptic and equinox of date
+    ELP2000_CARTESIAN,          // rectangular coordinates, ELP 2000 reference frame
+    J2000_CARTESIAN,            // rectangular coordinates, mean ecliptic and equinox of J2000
+    FK5_CARTESIAN = 4           // rectangular coordinates, FK5 equator
+};
+
 /*
  * A datatype defining spherical coordiantes point consisting of longitude, latitude and radial distance (altitude).
  */
@@ -127,4 +152,85 @@ cartesian_3d_point geocentric_moon_position_cartesian_of_J2000(double t);
  */
 cartesian_3d_point geocentric_moon_position_cartesian_of_FK5(double t);
 
+/*
+ * Computes geocentric position of the Moon in spherical coordiantes (longitude, latitude, distance) referred to the
+ * ELP 2000 reference frame, same as geocentric_moon_position, but splits the series into parts computed in parallel by
+ * the threads of the pool. The pool must be started beforehand with thread_pool_start, otherwise all parts are
+ * computed by the calling thread.
+ * Partial sums are added together in a fixed order, thus results do not depend on the amount of threads, but may
+ * differ from geocentric_moon_position in the last digits due to rounding.
+ */
+spherical_point geocentric_moon_position_parallel(double t);
+
+/*
+ * Computes geocentric position of the Moon in the given coordinates and reference frame (one of ELP_frames). Input
+ * value t is the amount of Julian centuries since the beginning of the epoch J2000.
+ * Output is written into the given array of three values: longitude, latitude and distance for spherical frames or
+ * x, y and z for rectangular ones, measured the same way as by the routine of the corresponding frame.
+ */
+void geocentric_moon_position_in_frame(double t, int frame, double position[]);
+
+/*
+ * Computes geocentric position of the Moon the same way as geocentric_moon_position_in_frame does together with the
+ * estimate of its error relative to the full theory, written into the given array of three values in units of the
+ * coordinates. The estimate is the approximation residual of the segment (see chebyshev_residual) if the position is
+ * computed by one of the caches, and zero if it is computed from the series.
+ */
+void geocentric_moon_position_with_error(double t, int frame, double position[], double error[]);
+
+/*
+ * Refers position of the Moon at time instant t (Julian centuries since J2000) given in spherical coordinates of the
+ * ELP 2000 reference frame (longitude, latitude and distance) to the given coordinates and reference frame (one of
+ * ELP_frames), the same way as geocentric_moon_position_in_frame does. Output is written into the given array of three
+ * values. It is meant for positions computed by other means than the routines above.
+ */
+void refer_position_to_frame(double t, const double spherical[], int frame, double position[]);
+
+/*
+ * Computes geocentric positions of the Moon at n time instants in the given coordinates and reference frame (one of
+ * ELP_frames). Input array t holds amounts of Julian centuries since the beginning of the epoch J2000.
+ * Output is written into the given array of 3n values, three values per time instant in the order of input. Positions
+ * are always computed from the full series, thus they equal the ones of geocentric_moon_position_in_frame without
+ * caches; while a cache of Chebyshev approximations is running, the latter returns fitted values instead, which differ
+ * by up to the residual of the approximation (see chebyshev_residual).
+ *
+ * Time instants are split into chunks computed by the threads of the pool (see threadpool.h), which balance the load
+ * by stealing chunks from each other. Unless the pool is started by the user, it is started on the first call with
+ * the amount of threads given by environment variables (see thread_pool_start_from_environment) or tuned for the host
+ * (see autotune.h).
+ */
+void geocentric_moon_positions(const double t[], int n, int frame, double positions[]);
+
+/*
+ * Computes geocentric positions of the Moon at n time instants the same way as geocentric_moon_positions does, but
+ * skips all terms of the series with absolute values of amplitudes less than the given threshold, measured in
+ * arcseconds for longitude and latitude and in kilometers for distance. Zero threshold computes the full theory.
+ * Greater thresholds trade accuracy for speed.
+ */
+void geocentric_moon_positions_truncated(const double t[], int n, int frame, double threshold, double positions[]);
+
+/*
+ * Estimates the error of the position of the Moon at time instant t computed in the given frame with the given
+ * threshold (see geocentric_moon_positions_truncated), writing three values in units of the coordinates into the given
+ * array. The estimate is the sum of the bounds |A||t|^p of the skipped terms of each coordinate, found from sums of
+ * amplitudes sorted once, thus a call costs a binary search per serie. Rectangular coordinates are bounded by the
+ * error of distance and the errors of angles at the greatest distance of the Moon.
+ */
+void geocentric_moon_truncation_error(double t, int frame, double threshold, double error[]);
+
+/*
+ * Computes mean geocentric position of the Moon at time instant t (Julian centuries since J2000) in the given
+ * coordinates and reference frame (one of ELP_frames), skipping all terms of the series with periods shorter than the
+ * given cutoff, measured in days. Positions are thus smoothed over the cutoff: a cutoff of a day removes the shortest
+ * terms, a cutoff of 35 days removes all monthly and shorter variations, while zero cutoff computes the full theory.
+ * Periods of the terms are found once from the rates of their arguments; the fewer terms remain, the cheaper the call.
+ * Unless the error array is NULL, the bound of the skipped terms of each coordinate is written into it the same way as
+ * by geocentric_moon_truncation_error, i.e. the deviation of the mean position from the full theory.
+ */
+void geocentric_moon_mean_position(double t, int frame, double cutoff, double position[], double error[]);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // ELP2000_H
\ No newline at end of file
@@ -0,0 +1,189 @@
+/*
+ * elp2000-82b.hpp
+ *
+ * This file provides a C++ (C++20) layer over the routines of elp2000-82b.h.
+ *
+ * Class ephemeris_range gives geocentric positions of the Moon at time instants t₀, t₀ + Δt, t₀ + 2Δt, ... up to t₁ as
+ * a lazily computed input range:
+ *
+ *      for (const elp2000::ephemeris_point &point : elp2000::ephemeris_range(t0, t1, dt, FK5_CARTESIAN))
+ *          process(point.t, point.position);
+ *
+ * Positions are computed in blocks with geocentric_moon_positions_truncated. While the consumer goes through the
+ * current block, the next one is computed on a background thread, so that computations are hidden behind processing
+ * of the results. The range may be iterated only once.
+ *
+ * Time instants are measured in Julian centuries since the beginning of the epoch J2000; frames and units are the ones
+ * of geocentric_moon_position_in_frame.
+ */
+
+#ifndef ELP2000_HPP
+#define ELP2000_HPP
+
+#include "elp2000-82b.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace elp2000 {
+
+/*
+ * A datatype holding position of the Moon at a time instant.
+ */
+struct ephemeris_point {
+    double t;                           // time instant
+    std::array<double, 3> position;     // position of the Moon in the frame of the range
+};
+
+class ephemeris_range {
+private:
+    /*
+     * State of a range: the block being consumed and the computation of the next one.
+     */
+    class generator {
+    public:
+        generator(double t0, double step, std::size_t n, int frame, std::size_t block, double threshold)
+            : t0(t0), step(step), n(n), frame(frame), block(block > 0 ? block : 1), threshold(threshold) {}
+
+        ~generator()
+        {
+            if (next.valid())
+                next.wait();
+        }
+
+        // starts computations of the first blocks
+        void start()
+        {
+            if (started)
+                return;
+            started = true;
+            next = launch(0);
+            take_next();
+        }
+
+        // moves to the next position, taking the next block once the current one is consumed
+        void advance()
+        {
+            if (++position == current.size() && next.valid())
+                take_next();
+        }
+
+        bool exhausted() const { return position >= current.size(); }
+
+        const double t0, step;
+        const std::size_t n;
+        const int frame;
+        const std::size_t block;
+        const double threshold;
+
+        std::vector<ephemeris_point> current;
+        std::size_t position = 0;
+
+    private:
+        // computes the block starting at the given index on a background thread
+        std::future<std::vector<ephemeris_point>> launch(std::size_t first)
+        {
+            return std::async(std::launch::async, [this, first] {
+                std::size_t m = std::min(block, n - first);
+                std::vector<double> t(m), positions(3 * m);
+                std::vector<ephemeris_point> points(m);
+
+                for (std::size_t i = 0; i < m; i++)
+                    t[i] = t0 + step * static_cast<double>(first + i);
+                geocentric_moon_positions_truncated(t.data(), static_cast<int>(m), frame, threshold, positions.data());
+                for (std::size_t i = 0; i < m; i++)
+                    points[i] = {t[i], {positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]}};
+
+                return points;
+            });
+        }
+
+        // makes the computed block current and starts computations of the one after it
+        void take_next()
+        {
+            current = next.get();
+            position = 0;
+            taken += current.size();
+            if (taken < n)
+                next = launch(taken);
+        }
+
+        std::future<std::vector<ephemeris_point>> next;
+        std::size_t taken = 0;
+        bool started = false;
+    };
+
+    // amount of time instants from t0 to t1 with the given step
+    static std::size_t count(double t0, double t1, double step)
+    {
+        if (!(step > 0.0) || t1 < t0)
+            return 0;
+        return static_cast<std::size_t>(std::floor((t1 - t0) / step * (1.0 + 1e-12))) + 1;
+    }
+
+public:
+    static constexpr std::size_t default_block = 1024;     // default amount of time instants in a block
+
+    /*
+     * Creates a range of positions in the given frame at time instants from t0 to t1 with the given step, computed in
+     * blocks of the given size with the given amplitude threshold (see geocentric_moon_positions_truncated).
+     */
+    ephemeris_range(double t0, double t1, double step, int frame = ELP2000_SPHERICAL,
+                    std::size_t block = default_block, double threshold = 0.0)
+        : state(std::make_shared<generator>(t0, step, count(t0, t1, step), frame, block, threshold)) {}
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ephemeris_point;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const ephemeris_point *;
+        using reference = const ephemeris_point &;
+
+        iterator() = default;
+
+        reference operator*() const { return state->current[state->position]; }
+        pointer operator->() const { return &state->current[state->position]; }
+
+        iterator &operator++()
+        {
+            state->advance();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator &it, std::default_sentinel_t) { return it.state->exhausted(); }
+
+    private:
+        friend class ephemeris_range;
+        explicit iterator(std::shared_ptr<generator> state) : state(std::move(state)) {}
+
+        std::shared_ptr<generator> state;
+    };
+
+    iterator begin()
+    {
+        state->start();
+        return iterator(state);
+    }
+
+    std::default_sentinel_t end() const { return {}; }
+
+    /*
+     * Returns the amount of time instants in the range.
+     */
+    std::size_t size() const { return state->n; }
+
+private:
+    std::shared_ptr<generator> state;
+};
+
+} // namespace elp2000
+
+#endif // ELP2000_HPP
@@ -0,0 +1,142 @@
+/*
+ * elp2000-archive.c
+ *
+ * A tool writing positions of the Moon computed by the ELP theory into compact archives and reading them back (see
+ * archive.h). Usage
+ *
+ *                  elp2000-archive [-c] start step epochs frame tolerance file
+ *                  elp2000-archive file epoch
+ *
+ * The first form writes positions at the given amount of epochs start + i·step (Julian centuries since J2000) in the
+ * given frame, one of ELP_frames (see elp2000-82b.h), within the given tolerance measured in arcseconds for angles and
+ * kilometers for distances. Positions are computed from the series, or with -c from Chebyshev polynomials fitted to
+ * the epochs within a tenth of the tolerance (see chebyshev.h). The archive is then mapped back, its checksums are
+ * checked and every decoded position is compared with the one written; the greatest difference of each coordinate is
+ * printed and the tool fails if any of them exceeds the tolerance.
+ *
+ * The second form prints the position at the given epoch (start + epoch·step) of an archive.
+ */
+
+#include "archive.h"
+#include "elp2000-82b.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Checks the archive with the given path against the positions it was written from, printing the greatest difference
+ * of each coordinate. Returns zero if all of them are within the tolerance or a negative value otherwise.
+ */
+static int check_archive(const char *path, const chebyshev_ephemeris *source)
+{
+    archive a;                                  // mapped archive
+    double t[ARCHIVE_BLOCK_EPOCHS];             // epochs of a block
+    double decoded[3 * ARCHIVE_BLOCK_EPOCHS];   // decoded positions of a block
+    double written[3 * ARCHIVE_BLOCK_EPOCHS];   // positions of a block the archive was written from
+    double difference[3] = {0.0, 0.0, 0.0};     // greatest differences of the coordinates
+    uint64_t b;                                 // index of the current block
+    int n;                                      // amount of epochs of the current block
+    int i, k;                                   // loop index variables
+    int error;                                  // error of reading
+
+    if ((error = archive_open(path, &a)) != 0){
+        fprintf(stderr, "could not open %s: error %d\n", path, error);
+        return -1;
+    }
+    if ((error = archive_verify(&a)) != 0){
+        fprintf(stderr, "could not verify %s: error %d\n", path, error);
+        archive_close(&a);
+        return -1;
+    }
+
+    for (b = 0; b < a.header->blocks; b++){
+        if ((n = archive_decode_block(&a, b, decoded)) < 0){
+            fprintf(stderr, "could not decode block %llu of %s\n", (unsigned long long)b, path);
+            archive_close(&a);
+            return -1;
+        }
+        for (i = 0; i < n; i++)
+            t[i] = a.header->start + (int64_t)(b * a.header->block_epochs + i) * a.header->step;
+        if (source != NULL)
+            for (i = 0; i < n; i++)
+                chebyshev_evaluate(source, t[i], &written[3 * i], NULL);
+        else
+            geocentric_moon_positions(t, n, a.header->frame, written);
+        for (i = 0; i < n; i++)
+            for (k = 0; k < 3; k++)
+                // leaving out the rounding of the coordinates themselves
+                difference[k] = fmax(difference[k], fabs(decoded[3 * i + k] - written[3 * i + k]) -
+                                                    4.0 * DBL_EPSILON * fabs(written[3 * i + k]));
+    }
+
+    printf("%.3g %.3g %.3g\n", difference[0], difference[1], difference[2]);
+    error = difference[0] > a.header->tolerance || difference[1] > a.header->tolerance ||
+            difference[2] > a.header->tolerance ? -1 : 0;
+    archive_close(&a);
+
+    return error;
+}
+
+int main(int argc, char *argv[])
+{
+    chebyshev_ephemeris ephemeris;      // fitted polynomials
+    chebyshev_ephemeris *source = NULL; // source of positions, NULL for the series
+    archive a;                          // mapped archive
+    double start, step, tolerance;      // epochs and tolerance
+    double position[3];                 // position at an epoch
+    int64_t epochs;                     // amount of epochs, or an epoch to read
+    int frame;                          // reference frame
+    int error;                          // error of writing or reading
+
+    if (argc == 3){
+        epochs = atoll(argv[2]);
+        if ((error = archive_open(argv[1], &a)) != 0){
+            fprintf(stderr, "%s: could not open %s: error %d\n", argv[0], argv[1], error);
+            return EXIT_FAILURE;
+        }
+        error = archive_position(&a, epochs, position);
+        if (error == 0)
+            printf("%.17g %.17g %.17g\n", position[0], position[1], position[2]);
+        else
+            fprintf(stderr, "%s: %s has no epoch %lld\n", argv[0], argv[1], (long long)epochs);
+        archive_close(&a);
+        return error == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (argc == 8 && strcmp(argv[1], "-c") == 0){
+        source = &ephemeris;
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+    if (argc != 7){
+        fprintf(stderr, "usage: %s [-c] start step epochs frame tolerance file\n       %s file epoch\n", argv[0],
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    start = atof(argv[1]);
+    step = atof(argv[2]);
+    epochs = atoll(argv[3]);
+    frame = atoi(argv[4]);
+    tolerance = atof(argv[5]);
+
+    if (source != NULL &&
+        chebyshev_fit_tolerance(start, start + (epochs - 1) * step, frame, 0.1 * tolerance, &ephemeris) < 0){
+        fprintf(stderr, "%s: could not fit the epochs within the tolerance\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ((error = archive_write(argv[6], start, step, epochs, frame, tolerance, source)) != 0)
+        fprintf(stderr, "%s: could not write %s: error %d\n", argv[0], argv[6], error);
+    else
+        error = check_archive(argv[6], source);
+
+    if (source != NULL)
+        chebyshev_free(&ephemeris);
+
+    return error == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
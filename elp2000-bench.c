@@ -0,0 +1,130 @@
+/*
+ * elp2000-bench.c
+ *
+ * A tool measuring parallel evaluation of positions of the Moon against the serial one (see threadpool.h). Usage
+ *
+ *                          elp2000-bench [threads [epochs]]
+ *
+ * where threads is the amount of threads, the calling one included, defaulting to the amount of online processor
+ * cores, and epochs is the amount of time instants of each measurement, 1000 by default. The tool prints the wall
+ * clock time of a position computed by geocentric_moon_position and geocentric_moon_position_parallel, and of a
+ * position of a batch computed by a loop of geocentric_moon_position_in_frame and by geocentric_moon_positions, each
+ * the least of five runs, together with the speedups of the parallel routines.
+ */
+
+#include "elp2000-82b.h"
+#include "threadpool.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_REPEATS 5         // amount of runs of each measurement
+
+/*
+ * Returns the time of the monotonic clock in seconds.
+ */
+static double current_time(void)
+{
+    struct timespec now;        // current time
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/*
+ * Returns the least time of a position of BENCH_REPEATS runs over n time instants computed by the given routine: 0 for
+ * geocentric_moon_position, 1 for geocentric_moon_position_parallel, 2 for geocentric_moon_position_in_frame and 3 for
+ * geocentric_moon_positions.
+ */
+static double measure(int routine, const double t[], int n, double positions[])
+{
+    double best, start;         // least time and the time a run started at
+    volatile double sink;       // result kept from being optimized away
+    int i, k;                   // loop index variables
+
+    for (i = 0, best = HUGE_VAL; i < BENCH_REPEATS; i++){
+        start = current_time();
+        switch (routine){
+            case 0:
+                for (k = 0; k < n; k++)
+                    sink = geocentric_moon_position(t[k]).longitude;
+                break;
+            case 1:
+                for (k = 0; k < n; k++)
+                    sink = geocentric_moon_position_parallel(t[k]).longitude;
+                break;
+            case 2:
+                for (k = 0; k < n; k++)
+                    geocentric_moon_position_in_frame(t[k], ELP2000_SPHERICAL, &positions[3 * k]);
+                break;
+            default:
+                geocentric_moon_positions(t, n, ELP2000_SPHERICAL, positions);
+                break;
+        }
+        best = fmin(best, current_time() - start);
+    }
+    (void)sink;
+
+    return best / n;
+}
+
+int main(int argc, char *argv[])
+{
+    double *t, *positions;          // time instants and positions
+    double serial, parallel;        // times of a position of serial and parallel single positions
+    double loop, batch;             // times of a position of a loop and a batch
+    long threads;                   // amount of threads
+    int n;                          // amount of time instants
+    int k;                          // loop index variable
+
+    if (argc > 3){
+        fprintf(stderr, "usage: %s [threads [epochs]]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    threads = argc > 1 ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+    threads = threads < 1 ? 1 : threads > MAX_POOL_THREADS + 1 ? MAX_POOL_THREADS + 1 : threads;
+    n = argc > 2 ? atoi(argv[2]) : 1000;
+    n = n < 1 ? 1 : n;
+
+    t = malloc(sizeof(double) * n);
+    positions = malloc(sizeof(double) * 3 * n);
+    if (t == NULL || positions == NULL){
+        free(t);
+        free(positions);
+        return EXIT_FAILURE;
+    }
+    for (k = 0; k < n; k++)
+        t[k] = k / 36525.0;
+
+    thread_pool_stop();
+    if (threads > 1 && thread_pool_start((int)threads - 1, 0) != 0){
+        fprintf(stderr, "%s: could not start %ld threads\n", argv[0], threads);
+        free(t);
+        free(positions);
+        return EXIT_FAILURE;
+    }
+
+    // warming up, which also splits and packs the series
+    measure(1, t, n < 10 ? n : 10, positions);
+    measure(3, t, n < 10 ? n : 10, positions);
+
+    serial = measure(0, t, n, positions);
+    parallel = measure(1, t, n, positions);
+    loop = measure(2, t, n, positions);
+    batch = measure(3, t, n, positions);
+
+    printf("threads %ld, epochs %d\n", threads, n);
+    printf("single position: serial %.2f us, parallel %.2f us, speedup %.2f\n", serial * 1e6, parallel * 1e6,
+           serial / parallel);
+    printf("batch position:  loop %.2f us, batch %.2f us, speedup %.2f\n", loop * 1e6, batch * 1e6, loop / batch);
+
+    thread_pool_stop();
+    free(t);
+    free(positions);
+
+    return EXIT_SUCCESS;
+}
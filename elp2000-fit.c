@@ -0,0 +1,84 @@
+/*
+ * elp2000-fit.c
+ *
+ * A tool fitting Chebyshev polynomials to positions of the Moon computed by the ELP theory (see chebyshev.h). Usage
+ *
+ *                          elp2000-fit [-o file | -s name] t0 t1 frame tolerance
+ *
+ * where t0 and t1 bound the time span (Julian centuries since J2000), frame is one of ELP_frames (see elp2000-82b.h)
+ * and tolerance is measured in arcseconds for angles and kilometers for distances. The tool chooses granule length and
+ * degree of the polynomials and either writes the fit into the given binary file (see chebfile.h), publishes it into
+ * the given shared memory object (see shmcache.h) or prints it as text: a header line holding the beginning of the
+ * span, granule length, amount of granules, degree, frame and tolerance, followed by a line of coefficients for each
+ * granule.
+ */
+
+#include "chebfile.h"
+#include "shmcache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+    chebyshev_ephemeris ephemeris;      // fitted polynomials
+    double t0, t1, tolerance;           // time span and tolerance
+    int frame;                          // reference frame
+    const char *output = NULL;          // path of the binary output file
+    const char *shared = NULL;          // name of the shared memory object
+    int i, k;                           // loop index variables
+
+    if (argc == 7 && (strcmp(argv[1], "-o") == 0 || strcmp(argv[1], "-s") == 0)){
+        if (argv[1][1] == 'o')
+            output = argv[2];
+        else
+            shared = argv[2];
+        argv += 2;
+        argc -= 2;
+    }
+    if (argc != 5){
+        fprintf(stderr, "usage: %s [-o file | -s name] t0 t1 frame tolerance\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    t0 = atof(argv[1]);
+    t1 = atof(argv[2]);
+    frame = atoi(argv[3]);
+    tolerance = atof(argv[4]);
+
+    if (chebyshev_fit_tolerance(t0, t1, frame, tolerance, &ephemeris) < 0){
+        fprintf(stderr, "%s: could not fit the span within the tolerance\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (output != NULL){
+        if (chebyshev_file_write(output, &ephemeris) < 0){
+            fprintf(stderr, "%s: could not write %s\n", argv[0], output);
+            chebyshev_free(&ephemeris);
+            return EXIT_FAILURE;
+        }
+        chebyshev_free(&ephemeris);
+        return EXIT_SUCCESS;
+    }
+    if (shared != NULL){
+        if (shm_cache_publish(shared, &ephemeris) < 0){
+            fprintf(stderr, "%s: could not publish %s\n", argv[0], shared);
+            chebyshev_free(&ephemeris);
+            return EXIT_FAILURE;
+        }
+        chebyshev_free(&ephemeris);
+        return EXIT_SUCCESS;
+    }
+
+    printf("%.17g %.17g %d %d %d %.17g\n", ephemeris.start, ephemeris.granule, ephemeris.granules, ephemeris.degree,
+           ephemeris.frame, ephemeris.tolerance);
+    for (i = 0; i < ephemeris.granules; i++)
+        for (k = 0; k < 3 * (ephemeris.degree + 1); k++)
+            printf("%.17g%c", ephemeris.coefficients[i * 3 * (ephemeris.degree + 1) + k],
+                   k == 3 * ephemeris.degree + 2 ? '\n' : ' ');
+
+    chebyshev_free(&ephemeris);
+
+    return EXIT_SUCCESS;
+}
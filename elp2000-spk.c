@@ -0,0 +1,56 @@
+/*
+ * elp2000-spk.c
+ *
+ * A tool exporting positions of the Moon computed by the ELP theory as a SPICE SPK kernel (see spk.h). Usage
+ *
+ *                      elp2000-spk [-t type] t0 t1 frame tolerance file
+ *
+ * where type is the type of the segment, 2 (default) or 3, t0 and t1 bound the time span (Julian centuries since
+ * J2000), frame is J2000_CARTESIAN (3) or FK5_CARTESIAN (4) (see elp2000-82b.h) and tolerance is measured in
+ * kilometers. The tool fits Chebyshev polynomials to positions (see chebyshev.h) and writes them into the given file.
+ */
+
+#include "chebyshev.h"
+#include "spk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+    chebyshev_ephemeris ephemeris;      // fitted polynomials
+    double t0, t1, tolerance;           // time span and tolerance
+    int frame;                          // reference frame
+    int type = SPK_CHEBYSHEV_POSITION;  // type of the segment
+
+    if (argc == 8 && strcmp(argv[1], "-t") == 0){
+        type = atoi(argv[2]);
+        argv += 2;
+        argc -= 2;
+    }
+    if (argc != 6){
+        fprintf(stderr, "usage: %s [-t type] t0 t1 frame tolerance file\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    t0 = atof(argv[1]);
+    t1 = atof(argv[2]);
+    frame = atoi(argv[3]);
+    tolerance = atof(argv[4]);
+
+    if (chebyshev_fit_tolerance(t0, t1, frame, tolerance, &ephemeris) < 0){
+        fprintf(stderr, "%s: could not fit the span within the tolerance\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (spk_write(argv[5], &ephemeris, type) < 0){
+        fprintf(stderr, "%s: could not write %s as a segment of type %d\n", argv[0], argv[5], type);
+        chebyshev_free(&ephemeris);
+        return EXIT_FAILURE;
+    }
+
+    chebyshev_free(&ephemeris);
+
+    return EXIT_SUCCESS;
+}
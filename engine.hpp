@@ -0,0 +1,473 @@
+/*
+ * engine.hpp
+ *
+ * This file provides a header only C++ (C++17) engine computing geocentric positions of the Moon according to the ELP
+ * theory with a scalar type given as a template parameter. The same code computes positions with
+ *      float - fast mode of reduced precision, limited mostly by the resolution of t itself held in float;
+ *      double - full precision, same as the routines of elp2000-82b.h up to rounding;
+ *      lanes<T, N> - N time instants at once, each operation being applied to all lanes (SIMD friendly);
+ *      dual<T> - values together with their derivatives (forward mode automatic differentiation), e.g. given
+ *          dual<double>(t, 1.0) the engine computes positions along with their time derivatives.
+ *
+ * The engine reads the series of the theory through the descriptors of theory.h, thus the C library is still the only
+ * owner of the data and its routines remain the reference implementation. On the first use the engine converts
+ * multipliers of each serie into a dense table of coefficients of the arguments it actually depends on. Arguments
+ * are computed in double precision (or the widest type with the same structure), reduced to a single revolution and
+ * only then converted to the scalar type, which keeps float mode usable.
+ *
+ * Output units and reference frames are the same as of the corresponding routines of elp2000-82b.h.
+ */
+
+#ifndef ENGINE_HPP
+#define ENGINE_HPP
+
+#include "elp2000-82b.h"
+#include "frames.h"
+#include "theory.h"
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace elp2000 {
+
+/*
+ * A scalar holding a value and its derivative with respect to a single variable.
+ */
+template <class T>
+struct dual {
+    T value;
+    T derivative;
+
+    constexpr dual(T value = T(0), T derivative = T(0)) : value(value), derivative(derivative) {}
+
+    dual &operator+=(const dual &x) { value += x.value; derivative += x.derivative; return *this; }
+    dual &operator-=(const dual &x) { value -= x.value; derivative -= x.derivative; return *this; }
+    dual &operator*=(const dual &x)
+    {
+        derivative = derivative * x.value + value * x.derivative;
+        value *= x.value;
+        return *this;
+    }
+};
+
+template <class T> dual<T> operator+(dual<T> x, const dual<T> &y) { return x += y; }
+template <class T> dual<T> operator-(dual<T> x, const dual<T> &y) { return x -= y; }
+template <class T> dual<T> operator*(dual<T> x, const dual<T> &y) { return x *= y; }
+template <class T> dual<T> operator-(const dual<T> &x) { return dual<T>(-x.value, -x.derivative); }
+template <class T> dual<T> operator/(const dual<T> &x, const dual<T> &y)
+{
+    return dual<T>(x.value / y.value, (x.derivative * y.value - x.value * y.derivative) / (y.value * y.value));
+}
+
+template <class T> dual<T> sin(const dual<T> &x)
+{
+    using std::sin; using std::cos;
+    return dual<T>(sin(x.value), cos(x.value) * x.derivative);
+}
+
+template <class T> dual<T> cos(const dual<T> &x)
+{
+    using std::sin; using std::cos;
+    return dual<T>(cos(x.value), -sin(x.value) * x.derivative);
+}
+
+template <class T> dual<T> sqrt(const dual<T> &x)
+{
+    using std::sqrt;
+    T root = sqrt(x.value);
+    return dual<T>(root, x.derivative / (root + root));
+}
+
+/*
+ * A scalar holding N independent values, each operation is applied to all of them.
+ */
+template <class T, std::size_t N>
+struct lanes {
+    std::array<T, N> lane;
+
+    constexpr lanes(T value = T(0)) : lane() { for (std::size_t i = 0; i < N; i++) lane[i] = value; }
+
+    T &operator[](std::size_t i) { return lane[i]; }
+    const T &operator[](std::size_t i) const { return lane[i]; }
+
+    lanes &operator+=(const lanes &x) { for (std::size_t i = 0; i < N; i++) lane[i] += x.lane[i]; return *this; }
+    lanes &operator-=(const lanes &x) { for (std::size_t i = 0; i < N; i++) lane[i] -= x.lane[i]; return *this; }
+    lanes &operator*=(const lanes &x) { for (std::size_t i = 0; i < N; i++) lane[i] *= x.lane[i]; return *this; }
+    lanes &operator/=(const lanes &x) { for (std::size_t i = 0; i < N; i++) lane[i] /= x.lane[i]; return *this; }
+};
+
+template <class T, std::size_t N> lanes<T, N> operator+(lanes<T, N> x, const lanes<T, N> &y) { return x += y; }
+template <class T, std::size_t N> lanes<T, N> operator-(lanes<T, N> x, const lanes<T, N> &y) { return x -= y; }
+template <class T, std::size_t N> lanes<T, N> operator*(lanes<T, N> x, const lanes<T, N> &y) { return x *= y; }
+template <class T, std::size_t N> lanes<T, N> operator/(lanes<T, N> x, const lanes<T, N> &y) { return x /= y; }
+template <class T, std::size_t N> lanes<T, N> operator-(const lanes<T, N> &x) { return lanes<T, N>() - x; }
+
+template <class T, std::size_t N> lanes<T, N> sin(lanes<T, N> x)
+{
+    using std::sin;
+    for (std::size_t i = 0; i < N; i++) x.lane[i] = sin(x.lane[i]);
+    return x;
+}
+
+template <class T, std::size_t N> lanes<T, N> cos(lanes<T, N> x)
+{
+    using std::cos;
+    for (std::size_t i = 0; i < N; i++) x.lane[i] = cos(x.lane[i]);
+    return x;
+}
+
+template <class T, std::size_t N> lanes<T, N> sqrt(lanes<T, N> x)
+{
+    using std::sqrt;
+    for (std::size_t i = 0; i < N; i++) x.lane[i] = sqrt(x.lane[i]);
+    return x;
+}
+
+/*
+ * Traits of a scalar type: the type arguments of the theory are computed in and conversions between them.
+ */
+template <class S>
+struct scalar_traits {
+    using wide = S;
+    static S narrow(const wide &x) { return x; }
+    static wide widen(const S &x) { return x; }
+    // reduces an angle measured in arcseconds to a single revolution (1296000")
+    static wide reduce(const wide &x) { return x - wide(1296000.0 * std::floor(double(x) / 1296000.0)); }
+};
+
+template <>
+struct scalar_traits<float> {
+    using wide = double;
+    static float narrow(double x) { return static_cast<float>(x); }
+    static double widen(float x) { return x; }
+    static double reduce(double x) { return x - 1296000.0 * std::floor(x / 1296000.0); }
+};
+
+template <class T>
+struct scalar_traits<dual<T>> {
+    using wide = dual<typename scalar_traits<T>::wide>;
+    static dual<T> narrow(const wide &x)
+    {
+        return dual<T>(scalar_traits<T>::narrow(x.value), scalar_traits<T>::narrow(x.derivative));
+    }
+    static wide widen(const dual<T> &x) { return wide(scalar_traits<T>::widen(x.value), scalar_traits<T>::widen(x.derivative)); }
+    static wide reduce(const wide &x) { return wide(scalar_traits<T>::reduce(x.value), x.derivative); }
+};
+
+template <class T, std::size_t N>
+struct scalar_traits<lanes<T, N>> {
+    using wide = lanes<typename scalar_traits<T>::wide, N>;
+    static lanes<T, N> narrow(const wide &x)
+    {
+        lanes<T, N> y;
+        for (std::size_t i = 0; i < N; i++) y[i] = scalar_traits<T>::narrow(x[i]);
+        return y;
+    }
+    static wide widen(const lanes<T, N> &x)
+    {
+        wide y;
+        for (std::size_t i = 0; i < N; i++) y[i] = scalar_traits<T>::widen(x[i]);
+        return y;
+    }
+    static wide reduce(wide x)
+    {
+        for (std::size_t i = 0; i < N; i++) x[i] = scalar_traits<T>::reduce(x[i]);
+        return x;
+    }
+};
+
+template <class S> struct spherical { S longitude, latitude, distance; };
+template <class S> struct cartesian { S x, y, z; };
+
+namespace detail {
+
+// indices of the arguments of the series in the argument vector of the engine
+enum { DELAUNAY = 0, REDUCED_DELAUNAY = 4, PRECESSION = 8, PLANETARY = 9, TOTAL_ARGUMENTS = 17 };
+
+/*
+ * A serie converted into a dense table: for each term its amplitude, phase and multipliers of the arguments the serie
+ * depends on.
+ */
+struct dense_serie {
+    int coordinate;
+    int power;
+    std::vector<int> arguments;         // indices of the arguments the serie depends on
+    std::vector<double> amplitudes;
+    std::vector<double> phases;
+    std::vector<double> multipliers;    // arguments.size() multipliers per term
+};
+
+/*
+ * Converts all series of the theory into dense tables. Multipliers are found by computing arguments of each term for
+ * unit argument vectors, which keeps the layout of the arrays of multipliers a detail of series.c.
+ */
+inline const std::vector<dense_serie> &dense_series()
+{
+    static const std::vector<dense_serie> series = [] {
+        std::vector<dense_serie> result;
+        serie_arguments unit[TOTAL_ARGUMENTS];
+        double *slots[TOTAL_ARGUMENTS];
+
+        for (int k = 0; k < TOTAL_ARGUMENTS; k++){
+            unit[k] = serie_arguments();
+            slots[k] = k < REDUCED_DELAUNAY ? &unit[k].delaunay[k - DELAUNAY] :
+                       k < PRECESSION ? &unit[k].reduced_delaunay[k - REDUCED_DELAUNAY] :
+                       k == PRECESSION ? &unit[k].precession : &unit[k].planetary[k - PLANETARY];
+            *slots[k] = 1.0;
+        }
+
+        for (int i = 0; i < TOTAL_ELP2000_SERIES; i++){
+            const serie *s = &elp2000_series[i];
+            dense_serie dense;
+            dense.coordinate = s->coordinate;
+            dense.power = s->power;
+
+            for (int k = 0; k < TOTAL_ARGUMENTS; k++)
+                for (int j = 0; j < s->n; j++)
+                    if (compute_serie_term_argument(s, &unit[k], j) != 0.0){
+                        dense.arguments.push_back(k);
+                        break;
+                    }
+
+            for (int j = 0; j < s->n; j++){
+                dense.amplitudes.push_back(serie_term_amplitude(s, j));
+                dense.phases.push_back(serie_term_phase(s, j));
+                for (int k : dense.arguments)
+                    dense.multipliers.push_back(compute_serie_term_argument(s, &unit[k], j));
+            }
+            result.push_back(std::move(dense));
+        }
+
+        return result;
+    }();
+
+    return series;
+}
+
+// evaluates polynomial of n coefficients at t
+template <class W>
+W polynomial(const double coefficients[], int n, const W &t)
+{
+    W value(coefficients[n - 1]);
+    for (int i = n - 2; i >= 0; i--)
+        value = value * t + W(coefficients[i]);
+    return value;
+}
+
+// computes ELP 2000 arguments W₁, W₂, W₃, T and ϖ' with polynomials of n terms
+template <class W>
+void elp2000_arguments(const W &t, int n, W arguments[])
+{
+    for (int i = W1; i <= OBP; i++)
+        arguments[i] = polynomial(&elp2000_arguments_coefficients[i * FULL_SERIES_TOTAL_TERMS], n, t);
+}
+
+// computes Delaunay arguments D, l', l, F with polynomials of n terms
+template <class W>
+void delaunay_arguments(const W &t, int n, W arguments[])
+{
+    W elp[TOTAL_ELP2000_ARGUMENTS];
+
+    elp2000_arguments(t, n, elp);
+    arguments[D] = elp[W1] - elp[T] + W(648000.0);
+    arguments[LP] = elp[T] - elp[OBP];
+    arguments[L] = elp[W1] - elp[W2];
+    arguments[F] = elp[W1] - elp[W3];
+}
+
+// computes all arguments of the series in the order of the argument vector of the engine, measured in arcseconds
+template <class W>
+void serie_argument_vector(const W &t, W arguments[])
+{
+    W elp[TOTAL_ELP2000_ARGUMENTS];
+
+    delaunay_arguments(t, FULL_SERIES_TOTAL_TERMS, &arguments[DELAUNAY]);
+    delaunay_arguments(t, LINEAR_SERIES_TOTAL_TERMS, &arguments[REDUCED_DELAUNAY]);
+    elp2000_arguments(t, LINEAR_SERIES_TOTAL_TERMS, elp);
+    arguments[PRECESSION] = elp[W1] + W(precession_constant) * t;
+    for (int i = 0; i < TOTAL_PLANETARY_ARGUMENTS; i++)
+        arguments[PLANETARY + i] = polynomial(&planetary_arguments_coefficients[i * LINEAR_SERIES_TOTAL_TERMS],
+                                              LINEAR_SERIES_TOTAL_TERMS, t);
+}
+
+// refers spherical coordinates of the ELP 2000 reference frame to the mean ecliptic and equinox of date
+template <class S>
+spherical<S> refer_to_date(const S &t, spherical<S> sp)
+{
+    sp.longitude += polynomial(precession_coefficients, PRECESSION_TOTAL_TERMS, t);
+    return sp;
+}
+
+// converts spherical coordinates into rectangular ones
+template <class S>
+cartesian<S> convert_to_cartesian(const spherical<S> &sp)
+{
+    using std::sin; using std::cos;
+    const S scale(M_PI / 648000.0);
+
+    return {sp.distance * cos(sp.longitude * scale) * cos(sp.latitude * scale),
+            sp.distance * sin(sp.longitude * scale) * cos(sp.latitude * scale),
+            sp.distance * sin(sp.latitude * scale)};
+}
+
+// refers rectangular coordinates of the ELP 2000 reference frame to the mean ecliptic and equinox of J2000
+template <class S>
+cartesian<S> refer_to_J2000(const S &t, const cartesian<S> &rp)
+{
+    using std::sqrt;
+    const S one(1.0), two(2.0);
+    const S p = polynomial(laskar_p_coefficients, LASKAR_TOTAL_TERMS, t);
+    const S q = polynomial(laskar_q_coefficients, LASKAR_TOTAL_TERMS, t);
+    const S r = sqrt(one - p * p - q * q);
+
+    return {(one - two * p * p) * rp.x + two * p * q * rp.y + two * p * r * rp.z,
+            two * p * q * rp.x + (one - two * q * q) * rp.y - two * q * r * rp.z,
+            -two * p * r * rp.x + two * q * r * rp.y + (one - two * p * p - two * q * q) * rp.z};
+}
+
+// refers rectangular coordinates of the mean ecliptic and equinox of J2000 to the FK5 equator
+template <class S>
+cartesian<S> refer_to_FK5(const cartesian<S> &rp)
+{
+    return {S(fk5_rotation[0][0]) * rp.x + S(fk5_rotation[0][1]) * rp.y + S(fk5_rotation[0][2]) * rp.z,
+            S(fk5_rotation[1][0]) * rp.x + S(fk5_rotation[1][1]) * rp.y + S(fk5_rotation[1][2]) * rp.z,
+            S(fk5_rotation[2][0]) * rp.x + S(fk5_rotation[2][1]) * rp.y + S(fk5_rotation[2][2]) * rp.z};
+}
+
+// refers spherical coordinates of the ELP 2000 reference frame to the given frame (one of ELP_frames)
+template <class S>
+std::array<S, 3> refer_to_frame(const S &t, const spherical<S> &sp, int frame)
+{
+    spherical<S> date;
+    cartesian<S> rp;
+
+    switch (frame){
+        case ELP2000_SPHERICAL:
+            return {sp.longitude, sp.latitude, sp.distance};
+        case OF_DATE_SPHERICAL:
+            date = refer_to_date(t, sp);
+            return {date.longitude, date.latitude, date.distance};
+        case ELP2000_CARTESIAN:
+            rp = convert_to_cartesian(sp);
+            break;
+        case J2000_CARTESIAN:
+            rp = refer_to_J2000(t, convert_to_cartesian(sp));
+            break;
+        default:
+            rp = refer_to_FK5(refer_to_J2000(t, convert_to_cartesian(sp)));
+            break;
+    }
+
+    return {rp.x, rp.y, rp.z};
+}
+
+} // namespace detail
+
+/*
+ * Computes geocentric position of the Moon in spherical coordinates referred to the ELP 2000 reference frame (see
+ * geocentric_moon_position). For scalar types narrower than double the longitude is reduced to a single revolution.
+ */
+template <class S>
+spherical<S> moon_position(const S &t)
+{
+    using traits = scalar_traits<S>;
+    using W = typename traits::wide;
+    using namespace detail;
+
+    const W tw = traits::widen(t);
+    W wide[TOTAL_ARGUMENTS];
+    W elp[TOTAL_ELP2000_ARGUMENTS];
+    S arguments[TOTAL_ARGUMENTS];
+    S coordinates[TOTAL_SPHERICAL_COORDINATES] = {S(0.0), S(0.0), S(0.0)};
+    const S scale(M_PI / 648000.0);
+
+    // computing arguments in wide precision and reducing them to a single revolution
+    serie_argument_vector(tw, wide);
+    for (int k = 0; k < TOTAL_ARGUMENTS; k++)
+        arguments[k] = traits::narrow(traits::reduce(wide[k]));
+
+    // computing all series, each multiplied by its power of t
+    for (const dense_serie &s : dense_series()){
+        const std::size_t m = s.arguments.size();
+        const double *multipliers = s.multipliers.data();
+        S value(0.0);
+
+        for (std::size_t j = 0; j < s.amplitudes.size(); j++, multipliers += m){
+            S arg(s.phases[j]);
+            for (std::size_t k = 0; k < m; k++)
+                arg += S(multipliers[k]) * arguments[s.arguments[k]];
+            using std::sin;
+            value += S(s.amplitudes[j]) * sin(arg * scale);
+        }
+
+        for (int j = 0; j < s.power; j++)
+            value *= t;
+        coordinates[s.coordinate] += value;
+    }
+
+    // adding mean mean longitude of the Moon (W₁) in wide precision; narrower types cannot hold the longitude of
+    // many revolutions, thus it is reduced to a single one for them
+    elp2000_arguments(tw, FULL_SERIES_TOTAL_TERMS, elp);
+    W longitude = traits::widen(coordinates[LONGITUDE]) + elp[W1];
+    if constexpr (!std::is_same_v<W, S>)
+        longitude = traits::reduce(longitude);
+
+    return {traits::narrow(longitude), coordinates[LATITUDE], coordinates[DISTANCE]};
+}
+
+/*
+ * Computes geocentric position of the Moon in spherical coordinates referred to the internal mean ecliptic and equinox
+ * of date (see geocentric_moon_position_of_date).
+ */
+template <class S>
+spherical<S> moon_position_of_date(const S &t)
+{
+    return detail::refer_to_date(t, moon_position(t));
+}
+
+/*
+ * Computes geocentric position of the Moon in rectangular coordinates referred to the ELP 2000 reference frame (see
+ * geocentric_moon_position_cartesian).
+ */
+template <class S>
+cartesian<S> moon_position_cartesian(const S &t)
+{
+    return detail::convert_to_cartesian(moon_position(t));
+}
+
+/*
+ * Computes geocentric position of the Moon in rectangular coordinates referred to the mean ecliptic and equinox of
+ * J2000 (see geocentric_moon_position_cartesian_of_J2000).
+ */
+template <class S>
+cartesian<S> moon_position_cartesian_of_J2000(const S &t)
+{
+    return detail::refer_to_J2000(t, moon_position_cartesian(t));
+}
+
+/*
+ * Computes geocentric position of the Moon in rectangular coordinates referred to the FK5 equator (see
+ * geocentric_moon_position_cartesian_of_FK5).
+ */
+template <class S>
+cartesian<S> moon_position_cartesian_of_FK5(const S &t)
+{
+    return detail::refer_to_FK5(moon_position_cartesian_of_J2000(t));
+}
+
+/*
+ * Computes geocentric position of the Moon in the given coordinates and reference frame (one of ELP_frames, see
+ * geocentric_moon_position_in_frame).
+ */
+template <class S>
+std::array<S, 3> moon_position_in_frame(const S &t, int frame)
+{
+    return detail::refer_to_frame(t, moon_position(t), frame);
+}
+
+} // namespace elp2000
+
+#endif // ENGINE_HPP
@@ -0,0 +1,35 @@
+/*
+ * frames.c
+ */
+
+#include "frames.h"
+
+/*
+ * Coefficients of the accumulated precession between J2000 and the date.
+ *
+ * Source: Lunar Solution ELP 2000-82B. Explanatory note, p. 12.
+ */
+const double precession_coefficients[PRECESSION_TOTAL_TERMS] = {0.0, 5029.0966, 1.1120, 0.000077, -0.00002353};
+
+/*
+ * Coefficients of Laskar's polynomials p and q.
+ *
+ * Source: Lunar Solution ELP 2000-82B. Explanatory note, p. 12.
+ */
+const double laskar_p_coefficients[LASKAR_TOTAL_TERMS] = {
+    0.0, 0.10180391e-4, 0.47020439e-6, -0.5417367e-9, -0.2507948e-11, 0.463486e-14
+};
+const double laskar_q_coefficients[LASKAR_TOTAL_TERMS] = {
+    0.0, -0.113469002e-3, 0.12372674e-6, 0.12654170e-8, -0.1371808e-11, -0.320334e-14
+};
+
+/*
+ * Rotation from the mean dynamical ecliptic and equinox of J2000 to the FK5 equator.
+ *
+ * Source: Lunar Solution ELP 2000-82B. Explanatory note, p. 12.
+ */
+const double fk5_rotation[3][3] = {
+    { 1.000000000000,  0.000000437913, -0.000000189859},
+    {-0.000000477299,  0.917482137607, -0.397776981791},
+    { 0.000000000000,  0.397776981701,  0.917482137607}
+};
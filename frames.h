@@ -0,0 +1,45 @@
+/*
+ * frames.h
+ *
+ * This file holds the constants of the transformations of positions of the Moon from the ELP 2000 reference frame to
+ * other frames: the accumulated precession between J2000 and the date, Laskar's polynomials p and q of the rotation to
+ * the mean dynamical ecliptic and equinox of J2000 and the rotation from the ecliptic of J2000 to the FK5 equator.
+ * They are shared by the transformations of positions (see geocentric_moon_position_in_frame), of Taylor polynomials
+ * (see taylor.h) and of the C++ engine (see engine.hpp), so that all of them refer positions the same way.
+ *
+ * Polynomials are given as coefficients of increasing powers of t, measured in Julian centuries since J2000.
+ */
+
+#ifndef FRAMES_H
+#define FRAMES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PRECESSION_TOTAL_TERMS 5        // amount of coefficients of the polynomial of the accumulated precession
+#define LASKAR_TOTAL_TERMS 6            // amount of coefficients of Laskar's polynomials p and q
+
+/*
+ * Coefficients of the polynomial of the accumulated precession between J2000 and the date, measured in arcseconds.
+ */
+extern const double precession_coefficients[PRECESSION_TOTAL_TERMS];
+
+/*
+ * Coefficients of Laskar's polynomials p and q of the rotation of the ELP 2000 reference frame into the mean dynamical
+ * ecliptic and equinox of J2000.
+ */
+extern const double laskar_p_coefficients[LASKAR_TOTAL_TERMS];
+extern const double laskar_q_coefficients[LASKAR_TOTAL_TERMS];
+
+/*
+ * Rotation of rectangular coordinates referred to the mean dynamical ecliptic and equinox of J2000 to the FK5 equator
+ * (mean equator and rotational mean equinox of J2000), row by row.
+ */
+extern const double fk5_rotation[3][3];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FRAMES_H
@@ -0,0 +1,373 @@
+/*
+ * gemm.c
+ */
+
+#include "gemm.h"
+#include "autotune.h"
+#include "elp2000-82b.h"
+#include "theory.h"
+#include "threadpool.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#define TOTAL_ARGUMENT_COLUMNS 13       // amount of arguments of the theory terms are combined of
+#define DELAUNAY_COLUMN 8               // column of the first Delaunay argument, planetary arguments preceding it
+#define PRECESSION_COLUMN 12            // column of the precession argument
+#define ROUNDING_CONSTANT 6755399441055744.0    // 1.5·2⁵², adding and subtracting it rounds to the nearest integer
+#define TOTAL_SINE_COEFFICIENTS 11      // amount of coefficients of the polynomial of the sine
+
+/*
+ * A datatype describing a serie packed for matrix products.
+ */
+typedef struct {
+    int n;                      // amount of terms
+    int k;                      // amount of arguments used by the serie
+    int columns[TOTAL_ARGUMENT_COLUMNS];    // columns of the arguments used by the serie
+    int full;                   // non zero if the serie uses full Delaunay arguments rather than reduced ones
+    double *multipliers;        // multipliers as panels of k × GEMM_TILE_TERMS values, padded with zeros
+    double *phases;             // phases of the terms, arcseconds, padded with zeros to whole panels
+    double *amplitudes;         // amplitudes of the terms in decreasing absolute values, padded with zeros
+} packed_serie;
+
+/*
+ * A datatype describing a term of a serie while ordering terms by amplitudes.
+ */
+typedef struct {
+    double amplitude;           // absolute value of the amplitude
+    int term;                   // index of the term within the serie
+} ranked_term;
+
+/*
+ * A datatype holding the context of a batch evaluation.
+ */
+typedef struct {
+    const double *t;            // time instants
+    int n;                      // amount of time instants
+    int frame;                  // reference frame of the output
+    double threshold;           // amplitude threshold of the terms to be computed
+    int block_terms;            // amount of terms of a block of panels
+    int chunk_epochs;           // amount of epochs of a chunk
+    double *positions;          // output positions, three values per time instant
+} gemm_batch;
+
+/*
+ * Coefficients of the Taylor polynomial of sin(x)/x in x², whose truncation error is below 10⁻¹⁷ over [0, π/2].
+ */
+static const double sine_coefficients[TOTAL_SINE_COEFFICIENTS] = {
+    1.0, -1.0 / 6.0, 1.0 / 120.0, -1.0 / 5040.0, 1.0 / 362880.0, -1.0 / 39916800.0, 1.0 / 6227020800.0,
+    -1.0 / 1307674368000.0, 1.0 / 355687428096000.0, -1.0 / 121645100408832000.0, 1.0 / 51090942171709440000.0
+};
+
+static packed_serie packed_series[TOTAL_ELP2000_SERIES];    // packed series of the theory
+static int packing_failed;                                  // non zero if packed series could not be allocated
+static pthread_once_t packing_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Compares ranked terms by decreasing amplitudes.
+ */
+static int compare_ranked_terms(const void *a, const void *b)
+{
+    double aa = ((const ranked_term *)a)->amplitude;   // amplitude of the first term
+    double ab = ((const ranked_term *)b)->amplitude;   // amplitude of the second term
+
+    return aa > ab ? -1 : aa < ab ? 1 : 0;
+}
+
+/*
+ * Sets the argument in the given column of the argument matrix to the given value, the Delaunay arguments being set
+ * both full and reduced.
+ */
+static void set_argument_column(serie_arguments *arguments, int column, double value)
+{
+    if (column < DELAUNAY_COLUMN)
+        arguments->planetary[column] = value;
+    else if (column < PRECESSION_COLUMN)
+        arguments->delaunay[column - DELAUNAY_COLUMN] = arguments->reduced_delaunay[column - DELAUNAY_COLUMN] = value;
+    else
+        arguments->precession = value;
+}
+
+/*
+ * Packs the given serie. Multipliers are found by computing arguments of the terms for unit arguments of the theory,
+ * thus they match the arguments the series compute. Returns zero on success or a negative value if memory could not
+ * be allocated.
+ */
+static int pack_serie(const serie *s, packed_serie *p)
+{
+    serie_arguments unit;       // arguments of the theory, all but one being zero
+    ranked_term *order;         // terms ordered by decreasing amplitudes
+    double *multipliers;        // multipliers of all arguments of each term
+    int used[TOTAL_ARGUMENT_COLUMNS];   // non zero for arguments used by the serie
+    int panels;                 // amount of panels
+    int i, j, q;                // loop index variables
+
+    p->n = s->n;
+    p->full = s->type == SERIE_A_SIN || s->type == SERIE_A_COS;
+    panels = (s->n + GEMM_TILE_TERMS - 1) / GEMM_TILE_TERMS;
+
+    order = malloc(sizeof(ranked_term) * (s->n > 0 ? s->n : 1));
+    multipliers = malloc(sizeof(double) * TOTAL_ARGUMENT_COLUMNS * (s->n > 0 ? s->n : 1));
+    p->multipliers = calloc((size_t)panels * TOTAL_ARGUMENT_COLUMNS * GEMM_TILE_TERMS + 1, sizeof(double));
+    p->phases = calloc((size_t)panels * GEMM_TILE_TERMS + 1, sizeof(double));
+    p->amplitudes = calloc((size_t)panels * GEMM_TILE_TERMS + 1, sizeof(double));
+    if (order == NULL || multipliers == NULL || p->multipliers == NULL || p->phases == NULL || p->amplitudes == NULL){
+        free(order);
+        free(multipliers);
+        return -1;
+    }
+
+    // finding multipliers of each argument and the arguments used by the serie
+    for (q = 0; q < TOTAL_ARGUMENT_COLUMNS; q++)
+        set_argument_column(&unit, q, 0.0);
+    for (q = 0; q < TOTAL_ARGUMENT_COLUMNS; q++){
+        set_argument_column(&unit, q, 1.0);
+        for (i = 0, used[q] = 0; i < s->n; i++){
+            multipliers[i * TOTAL_ARGUMENT_COLUMNS + q] = compute_serie_term_argument(s, &unit, i);
+            used[q] |= multipliers[i * TOTAL_ARGUMENT_COLUMNS + q] != 0.0;
+        }
+        set_argument_column(&unit, q, 0.0);
+    }
+    for (q = 0, p->k = 0; q < TOTAL_ARGUMENT_COLUMNS; q++)
+        if (used[q])
+            p->columns[p->k++] = q;
+
+    for (i = 0; i < s->n; i++){
+        order[i].amplitude = fabs(serie_term_amplitude(s, i));
+        order[i].term = i;
+    }
+    qsort(order, s->n, sizeof(ranked_term), compare_ranked_terms);
+
+    // storing terms in panels: multipliers of an argument for all terms of a panel are adjacent
+    for (i = 0; i < s->n; i++){
+        for (j = 0; j < p->k; j++)
+            p->multipliers[((i / GEMM_TILE_TERMS) * p->k + j) * GEMM_TILE_TERMS + i % GEMM_TILE_TERMS] =
+                multipliers[order[i].term * TOTAL_ARGUMENT_COLUMNS + p->columns[j]];
+        p->phases[i] = serie_term_phase(s, order[i].term);
+        p->amplitudes[i] = serie_term_amplitude(s, order[i].term);
+    }
+
+    free(order);
+    free(multipliers);
+
+    return 0;
+}
+
+/*
+ * Packs all series of the theory.
+ */
+static void pack_series(void)
+{
+    int i;                      // loop index variable
+
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++)
+        if (pack_serie(&elp2000_series[i], &packed_series[i]) != 0)
+            packing_failed = 1;
+}
+
+/*
+ * Returns the amount of terms of a packed serie with absolute values of amplitudes not less than the threshold.
+ */
+static int count_terms(const packed_serie *p, double threshold)
+{
+    int low, high, middle;      // bounds of the range searched and its middle
+
+    for (low = 0, high = p->n; low < high;){
+        middle = (low + high) / 2;
+        if (fabs(p->amplitudes[middle]) >= threshold)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+/*
+ * Micro-kernel computing a tile of arguments of GEMM_TILE_TERMS terms at GEMM_TILE_EPOCHS epochs given a panel of
+ * multipliers, phases of the terms of the panel and the packed arguments of the epochs (k × GEMM_TILE_EPOCHS values).
+ */
+static void compute_tile(const double multipliers[], const double phases[], const double arguments[], int k,
+                         double tile[])
+{
+    int q, r, e;                // loop index variables
+
+    for (r = 0; r < GEMM_TILE_TERMS; r++)
+        for (e = 0; e < GEMM_TILE_EPOCHS; e++)
+            tile[r * GEMM_TILE_EPOCHS + e] = phases[r];
+
+    for (q = 0; q < k; q++)
+        for (r = 0; r < GEMM_TILE_TERMS; r++)
+            for (e = 0; e < GEMM_TILE_EPOCHS; e++)
+                tile[r * GEMM_TILE_EPOCHS + e] += multipliers[q * GEMM_TILE_TERMS + r] *
+                                                  arguments[q * GEMM_TILE_EPOCHS + e];
+}
+
+/*
+ * Replaces arguments of a tile, measured in arcseconds, with their sines. Arguments are reduced modulo 1296000" to
+ * [-π, π], folded to [-π/2, π/2] by sin(x) = sin(π - x) and the sine is computed by its polynomial, without branches.
+ */
+static void compute_tile_sines(double tile[])
+{
+    double x[GEMM_TILE_TERMS * GEMM_TILE_EPOCHS];       // reduced arguments, radians
+    double y[GEMM_TILE_TERMS * GEMM_TILE_EPOCHS];       // folded absolute values of the arguments
+    double value[GEMM_TILE_TERMS * GEMM_TILE_EPOCHS];   // values of the polynomial
+    int i, j;                                           // loop index variables
+
+    // the amount of whole revolutions is exact and so is its product with a revolution
+    for (i = 0; i < GEMM_TILE_TERMS * GEMM_TILE_EPOCHS; i++){
+        x[i] = tile[i] - ((tile[i] * (1.0 / 1296000.0) + ROUNDING_CONSTANT) - ROUNDING_CONSTANT) * 1296000.0;
+        x[i] *= M_PI / 648000.0;
+        y[i] = fabs(x[i]);
+        y[i] = y[i] < M_PI - y[i] ? y[i] : M_PI - y[i];
+        value[i] = sine_coefficients[TOTAL_SINE_COEFFICIENTS - 1];
+    }
+
+    // Horner's scheme runs over the whole tile at each step, so that each step is a vector operation
+    for (j = TOTAL_SINE_COEFFICIENTS - 2; j >= 0; j--)
+        for (i = 0; i < GEMM_TILE_TERMS * GEMM_TILE_EPOCHS; i++)
+            value[i] = value[i] * (y[i] * y[i]) + sine_coefficients[j];
+
+    for (i = 0; i < GEMM_TILE_TERMS * GEMM_TILE_EPOCHS; i++)
+        tile[i] = copysign(value[i] * y[i], x[i]);
+}
+
+/*
+ * Adds the first rows of a tile of sines multiplied by the amplitudes of the terms to the sums of the epochs.
+ */
+static void accumulate_tile(const double amplitudes[], const double tile[], int rows, double sums[])
+{
+    int r, e;                   // loop index variables
+
+    for (r = 0; r < rows && r < GEMM_TILE_TERMS; r++)
+        for (e = 0; e < GEMM_TILE_EPOCHS; e++)
+            sums[e] += amplitudes[r] * tile[r * GEMM_TILE_EPOCHS + e];
+}
+
+/*
+ * Computes a chunk of a batch: positions of the Moon at up to chunk_epochs consecutive time instants.
+ */
+static void compute_gemm_chunk(void *context, int index)
+{
+    gemm_batch *batch = context;
+    serie_arguments arguments;                                          // arguments of the series at an epoch
+    double matrix[2][TOTAL_ARGUMENT_COLUMNS][GEMM_MAX_CHUNK_EPOCHS];    // arguments with reduced and full Delaunay
+    double packed[GEMM_MAX_CHUNK_EPOCHS / GEMM_TILE_EPOCHS][TOTAL_ARGUMENT_COLUMNS * GEMM_TILE_EPOCHS];  // tiles of X
+    double tile[GEMM_TILE_TERMS * GEMM_TILE_EPOCHS];                    // tile of arguments and their sines
+    double sums[GEMM_MAX_CHUNK_EPOCHS];                                 // values of a serie at each epoch
+    double coordinates[GEMM_MAX_CHUNK_EPOCHS][TOTAL_SPHERICAL_COORDINATES]; // longitude, latitude and distance
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];                  // ELP2000 arguments
+    const packed_serie *p;                                              // current packed serie
+    const double *t;                                                    // time instants of the chunk
+    int chunk, block;                                                   // sizes of chunks and blocks
+    int m, tiles;                                                       // amounts of epochs and tiles of epochs
+    int count;                                                          // amount of terms computed
+    int first, last;                                                    // range of terms of a block
+    int i, j, k, q;                                                     // loop index variables
+
+    chunk = batch->chunk_epochs;
+    block = batch->block_terms;
+    t = batch->t + index * chunk;
+    m = batch->n - index * chunk < chunk ? batch->n - index * chunk : chunk;
+    tiles = (m + GEMM_TILE_EPOCHS - 1) / GEMM_TILE_EPOCHS;
+
+    // arguments of the epochs are columns of the argument matrix, padded with zeros to whole tiles
+    for (k = 0; k < tiles * GEMM_TILE_EPOCHS; k++){
+        if (k < m)
+            compute_serie_arguments(t[k], &arguments);
+        for (q = 0; q < TOTAL_ARGUMENT_COLUMNS; q++){
+            matrix[0][q][k] = matrix[1][q][k] = 0.0;
+            if (k >= m)
+                continue;
+            if (q < DELAUNAY_COLUMN){
+                matrix[0][q][k] = matrix[1][q][k] = arguments.planetary[q];
+            } else if (q < PRECESSION_COLUMN){
+                matrix[0][q][k] = arguments.reduced_delaunay[q - DELAUNAY_COLUMN];
+                matrix[1][q][k] = arguments.delaunay[q - DELAUNAY_COLUMN];
+            } else {
+                matrix[0][q][k] = matrix[1][q][k] = arguments.precession;
+            }
+        }
+        if (k < m)
+            coordinates[k][LONGITUDE] = coordinates[k][LATITUDE] = coordinates[k][DISTANCE] = 0.0;
+    }
+
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        p = &packed_series[i];
+        count = count_terms(p, batch->threshold);
+
+        // packing arguments used by the serie into tiles of epochs
+        for (j = 0; j < tiles; j++)
+            for (q = 0; q < p->k; q++)
+                for (k = 0; k < GEMM_TILE_EPOCHS; k++)
+                    packed[j][q * GEMM_TILE_EPOCHS + k] = matrix[p->full][p->columns[q]][j * GEMM_TILE_EPOCHS + k];
+
+        for (k = 0; k < tiles * GEMM_TILE_EPOCHS; k++)
+            sums[k] = 0.0;
+
+        // each block of panels is computed for all tiles of epochs while it stays in cache
+        for (first = 0; first < count; first += block){
+            last = first + block < count ? first + block : count;
+            for (j = 0; j < tiles; j++)
+                for (q = first; q < last; q += GEMM_TILE_TERMS){
+                    compute_tile(&p->multipliers[q * p->k], &p->phases[q], packed[j], p->k, tile);
+                    compute_tile_sines(tile);
+                    accumulate_tile(&p->amplitudes[q], tile, last - q, &sums[j * GEMM_TILE_EPOCHS]);
+                }
+        }
+
+        for (k = 0; k < m; k++){
+            for (j = 0; j < elp2000_series[i].power; j++)
+                sums[k] *= t[k];
+            coordinates[k][elp2000_series[i].coordinate] += sums[k];
+        }
+    }
+
+    // adding mean mean longitude of the Moon (W₁) and referring positions to the requested frame
+    for (k = 0; k < m; k++){
+        compute_elp2000_arguments(t[k], FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+        coordinates[k][LONGITUDE] += elp2000_arguments[W1];
+        refer_position_to_frame(t[k], coordinates[k], batch->frame,
+                                &batch->positions[(index * chunk + k) * 3]);
+    }
+}
+
+int geocentric_moon_positions_gemm(const double t[], int n, int frame, double threshold, double positions[])
+{
+    return geocentric_moon_positions_gemm_blocked(t, n, frame, threshold, 0, 0, positions);
+}
+
+int geocentric_moon_positions_gemm_blocked(const double t[], int n, int frame, double threshold, int block_terms,
+                                           int chunk_epochs, double positions[])
+{
+    const elp_tuning *tuning;   // tuned parameters of the host
+    gemm_batch batch;           // context of the batch
+
+    if (n < 0 || frame < 0 || frame >= TOTAL_ELP_FRAMES || !(threshold >= 0.0))
+        return -1;
+
+    if (block_terms == 0 || chunk_epochs == 0){
+        tuning = elp_tuning_current();
+        block_terms = block_terms == 0 ? tuning->block_terms : block_terms;
+        chunk_epochs = chunk_epochs == 0 ? tuning->chunk_epochs : chunk_epochs;
+    }
+    if (block_terms <= 0 || block_terms % GEMM_TILE_TERMS != 0 || chunk_epochs <= 0 ||
+        chunk_epochs % GEMM_TILE_EPOCHS != 0 || chunk_epochs > GEMM_MAX_CHUNK_EPOCHS)
+        return -1;
+
+    pthread_once(&packing_once, pack_series);
+    if (packing_failed)
+        return -1;
+
+    batch.t = t;
+    batch.n = n;
+    batch.frame = frame;
+    batch.threshold = threshold;
+    batch.block_terms = block_terms;
+    batch.chunk_epochs = chunk_epochs;
+    batch.positions = positions;
+    thread_pool_run(compute_gemm_chunk, &batch, (n + chunk_epochs - 1) / chunk_epochs);
+
+    return 0;
+}
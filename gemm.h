@@ -0,0 +1,63 @@
+/*
+ * gemm.h
+ *
+ * This file contains a routine to compute positions of the Moon at many time instants at once, where the arguments of
+ * the terms of each serie are found as a matrix product rather than term by term.
+ *
+ * Argument of each term of any serie is a linear combination of at most 13 arguments of the theory: 8 planetary
+ * arguments, 4 Delaunay arguments and the precession argument. For a batch of epochs the arguments of all terms of a
+ * serie form the matrix product
+ *
+ *                                  Φ = M × X + φ,
+ *
+ * where M (terms × k) holds the multipliers of the k arguments used by the serie, X (k × epochs) holds these arguments
+ * at each epoch and φ holds the phases. The sums of the serie are the product of the amplitudes and the matrix of
+ * sines, A × sin(Φ). Multipliers are packed once into panels of GEMM_TILE_TERMS terms stored as doubles, with terms
+ * ordered by decreasing absolute values of amplitudes so that a truncated serie is a prefix of the panels. Multipliers
+ * are found from the arguments of the terms exactly as the series compute them.
+ *
+ * Within a chunk of epochs the panels are visited in blocks of terms, each block staying in cache while the tiles of
+ * all epochs are computed; sizes of chunks and blocks default to GEMM_CHUNK_EPOCHS and GEMM_BLOCK_TERMS and may be
+ * tuned for the host (see autotune.h). A micro-kernel computes a tile of GEMM_TILE_TERMS × GEMM_TILE_EPOCHS arguments
+ * held in registers, a branch free polynomial sine is applied to the tile after reducing arguments modulo 1296000" and
+ * the tile is reduced with the amplitudes into the sums of the epochs. No external BLAS is used. Sums agree with the
+ * ones of geocentric_moon_positions up to the rounding errors.
+ */
+
+#ifndef GEMM_H
+#define GEMM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GEMM_TILE_TERMS 4               // amount of terms of a tile computed by the micro-kernel
+#define GEMM_TILE_EPOCHS 8              // amount of epochs of a tile computed by the micro-kernel
+#define GEMM_BLOCK_TERMS 256            // default amount of terms of a block of panels kept in cache
+#define GEMM_CHUNK_EPOCHS 64            // default amount of epochs computed by a single task
+#define GEMM_MAX_CHUNK_EPOCHS 256       // maximum amount of epochs computed by a single task
+
+/*
+ * Computes geocentric positions of the Moon at n time instants (Julian centuries since J2000) in the given coordinates
+ * and reference frame (one of ELP_frames), writing three values per time instant into the given array. Terms with
+ * absolute values of amplitudes less than the given threshold are skipped (see geocentric_moon_positions_truncated),
+ * zero threshold computes the full theory. The error is estimated by geocentric_moon_truncation_error.
+ * Returns zero on success or a negative value if the arguments are invalid or memory could not be allocated.
+ */
+int geocentric_moon_positions_gemm(const double t[], int n, int frame, double threshold, double positions[]);
+
+/*
+ * Computes positions the same way as geocentric_moon_positions_gemm with the given amount of terms of a block of
+ * panels, a multiple of GEMM_TILE_TERMS, and amount of epochs of a chunk, a multiple of GEMM_TILE_EPOCHS not greater
+ * than GEMM_MAX_CHUNK_EPOCHS. Zero selects the values tuned for the host (see elp_tuning_current), which
+ * geocentric_moon_positions_gemm always uses.
+ * Returns zero on success or a negative value if the arguments are invalid or memory could not be allocated.
+ */
+int geocentric_moon_positions_gemm_blocked(const double t[], int n, int frame, double threshold, int block_terms,
+                                           int chunk_epochs, double positions[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GEMM_H
@@ -0,0 +1,370 @@
+/*
+ * kernels.hpp
+ *
+ * This file provides compile time specialized kernels (C++20) computing series of the ELP theory in double precision.
+ * A kernel is a template parameterized by the index of a serie in the table of the theory (see theory.h) and by an
+ * amplitude cutoff: terms with absolute values of amplitudes less than the cutoff are dropped exactly as by
+ * geocentric_moon_positions_truncated. The data arrays are constexpr in C++ (see series.h), thus the selection of the
+ * surviving terms happens at compile time. Surviving terms with equal arguments are merged into a single term
+ *
+ *                                          s·sin(x) + c·cos(x)
+ *
+ * and each term is expanded into straight-line code multiplying only the arguments with nonzero multipliers.
+ * Instantiations for fixed accuracies are meant for hot paths, e.g.
+ *
+ *      using fast = elp2000::kernel<0.01>;
+ *      std::array<double, 3> position = fast::position_in_frame(t, FK5_CARTESIAN);
+ *
+ * Size of the generated code and time of compilation grow with the amount of surviving terms: a cutoff of 0.1 keeps
+ * about 400 terms, a cutoff of 0.001 keeps about 3500 terms and takes tens of seconds to compile. Lower cutoffs are
+ * better served by the batch routines of elp2000-82b.h. Results match the ones of geocentric_moon_positions_truncated
+ * up to rounding errors, since merged terms are summed in a different order, and so do their error estimates: sums of
+ * amplitudes of the dropped terms are found at compile time, thus an estimate costs a few multiplications.
+ */
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include "engine.hpp"
+#include "theorydata.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace elp2000 {
+
+namespace detail {
+
+// descriptors of all series of the theory available at compile time
+static constexpr serie kernel_series[TOTAL_ELP2000_SERIES] = ELP2000_SERIES_DATA;
+
+// bound of the distance of the Moon, kilometers
+static constexpr double maximum_distance = 410000.0;
+
+/*
+ * Returns the multiplier of the argument with index k of the argument vector of the engine for the term with index i of
+ * the given serie. The layout of the arrays of multipliers mirrors the argument routines of series.c.
+ */
+constexpr int term_multiplier(const serie &s, int i, int k)
+{
+    const int *m;
+
+    switch (s.type){
+        case SERIE_A_SIN:
+        case SERIE_A_COS:
+            m = &s.multipliers[i * 4];
+            return k >= DELAUNAY && k < REDUCED_DELAUNAY ? m[k - DELAUNAY] : 0;
+        case SERIE_B:
+            m = &s.multipliers[i * 5];
+            return k == PRECESSION ? m[0] :
+                   k >= REDUCED_DELAUNAY && k < PRECESSION ? m[k - REDUCED_DELAUNAY + 1] : 0;
+        case SERIE_C:
+            m = &s.multipliers[i * 11];
+            return k >= PLANETARY ? m[k - PLANETARY] :
+                   k >= REDUCED_DELAUNAY && k < PRECESSION && k - REDUCED_DELAUNAY != LP ? m[TOTAL_PLANETARY_ARGUMENTS + 1] :
+                   0;
+        case SERIE_D:
+            m = &s.multipliers[i * 11];
+            return k >= PLANETARY && k - PLANETARY < TOTAL_PLANETARY_ARGUMENTS - 1 ? m[k - PLANETARY] :
+                   k >= REDUCED_DELAUNAY && k < PRECESSION ? m[TOTAL_PLANETARY_ARGUMENTS + k - REDUCED_DELAUNAY] : 0;
+        default:
+            return 0;
+    }
+}
+
+// returns the amplitude of the term with index i of the given serie (see serie_term_amplitude)
+constexpr double term_amplitude(const serie &s, int i)
+{
+    return s.type == SERIE_A_SIN || s.type == SERIE_A_COS ? s.coefficients[i * 7] : s.coefficients[i * 3 + 1];
+}
+
+// returns the absolute value of x at compile time
+constexpr double absolute(double x)
+{
+    return x < 0.0 ? -x : x;
+}
+
+// computes sine and cosine of x (radians) at compile time, precise to a few units in the last place
+constexpr void constexpr_sincos(double x, double &sine, double &cosine)
+{
+    const double pi = M_PI;
+    double term;
+    int n;
+
+    // reducing x to [-π, π]
+    x -= 2.0 * pi * static_cast<double>(static_cast<long long>(x / (2.0 * pi)));
+    if (x > pi)
+        x -= 2.0 * pi;
+    else if (x < -pi)
+        x += 2.0 * pi;
+
+    for (n = 1, term = x, sine = 0.0; n < 40 && term != 0.0; n += 2){
+        sine += term;
+        term *= -x * x / ((n + 1) * (n + 2));
+    }
+    for (n = 0, term = 1.0, cosine = 0.0; n < 40 && term != 0.0; n += 2){
+        cosine += term;
+        term *= -x * x / ((n + 1) * (n + 2));
+    }
+}
+
+/*
+ * A group of terms of a serie sharing the same argument: multipliers of the argument vector, indices and multipliers of
+ * the arguments with nonzero multipliers and coefficients of the sine and cosine of the argument.
+ */
+struct term_group {
+    int multipliers[TOTAL_ARGUMENTS];
+    int arguments;
+    int argument_indices[TOTAL_ARGUMENTS];
+    int argument_multipliers[TOTAL_ARGUMENTS];
+    double sine;
+    double cosine;
+};
+
+// counts terms of the given serie with amplitudes not less than the cutoff
+constexpr int surviving_terms(const serie &s, double cutoff)
+{
+    int i, n;
+
+    for (i = 0, n = 0; i < s.n; i++)
+        if (!(absolute(term_amplitude(s, i)) < cutoff))
+            n++;
+
+    return n;
+}
+
+// sums absolute values of amplitudes of the terms of the given serie dropped by the cutoff
+constexpr double skipped_amplitudes(const serie &s, double cutoff)
+{
+    double sum;
+    int i;
+
+    for (i = 0, sum = 0.0; i < s.n; i++)
+        if (absolute(term_amplitude(s, i)) < cutoff)
+            sum += absolute(term_amplitude(s, i));
+
+    return sum;
+}
+
+// compares multipliers of two groups lexicographically
+constexpr bool precedes(const term_group &a, const term_group &b)
+{
+    for (int k = 0; k < TOTAL_ARGUMENTS; k++)
+        if (a.multipliers[k] != b.multipliers[k])
+            return a.multipliers[k] < b.multipliers[k];
+
+    return false;
+}
+
+/*
+ * Groups N surviving terms of the given serie by their arguments, returns the groups and their amount. Terms are sorted
+ * by their multipliers, thus terms with equal arguments become adjacent and are merged.
+ */
+template <int N>
+constexpr std::pair<std::array<term_group, N>, int> group_terms(const serie &s, double cutoff)
+{
+    std::array<term_group, N> groups{};
+    double amplitude, phase_sine, phase_cosine;
+    int i, k, n;
+
+    for (i = 0, n = 0; i < s.n; i++){
+        amplitude = term_amplitude(s, i);
+        if (absolute(amplitude) < cutoff)
+            continue;
+
+        for (k = 0; k < TOTAL_ARGUMENTS; k++)
+            groups[n].multipliers[k] = term_multiplier(s, i, k);
+
+        // A·sin(x + φ) = A·cos(φ)·sin(x) + A·sin(φ)·cos(x), the Main Problem is kept exact
+        if (s.type == SERIE_A_SIN){
+            groups[n].sine = amplitude;
+        } else if (s.type == SERIE_A_COS){
+            groups[n].cosine = amplitude;
+        } else {
+            constexpr_sincos(s.coefficients[i * 3] * (M_PI / 648000.0), phase_sine, phase_cosine);
+            groups[n].sine = amplitude * phase_cosine;
+            groups[n].cosine = amplitude * phase_sine;
+        }
+        n++;
+    }
+
+    std::sort(groups.begin(), groups.end(), precedes);
+
+    // merging adjacent terms with equal arguments
+    for (i = 1, n = N > 0 ? 1 : 0; i < N; i++){
+        if (precedes(groups[n - 1], groups[i])){
+            groups[n++] = groups[i];
+        } else {
+            groups[n - 1].sine += groups[i].sine;
+            groups[n - 1].cosine += groups[i].cosine;
+        }
+    }
+
+    // listing arguments with nonzero multipliers
+    for (i = 0; i < n; i++)
+        for (k = 0, groups[i].arguments = 0; k < TOTAL_ARGUMENTS; k++)
+            if (groups[i].multipliers[k] != 0){
+                groups[i].argument_indices[groups[i].arguments] = k;
+                groups[i].argument_multipliers[groups[i].arguments++] = groups[i].multipliers[k];
+            }
+
+    return {groups, n};
+}
+
+} // namespace detail
+
+/*
+ * A kernel computing the serie with the given index of the table of the theory (see theory.h) without terms with
+ * absolute values of amplitudes less than the cutoff.
+ */
+template <int Serie, double Cutoff>
+class serie_kernel {
+    static constexpr const serie &s = detail::kernel_series[Serie];
+    static constexpr int candidates = detail::surviving_terms(s, Cutoff);
+    static constexpr auto grouped = detail::group_terms<candidates>(s, Cutoff);
+
+    template <std::size_t G>
+    static constexpr detail::term_group group = grouped.first[G];
+
+    // products of multipliers and arguments are added to -0.0, which is an exact identity of floating point addition
+    // and is dropped by the compiler
+    template <std::size_t G, std::size_t... K>
+    static double argument([[maybe_unused]] const double arguments[], std::index_sequence<K...>)
+    {
+        return (-0.0 + ... + (static_cast<double>(group<G>.argument_multipliers[K]) *
+                              arguments[group<G>.argument_indices[K]]));
+    }
+
+    template <std::size_t G>
+    static double term(const double arguments[])
+    {
+        const double x = argument<G>(arguments, std::make_index_sequence<group<G>.arguments>()) *
+                         (M_PI / 648000.0);
+
+        if constexpr (group<G>.cosine == 0.0)
+            return group<G>.sine * std::sin(x);
+        else if constexpr (group<G>.sine == 0.0)
+            return group<G>.cosine * std::cos(x);
+        else
+            return group<G>.sine * std::sin(x) + group<G>.cosine * std::cos(x);
+    }
+
+    template <std::size_t... G>
+    static double sum([[maybe_unused]] const double arguments[], std::index_sequence<G...>)
+    {
+        return (-0.0 + ... + term<G>(arguments));
+    }
+
+public:
+    static constexpr int coordinate = s.coordinate;     // spherical coordinate the serie contributes to
+    static constexpr int power = s.power;               // power of t the serie is multiplied by
+    static constexpr int terms = candidates;            // amount of surviving terms
+    static constexpr int groups = grouped.second;       // amount of distinct arguments of the surviving terms
+    static constexpr double skipped = detail::skipped_amplitudes(s, Cutoff);   // sum of |A| of the dropped terms
+
+    /*
+     * Computes the serie (not multiplied by the power of t) given the argument vector of the engine measured in
+     * arcseconds (see detail::serie_argument_vector).
+     */
+    static double compute(const double arguments[])
+    {
+        return sum(arguments, std::make_index_sequence<groups>());
+    }
+};
+
+/*
+ * A kernel computing geocentric position of the Moon with all series of the theory without terms with absolute values
+ * of amplitudes less than the cutoff.
+ */
+template <double Cutoff>
+class kernel {
+    template <std::size_t... I>
+    static void add_series(double t, const double arguments[], double coordinates[], std::index_sequence<I...>)
+    {
+        ((coordinates[serie_kernel<I, Cutoff>::coordinate] += serie_kernel<I, Cutoff>::compute(arguments) *
+          (serie_kernel<I, Cutoff>::power == 0 ? 1.0 : serie_kernel<I, Cutoff>::power == 1 ? t : t * t)), ...);
+    }
+
+    template <std::size_t... I>
+    static constexpr int count_terms(std::index_sequence<I...>)
+    {
+        return (0 + ... + serie_kernel<I, Cutoff>::terms);
+    }
+
+    template <std::size_t... I>
+    static void add_errors(double t, double errors[], std::index_sequence<I...>)
+    {
+        ((errors[serie_kernel<I, Cutoff>::coordinate] += serie_kernel<I, Cutoff>::skipped *
+          (serie_kernel<I, Cutoff>::power == 0 ? 1.0 : serie_kernel<I, Cutoff>::power == 1 ? std::abs(t) :
+           t * t)), ...);
+    }
+
+public:
+    // amount of terms of the theory computed by the kernel
+    static constexpr int terms = count_terms(std::make_index_sequence<TOTAL_ELP2000_SERIES>());
+
+    /*
+     * Computes geocentric position of the Moon in spherical coordinates referred to the ELP 2000 reference frame (see
+     * geocentric_moon_position).
+     */
+    static spherical<double> position(double t)
+    {
+        double arguments[detail::TOTAL_ARGUMENTS];
+        double elp[TOTAL_ELP2000_ARGUMENTS];
+        double coordinates[TOTAL_SPHERICAL_COORDINATES] = {0.0, 0.0, 0.0};
+
+        detail::serie_argument_vector(t, arguments);
+        add_series(t, arguments, coordinates, std::make_index_sequence<TOTAL_ELP2000_SERIES>());
+
+        // adding mean mean longitude of the Moon (W₁)
+        detail::elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, elp);
+
+        return {coordinates[LONGITUDE] + elp[W1], coordinates[LATITUDE], coordinates[DISTANCE]};
+    }
+
+    /*
+     * Computes geocentric position of the Moon in the given coordinates and reference frame (one of ELP_frames, see
+     * geocentric_moon_position_in_frame).
+     */
+    static std::array<double, 3> position_in_frame(double t, int frame)
+    {
+        return detail::refer_to_frame(t, position(t), frame);
+    }
+
+    /*
+     * Estimates the error of position(t) relative to the full theory: the sum of the bounds |A||t|^p of the dropped
+     * terms of each coordinate (see geocentric_moon_truncation_error). Sums of amplitudes are found at compile time.
+     */
+    static spherical<double> error(double t)
+    {
+        double errors[TOTAL_SPHERICAL_COORDINATES] = {0.0, 0.0, 0.0};
+
+        add_errors(t, errors, std::make_index_sequence<TOTAL_ELP2000_SERIES>());
+
+        return {errors[LONGITUDE], errors[LATITUDE], errors[DISTANCE]};
+    }
+
+    /*
+     * Estimates the error of position_in_frame(t, frame) the same way: errors of angles are kept in spherical frames,
+     * while each rectangular coordinate is bounded by the error of distance and the errors of angles at the greatest
+     * distance of the Moon.
+     */
+    static std::array<double, 3> error_in_frame(double t, int frame)
+    {
+        const spherical<double> e = error(t);
+        double bound;
+
+        if (frame == ELP2000_SPHERICAL || frame == OF_DATE_SPHERICAL)
+            return {e.longitude, e.latitude, e.distance};
+
+        bound = e.distance + detail::maximum_distance * (e.longitude + e.latitude) * (M_PI / 648000.0);
+        return {bound, bound, bound};
+    }
+};
+
+} // namespace elp2000
+
+#endif // KERNELS_HPP
@@ -0,0 +1,164 @@
+/*
+ * partials.c
+ */
+
+#include "partials.h"
+#include "theory.h"
+#include "threadpool.h"
+
+/*
+ * A datatype holding the context of a batch of derivatives.
+ */
+typedef struct {
+    const double *t;            // time instants
+    int n;                      // amount of time instants
+    double *positions;          // output positions, three values per time instant
+    double *partials;           // output derivatives
+    int size;                   // amount of derivatives per time instant
+    void (*compute)(double t, double position[], double partials[]);    // routine computing a time instant
+} partials_batch;
+
+/*
+ * Derivatives of Delaunay arguments D, l', l and F with respect to ELP 2000 arguments W₁, W₂, W₃, T and ϖ'.
+ */
+static const double delaunay_derivatives[TOTAL_DELAUNAY_ARGUMENTS][TOTAL_ELP2000_ARGUMENTS] = {
+    {1.0, 0.0, 0.0, -1.0, 0.0},     // D = W₁ - T + π
+    {0.0, 0.0, 0.0, 1.0, -1.0},     // l' = T - ϖ'
+    {1.0, -1.0, 0.0, 0.0, 0.0},     // l = W₁ - W₂
+    {1.0, 0.0, -1.0, 0.0, 0.0}      // F = W₁ - W₃
+};
+
+void geocentric_moon_sigma_partials(double t, double position[], double partials[])
+{
+    serie_arguments arguments;                          // arguments of the series
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];  // ELP2000 arguments
+    double sum;                                         // value of a serie
+    double derivatives[TOTAL_SIGMA_CONSTANTS];          // derivatives of a serie
+    const serie *s;                                     // current serie
+    int i, j, k;                                        // loop index variables
+
+    compute_serie_arguments(t, &arguments);
+    position[LONGITUDE] = position[LATITUDE] = position[DISTANCE] = 0.0;
+    for (j = 0; j < TOTAL_SPHERICAL_COORDINATES * TOTAL_SIGMA_CONSTANTS; j++)
+        partials[j] = 0.0;
+
+    // computing all series, each multiplied by its power of t, in the same order as geocentric_moon_position does
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        s = &elp2000_series[i];
+        sum = compute_serie_sigma_partials(s, &arguments, derivatives);
+        for (k = 0; k < s->power; k++){
+            sum *= t;
+            for (j = 0; j < TOTAL_SIGMA_CONSTANTS; j++)
+                derivatives[j] *= t;
+        }
+        position[s->coordinate] += sum;
+        for (j = 0; j < TOTAL_SIGMA_CONSTANTS; j++)
+            partials[s->coordinate * TOTAL_SIGMA_CONSTANTS + j] += derivatives[j];
+    }
+
+    // adding mean mean longitude of the Moon (W₁)
+    compute_elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+    position[LONGITUDE] += elp2000_arguments[W1];
+}
+
+void geocentric_moon_argument_partials(double t, double position[], double partials[])
+{
+    serie_arguments arguments;                          // arguments of the series
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];  // ELP2000 arguments
+    double sum;                                         // value of a serie
+    double derivatives[TOTAL_DELAUNAY_ARGUMENTS + 1];   // derivatives of a serie with respect to its arguments
+    double full[TOTAL_SPHERICAL_COORDINATES][TOTAL_DELAUNAY_ARGUMENTS];         // by full Delaunay arguments
+    double reduced[TOTAL_SPHERICAL_COORDINATES][TOTAL_DELAUNAY_ARGUMENTS + 1];  // by reduced arguments and ζ
+    double tn;                                          // n-th power of t at n-th iteration of the loop
+    double *row;                                        // derivatives of a coordinate
+    const serie *s;                                     // current serie
+    int c, i, j, k;                                     // loop index variables
+
+    compute_serie_arguments(t, &arguments);
+    for (c = 0; c < TOTAL_SPHERICAL_COORDINATES; c++){
+        position[c] = 0.0;
+        for (j = 0; j <= TOTAL_DELAUNAY_ARGUMENTS; j++){
+            reduced[c][j] = 0.0;
+            if (j < TOTAL_DELAUNAY_ARGUMENTS)
+                full[c][j] = 0.0;
+        }
+    }
+
+    // computing all series, each multiplied by its power of t, in the same order as geocentric_moon_position does,
+    // with derivatives with respect to the arguments they use
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        s = &elp2000_series[i];
+        sum = compute_serie_argument_partials(s, &arguments, derivatives);
+        for (k = 0; k < s->power; k++){
+            sum *= t;
+            for (j = 0; j <= TOTAL_DELAUNAY_ARGUMENTS; j++)
+                derivatives[j] *= t;
+        }
+        position[s->coordinate] += sum;
+        for (j = 0; j <= TOTAL_DELAUNAY_ARGUMENTS; j++)
+            if (s->type == SERIE_A_SIN || s->type == SERIE_A_COS)
+                full[s->coordinate][j] += j < TOTAL_DELAUNAY_ARGUMENTS ? derivatives[j] : 0.0;
+            else
+                reduced[s->coordinate][j] += derivatives[j];
+    }
+
+    // adding mean mean longitude of the Moon (W₁)
+    compute_elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+    position[LONGITUDE] += elp2000_arguments[W1];
+
+    // chain rule: coefficient of power k enters full arguments and W₁ through tᵏ, reduced arguments and ζ only if k < 2
+    for (c = 0; c < TOTAL_SPHERICAL_COORDINATES; c++){
+        row = &partials[c * TOTAL_ARGUMENT_COEFFICIENTS];
+        for (i = W1; i <= OBP; i++)
+            for (k = 0, tn = 1.0; k < FULL_SERIES_TOTAL_TERMS; k++, tn *= t){
+                row[i * FULL_SERIES_TOTAL_TERMS + k] = 0.0;
+                for (j = D; j <= F; j++){
+                    row[i * FULL_SERIES_TOTAL_TERMS + k] += full[c][j] * delaunay_derivatives[j][i] * tn;
+                    if (k < LINEAR_SERIES_TOTAL_TERMS)
+                        row[i * FULL_SERIES_TOTAL_TERMS + k] += reduced[c][j] * delaunay_derivatives[j][i] * tn;
+                }
+                if (i == W1 && k < LINEAR_SERIES_TOTAL_TERMS)
+                    row[i * FULL_SERIES_TOTAL_TERMS + k] += reduced[c][TOTAL_DELAUNAY_ARGUMENTS] * tn;
+                if (i == W1 && c == LONGITUDE)
+                    row[i * FULL_SERIES_TOTAL_TERMS + k] += tn;
+            }
+    }
+}
+
+/*
+ * Computes a chunk of a batch: positions and derivatives at up to PARTIALS_CHUNK_EPOCHS consecutive time instants.
+ */
+static void compute_partials_chunk(void *context, int index)
+{
+    partials_batch *batch = context;
+    int k;                      // loop index variable
+
+    for (k = index * PARTIALS_CHUNK_EPOCHS; k < batch->n && k < (index + 1) * PARTIALS_CHUNK_EPOCHS; k++)
+        batch->compute(batch->t[k], &batch->positions[3 * k], &batch->partials[batch->size * k]);
+}
+
+void geocentric_moon_sigma_partials_batch(const double t[], int n, double positions[], double partials[])
+{
+    partials_batch batch;       // context of the batch
+
+    batch.t = t;
+    batch.n = n;
+    batch.positions = positions;
+    batch.partials = partials;
+    batch.size = TOTAL_SPHERICAL_COORDINATES * TOTAL_SIGMA_CONSTANTS;
+    batch.compute = geocentric_moon_sigma_partials;
+    thread_pool_run(compute_partials_chunk, &batch, (n + PARTIALS_CHUNK_EPOCHS - 1) / PARTIALS_CHUNK_EPOCHS);
+}
+
+void geocentric_moon_argument_partials_batch(const double t[], int n, double positions[], double partials[])
+{
+    partials_batch batch;       // context of the batch
+
+    batch.t = t;
+    batch.n = n;
+    batch.positions = positions;
+    batch.partials = partials;
+    batch.size = TOTAL_SPHERICAL_COORDINATES * TOTAL_ARGUMENT_COEFFICIENTS;
+    batch.compute = geocentric_moon_argument_partials;
+    thread_pool_run(compute_partials_chunk, &batch, (n + PARTIALS_CHUNK_EPOCHS - 1) / PARTIALS_CHUNK_EPOCHS);
+}
@@ -0,0 +1,80 @@
+/*
+ * partials.h
+ *
+ * This file contains routines to compute positions of the Moon together with their partial derivatives with respect
+ * to constants of the theory, meant for fitting the constants to observations.
+ *
+ * Tables of the Main Problem hold, besides the amplitude A of each term, its derivatives ∂A/∂σ₁ … ∂A/∂σ₆ with respect
+ * to six constants of the theory (see mainprob.h). The derivative of a coordinate with respect to σⱼ is then
+ *
+ *                                  Σ (∂A/∂σⱼ){sin|cos}(i₁D + i₂l' + i₃l + i₄F),
+ *
+ * summed over the terms of the Main Problem of the coordinate, while the other series depend on none of these
+ * constants. The sine or cosine of each term is computed once and shared by its contribution to the coordinate and to
+ * all six derivatives (see compute_serie_sigma_partials), thus positions with derivatives cost little more than
+ * positions alone. Positions are always computed from the full series, thus they are the ones of
+ * geocentric_moon_position without caches; while a cache of Chebyshev approximations is running, the latter returns
+ * fitted values instead, which differ by up to the residual of the approximation (see chebyshev_residual).
+ *
+ * Derivatives with respect to the coefficients of the polynomials of ELP 2000 arguments W₁, W₂, W₃, T and ϖ' (see
+ * elp2000_arguments_coefficients) follow by the chain rule. The derivative of a term A{sin|cos}(φ) with respect to an
+ * argument it depends on is A{cos|-sin}(φ) times the multiplier of the argument; these are summed per coordinate for
+ * each of the Delaunay arguments D = W₁ - T + π, l' = T - ϖ', l = W₁ - W₂, F = W₁ - W₃ and the precession argument
+ * ζ = W₁ + pt. A coefficient of power k of an argument enters the arguments through tᵏ: full Delaunay arguments of the
+ * Main Problem use all powers, while the arguments of the other series and ζ are reduced to linear terms, thus depend
+ * only on the first two coefficients. Longitude also holds W₁ itself. Planetary arguments depend on none of the
+ * coefficients. Thus derivatives with respect to all 25 coefficients cost a single cosine per term over a position.
+ */
+
+#ifndef PARTIALS_H
+#define PARTIALS_H
+
+#include "series.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOTAL_ARGUMENT_COEFFICIENTS 25  // amount of coefficients of the polynomials of ELP 2000 arguments
+#define PARTIALS_CHUNK_EPOCHS 16        // amount of time instants computed by a single batch task
+
+/*
+ * Computes longitude, latitude and distance of the Moon in the ELP 2000 reference frame (see geocentric_moon_position)
+ * at time instant t (Julian centuries since J2000), writing them into the position array, and their derivatives with
+ * respect to σ₁ … σ₆ into the partials array of 3 × TOTAL_SIGMA_CONSTANTS values, row by row for each coordinate.
+ * Derivatives are measured in units of the coordinates per unit of the constants as tabulated.
+ */
+void geocentric_moon_sigma_partials(double t, double position[], double partials[]);
+
+/*
+ * Computes positions and their derivatives with respect to σ₁ … σ₆ the same way as geocentric_moon_sigma_partials at
+ * n time instants, writing three values of positions and 3 × TOTAL_SIGMA_CONSTANTS values of derivatives per time
+ * instant into the given arrays. Chunks of PARTIALS_CHUNK_EPOCHS time instants are spread over the pool of threads
+ * (see threadpool.h) if it is started.
+ */
+void geocentric_moon_sigma_partials_batch(const double t[], int n, double positions[], double partials[]);
+
+/*
+ * Computes longitude, latitude and distance of the Moon in the ELP 2000 reference frame at time instant t (Julian
+ * centuries since J2000), writing them into the position array, and their derivatives with respect to the
+ * coefficients of the polynomials of ELP 2000 arguments into the partials array of 3 × TOTAL_ARGUMENT_COEFFICIENTS
+ * values, row by row for each coordinate. Within a row derivative with respect to coefficient of power k of argument
+ * a (one of ELP_arguments) has index a × FULL_SERIES_TOTAL_TERMS + k, matching elp2000_arguments_coefficients.
+ * Derivatives are measured in units of the coordinates per unit of the coefficients (arcseconds per Julian century
+ * to the power k).
+ */
+void geocentric_moon_argument_partials(double t, double position[], double partials[]);
+
+/*
+ * Computes positions and their derivatives with respect to the coefficients of the polynomials of ELP 2000 arguments
+ * the same way as geocentric_moon_argument_partials at n time instants, writing three values of positions and
+ * 3 × TOTAL_ARGUMENT_COEFFICIENTS values of derivatives per time instant into the given arrays. Chunks of
+ * PARTIALS_CHUNK_EPOCHS time instants are spread over the pool of threads (see threadpool.h) if it is started.
+ */
+void geocentric_moon_argument_partials_batch(const double t[], int n, double positions[], double partials[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PARTIALS_H
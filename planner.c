@@ -0,0 +1,408 @@
+/*
+ * planner.c
+ */
+
+#include "planner.h"
+#include "autotune.h"
+#include "densegrid.h"
+#include "elp2000-82b.h"
+#include "gemm.h"
+#include "theory.h"
+
+#include <float.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define MAXIMUM_DISTANCE 410000.0       // bound of the distance of the Moon, kilometers
+#define GRID_BLOCK_EPOCHS 1024          // amount of time instants of a grid computed at once by other backends
+#define THRESHOLD_STEPS 8               // amount of thresholds tried per decade
+#define MIN_THRESHOLD_EXPONENT -12      // decimal exponent of the least threshold tried
+#define MAX_THRESHOLD_EXPONENT 6        // decimal exponent of the greatest threshold tried
+
+static const char *backend_names[TOTAL_PLAN_BACKENDS] = {
+    "series", "truncated", "gemm", "dense grid", "session", "chebyshev", "taylor"
+};
+
+static double series_time;      // time of a position computed by the full series, seconds
+static pthread_once_t calibration_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Returns the time of the monotonic clock in seconds.
+ */
+static double current_time(void)
+{
+    struct timespec now;        // current time
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/*
+ * Measures the time of a position computed by the full series.
+ */
+static void calibrate(void)
+{
+    double t[PLANNER_CALIBRATION_EPOCHS];               // time instants
+    double positions[3 * PLANNER_CALIBRATION_EPOCHS];   // positions at them
+    double start;                                       // time the measurement started at
+    int i;                                              // loop index variable
+
+    for (i = 0; i < PLANNER_CALIBRATION_EPOCHS; i++)
+        t[i] = i / 36525.0;
+
+    start = current_time();
+    geocentric_moon_positions(t, PLANNER_CALIBRATION_EPOCHS, ELP2000_SPHERICAL, positions);
+    series_time = (current_time() - start) / PLANNER_CALIBRATION_EPOCHS;
+}
+
+/*
+ * Returns the greatest of the errors of the coordinates of positions at time instant t computed with the given
+ * threshold in the given frame.
+ */
+static double truncation_error(double t, int frame, double threshold)
+{
+    double error[3];            // errors of the coordinates
+
+    geocentric_moon_truncation_error(t, frame, threshold, error);
+
+    return fmax(error[0], fmax(error[1], error[2]));
+}
+
+/*
+ * Returns the rounding error of positions at time instant t in the given frame, which is dominated by the longitude
+ * holding the mean mean longitude of the Moon (W₁) of many revolutions.
+ */
+static double rounding_error(double t, int frame)
+{
+    double arguments[TOTAL_ELP2000_ARGUMENTS];  // ELP2000 arguments
+    double error;                               // rounding error of the longitude, arcseconds
+
+    compute_elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, arguments);
+    error = 2.0 * DBL_EPSILON * fabs(arguments[W1]);
+
+    return frame == ELP2000_SPHERICAL || frame == OF_DATE_SPHERICAL ? error : MAXIMUM_DISTANCE * error *
+                                                                             (M_PI / 648000.0);
+}
+
+/*
+ * Returns the greatest of the errors of the coordinates of positions of dense grids at time instant t in the given
+ * frame: errors of the sums of the terms are a fraction of the sums of amplitudes (see densegrid.h), i.e. of the
+ * errors of truncated series skipping all terms.
+ */
+static double dense_grid_error(double t, int frame)
+{
+    return PLANNER_DENSE_GRID_ERROR * truncation_error(t, frame, HUGE_VAL) + rounding_error(t, frame);
+}
+
+/*
+ * Returns the greatest of the errors of the coordinates of positions computed by Taylor polynomials of the given order
+ * in the given frame around the middle of the span of a query.
+ */
+static double taylor_error(const elp_query *query, int order)
+{
+    double error[3];            // errors of the coordinates
+
+    geocentric_moon_taylor_error(0.5 * (query->t0 + query->t1), order, query->frame, 0.5 * (query->t1 - query->t0),
+                                 error);
+
+    return fmax(error[0], fmax(error[1], error[2])) + rounding_error(fmax(fabs(query->t0), fabs(query->t1)),
+                                                                     query->frame);
+}
+
+/*
+ * Finds the least order of Taylor polynomials around the middle of the span of a query whose error stays within the
+ * tolerance and writes the error into the given variable. Returns the order, or a negative value if there is none, the
+ * error being the one of the greatest order then.
+ */
+static int find_order(const elp_query *query, double *error)
+{
+    double e;                   // error of the middle order
+    int low, high, middle;      // range of orders searched and its middle
+
+    if ((*error = taylor_error(query, TAYLOR_MAX_ORDER)) > query->tolerance)
+        return -1;
+
+    // the error falls with the order once the order exceeds the angles swept over the span, thus the least order is
+    // found by bisection, keeping an order within the tolerance at the upper end of the range
+    for (low = 0, high = TAYLOR_MAX_ORDER; low < high; ){
+        middle = (low + high) / 2;
+        if ((e = taylor_error(query, middle)) <= query->tolerance){
+            high = middle;
+            *error = e;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    return high;
+}
+
+/*
+ * Finds the greatest of the thresholds tried whose error at time instant t in the given frame stays within the
+ * tolerance, zero if there is none.
+ */
+static double find_threshold(double t, int frame, double tolerance)
+{
+    int low, high, middle;      // range of exponents searched, multiplied by THRESHOLD_STEPS, and its middle
+
+    low = MIN_THRESHOLD_EXPONENT * THRESHOLD_STEPS;
+    high = MAX_THRESHOLD_EXPONENT * THRESHOLD_STEPS;
+    if (truncation_error(t, frame, pow(10.0, (double)low / THRESHOLD_STEPS)) > tolerance)
+        return 0.0;
+
+    // the error grows with the threshold, thus the greatest threshold is found by bisection
+    while (low < high){
+        middle = (low + high + 1) / 2;
+        if (truncation_error(t, frame, pow(10.0, (double)middle / THRESHOLD_STEPS)) <= tolerance)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+
+    return pow(10.0, (double)low / THRESHOLD_STEPS);
+}
+
+/*
+ * Returns the fraction of the terms of the series with absolute values of amplitudes not less than the threshold.
+ */
+static double kept_fraction(double threshold)
+{
+    int kept, total;            // amounts of kept and all terms
+    int i, j;                   // loop index variables
+
+    for (i = 0, kept = total = 0; i < TOTAL_ELP2000_SERIES; i++)
+        for (j = 0; j < elp2000_series[i].n; j++, total++)
+            kept += fabs(serie_term_amplitude(&elp2000_series[i], j)) >= threshold;
+
+    return (double)kept / total;
+}
+
+/*
+ * Estimates the error, the time of a position and the total time of the query of a backend, given the time of warming
+ * it and the time of a position in times of a position computed by the full series. Backends breaking the contract of
+ * the query get infinite total time.
+ */
+static void estimate(elp_plan *plan, int backend, double error, double setup, double ratio)
+{
+    const elp_query *query = &plan->query;
+    double epochs;              // expected amount of positions
+
+    epochs = query->epochs > 0 ? (double)query->epochs : 1.0;
+    plan->errors[backend] = error;
+    plan->latencies[backend] = ratio * plan->series_time;
+    plan->costs[backend] = (setup + epochs * ratio) * plan->series_time;
+    if (error > query->tolerance || (query->latency > 0.0 && plan->latencies[backend] > query->latency))
+        plan->costs[backend] = HUGE_VAL;
+}
+
+/*
+ * Warms the given backend of a plan. Returns zero on success or a negative value on failure.
+ */
+static int warm(elp_plan *plan, int backend)
+{
+    const elp_query *query = &plan->query;
+    double tolerance;           // tolerance of the spherical coordinates of a session
+
+    switch (backend){
+        case BACKEND_SESSION:
+            // sessions are created in spherical coordinates, rectangular ones are bounded the same way as errors
+            tolerance = query->tolerance;
+            if (query->frame != ELP2000_SPHERICAL && query->frame != OF_DATE_SPHERICAL)
+                tolerance /= 1.0 + 2.0 * MAXIMUM_DISTANCE * M_PI / 648000.0;
+            return elp_session_create(query->t0, query->t1, tolerance, &plan->session);
+        case BACKEND_CHEBYSHEV:
+            return chebyshev_fit_tolerance(query->t0, query->t1, query->frame, query->tolerance, &plan->ephemeris);
+        case BACKEND_TAYLOR:
+            return geocentric_moon_taylor(0.5 * (query->t0 + query->t1), plan->order, query->frame, plan->taylor);
+        default:
+            return 0;
+    }
+}
+
+int elp_plan_create(const elp_query *query, elp_plan *plan)
+{
+    double extent;              // largest absolute value of t over the span
+    double years, days;         // length of the span
+    double fraction;            // fraction of the terms kept by the threshold
+    double error;               // error of the truncated series
+    double gemm_ratio;          // time of matrix products relative to the full series
+    double taylor;              // error of Taylor polynomials
+    int b;                      // loop index variable
+
+    if (!(query->tolerance >= 0.0) || !(query->latency >= 0.0) || query->frame < 0 ||
+        query->frame >= TOTAL_ELP_FRAMES || query->pattern < PLAN_SINGLE || query->pattern > PLAN_GRID)
+        return -1;
+    if (query->pattern == PLAN_GRID ? !(query->step > 0.0) || query->epochs < 1 || !isfinite(query->t0) :
+                                      !(query->t1 >= query->t0) || !isfinite(query->t0) || !isfinite(query->t1))
+        return -1;
+
+    pthread_once(&calibration_once, calibrate);
+
+    plan->query = *query;
+    if (query->pattern == PLAN_GRID)
+        plan->query.t1 = query->t0 + query->step * (query->epochs - 1);
+    plan->series_time = series_time;
+    plan->session.terms = NULL;
+    plan->session.exact = NULL;
+    plan->session.n = plan->session.kept = 0;
+    plan->ephemeris.coefficients = NULL;
+
+    extent = fmax(fabs(plan->query.t0), fabs(plan->query.t1));
+    days = (plan->query.t1 - plan->query.t0) * 36525.0;
+    years = days / 365.25;
+
+    // thresholds skipping no terms are dropped, so that truncated series are planned only when they save time
+    plan->threshold = find_threshold(extent, query->frame, query->tolerance);
+    error = plan->threshold > 0.0 ? truncation_error(extent, query->frame, plan->threshold) : 0.0;
+    if (error == 0.0)
+        plan->threshold = 0.0;
+    fraction = kept_fraction(plan->threshold);
+    gemm_ratio = elp_tuning_current()->gemm_ratio > 0.0 ? elp_tuning_current()->gemm_ratio : PLANNER_GEMM_RATIO;
+
+    estimate(plan, BACKEND_SERIES, 0.0, 0.0, 1.0);
+    estimate(plan, BACKEND_TRUNCATED, error, 0.0, fraction);
+    estimate(plan, BACKEND_GEMM, error, 0.0, gemm_ratio * fraction);
+    estimate(plan, BACKEND_DENSE_GRID, dense_grid_error(extent, query->frame), 0.0, PLANNER_DENSE_GRID_COST);
+    estimate(plan, BACKEND_SESSION, query->tolerance, PLANNER_SESSION_SETUP,
+             PLANNER_SESSION_COST + PLANNER_SESSION_YEARLY * years);
+    estimate(plan, BACKEND_CHEBYSHEV, query->tolerance, PLANNER_CHEBYSHEV_SETUP + PLANNER_CHEBYSHEV_DAILY * days,
+             PLANNER_CHEBYSHEV_COST);
+
+    // Taylor polynomials of the least order meeting the tolerance, estimated with the greatest order if none does
+    plan->order = find_order(&plan->query, &taylor);
+    estimate(plan, BACKEND_TAYLOR, taylor, PLANNER_TAYLOR_SETUP + PLANNER_TAYLOR_ORDER *
+             (plan->order >= 0 ? plan->order : TAYLOR_MAX_ORDER), PLANNER_TAYLOR_COST);
+
+    // backends not suiting the query: truncated series need a threshold, matrix products need batches, dense grids need
+    // grids with chunks short enough and sessions, approximations and Taylor polynomials need a tolerance and a span
+    if (plan->threshold == 0.0)
+        plan->costs[BACKEND_TRUNCATED] = HUGE_VAL;
+    if (query->pattern == PLAN_SINGLE)
+        plan->costs[BACKEND_GEMM] = HUGE_VAL;
+    if (query->pattern != PLAN_GRID || query->epochs < DENSE_GRID_MIN_CHUNK ||
+        query->step * DENSE_GRID_MIN_CHUNK > DENSE_GRID_MAX_SPAN)
+        plan->costs[BACKEND_DENSE_GRID] = HUGE_VAL;
+    if (!(query->tolerance > 0.0) || !(plan->query.t1 > plan->query.t0))
+        plan->costs[BACKEND_SESSION] = plan->costs[BACKEND_CHEBYSHEV] = plan->costs[BACKEND_TAYLOR] = HUGE_VAL;
+
+    // warming the cheapest backend, trying the next one if it fails, and falling back to the full series
+    for (;;){
+        for (b = 0, plan->backend = BACKEND_SERIES; b < TOTAL_PLAN_BACKENDS; b++)
+            if (plan->costs[b] < plan->costs[plan->backend])
+                plan->backend = b;
+        if (plan->costs[plan->backend] == HUGE_VAL){
+            plan->backend = BACKEND_SERIES;
+            break;
+        }
+        if (warm(plan, plan->backend) == 0)
+            break;
+        plan->costs[plan->backend] = HUGE_VAL;
+    }
+
+    return 0;
+}
+
+void elp_plan_positions(const elp_plan *plan, const double t[], int n, double positions[])
+{
+    int i;                      // loop index variable
+
+    switch (plan->backend){
+        case BACKEND_TRUNCATED:
+            geocentric_moon_positions_truncated(t, n, plan->query.frame, plan->threshold, positions);
+            break;
+        case BACKEND_GEMM:
+        case BACKEND_DENSE_GRID:
+            if (geocentric_moon_positions_gemm(t, n, plan->query.frame, plan->threshold, positions) != 0)
+                geocentric_moon_positions_truncated(t, n, plan->query.frame, plan->threshold, positions);
+            break;
+        case BACKEND_SESSION:
+            for (i = 0; i < n; i++)
+                if (t[i] >= plan->query.t0 && t[i] <= plan->query.t1)
+                    elp_session_position(&plan->session, t[i], plan->query.frame, &positions[3 * i]);
+                else
+                    geocentric_moon_positions(&t[i], 1, plan->query.frame, &positions[3 * i]);
+            break;
+        case BACKEND_CHEBYSHEV:
+            for (i = 0; i < n; i++)
+                if (t[i] >= plan->query.t0 && t[i] <= plan->query.t1)
+                    chebyshev_evaluate(&plan->ephemeris, t[i], &positions[3 * i], NULL);
+                else
+                    geocentric_moon_positions(&t[i], 1, plan->query.frame, &positions[3 * i]);
+            break;
+        case BACKEND_TAYLOR:
+            for (i = 0; i < n; i++)
+                if (t[i] >= plan->query.t0 && t[i] <= plan->query.t1)
+                    taylor_evaluate(plan->taylor, plan->order, t[i] - 0.5 * (plan->query.t0 + plan->query.t1),
+                                    &positions[3 * i], NULL);
+                else
+                    geocentric_moon_positions(&t[i], 1, plan->query.frame, &positions[3 * i]);
+            break;
+        default:
+            geocentric_moon_positions(t, n, plan->query.frame, positions);
+            break;
+    }
+}
+
+int elp_plan_grid(const elp_plan *plan, double positions[])
+{
+    double t[GRID_BLOCK_EPOCHS];    // time instants of a block of the grid
+    int64_t first;                  // first time instant of a block
+    int i, m;                       // loop index variable and the amount of time instants of a block
+
+    if (plan->query.pattern != PLAN_GRID)
+        return -1;
+
+    if (plan->backend == BACKEND_DENSE_GRID &&
+        geocentric_moon_dense_grid(plan->query.t0, plan->query.step, plan->query.epochs, plan->query.frame,
+                                   positions) == 0)
+        return 0;
+
+    for (first = 0; first < plan->query.epochs; first += m){
+        m = plan->query.epochs - first < GRID_BLOCK_EPOCHS ? (int)(plan->query.epochs - first) : GRID_BLOCK_EPOCHS;
+        for (i = 0; i < m; i++)
+            t[i] = plan->query.t0 + (first + i) * plan->query.step;
+        elp_plan_positions(plan, t, m, &positions[3 * first]);
+    }
+
+    return 0;
+}
+
+const char *elp_plan_backend_name(int backend)
+{
+    return backend >= 0 && backend < TOTAL_PLAN_BACKENDS ? backend_names[backend] : "unknown";
+}
+
+int elp_plan_describe(const elp_plan *plan, char *buffer, size_t size)
+{
+    size_t length;              // length of the description written so far
+    int b;                      // loop index variable
+
+    // lengths are accumulated past the end of a short buffer the same way as snprintf does
+    length = snprintf(buffer, size, "%-12s %12s %12s %12s\n", "backend", "error", "latency, s", "total, s");
+    for (b = 0; b < TOTAL_PLAN_BACKENDS; b++){
+        if (plan->costs[b] < HUGE_VAL)
+            length += snprintf(buffer + (length < size ? length : size), length < size ? size - length : 0,
+                               "%-12s %12.3g %12.3g %12.3g%s\n", backend_names[b], plan->errors[b],
+                               plan->latencies[b], plan->costs[b], b == plan->backend ? " chosen" : "");
+        else
+            length += snprintf(buffer + (length < size ? length : size), length < size ? size - length : 0,
+                               "%-12s %12.3g %12.3g %12s%s\n", backend_names[b], plan->errors[b],
+                               plan->latencies[b], "rejected", b == plan->backend ? " chosen" : "");
+    }
+    length += snprintf(buffer + (length < size ? length : size), length < size ? size - length : 0,
+                       "threshold %.3g, tolerance %.3g, latency budget %.3g s\n", plan->threshold,
+                       plan->query.tolerance, plan->query.latency);
+
+    return (int)length;
+}
+
+void elp_plan_free(elp_plan *plan)
+{
+    if (plan->session.terms != NULL)
+        elp_session_free(&plan->session);
+    if (plan->ephemeris.coefficients != NULL)
+        chebyshev_free(&plan->ephemeris);
+}
@@ -0,0 +1,149 @@
+/*
+ * planner.h
+ *
+ * This file contains routines choosing the way positions of the Moon are computed for a query stating the accuracy
+ * and latency it needs and the pattern of its time instants, so that callers need not pick one of the backends of the
+ * library by hand.
+ *
+ * Backends considered are the full series (geocentric_moon_positions), the series truncated by an amplitude threshold,
+ * the batch backend of matrix products (see gemm.h), the dense grid evaluator (see densegrid.h), a session of the time
+ * span (see session.h), a Chebyshev approximation of the time span (see chebyshev.h) and Taylor polynomials around the
+ * middle of the time span (see taylor.h). For each of them the planner estimates the error, the time of a position and
+ * the time of warming it (creating a session, fitting or expanding polynomials) in units of the time of a position
+ * computed by the full series, measured once per process. Estimates of errors come from the bounds of skipped terms
+ * (see geocentric_moon_truncation_error), tolerances of sessions and fits and remainders of Taylor polynomials of the
+ * least order meeting the tolerance (see geocentric_moon_taylor_error); errors of dense grids are a fraction of the
+ * sums of amplitudes, found the same way as bounds of skipped terms. Errors of dense grids and Taylor polynomials also
+ * include the rounding error of the longitude, which grows with the mean longitude of the Moon. Estimates of times
+ * come from the amount of terms computed and the cost model below.
+ *
+ * Backends whose error exceeds the tolerance or whose time of a position exceeds the latency budget are rejected, and
+ * the one of the least total time over the expected amount of positions is warmed. If warming fails the next one is
+ * tried; the full series always qualifies and are used when nothing else does. Estimates of all backends are kept in
+ * the plan and may be printed for debugging.
+ */
+
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "chebyshev.h"
+#include "session.h"
+#include "taylor.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOTAL_PLAN_BACKENDS 7           // total amount of backends considered by the planner
+#define PLANNER_CALIBRATION_EPOCHS 16   // amount of positions computed to measure the time of the full series
+
+// cost model, measured in times of a position computed by the full series
+#define PLANNER_GEMM_RATIO 0.6          // time of a term computed by matrix products, unless tuned (see autotune.h)
+#define PLANNER_DENSE_GRID_COST 0.003   // time of a position of a dense grid
+#define PLANNER_DENSE_GRID_ERROR 2e-11  // error of dense grids relative to the sums of amplitudes of the terms
+#define PLANNER_SESSION_SETUP 400.0     // time of creating a session
+#define PLANNER_SESSION_COST 0.02       // time of a position of a session of a short span
+#define PLANNER_SESSION_YEARLY 0.04     // growth of the time of a position of a session per year of its span
+#define PLANNER_CHEBYSHEV_SETUP 700.0   // time of choosing granules and degree of a Chebyshev approximation
+#define PLANNER_CHEBYSHEV_DAILY 3.0     // time of fitting a day of a Chebyshev approximation
+#define PLANNER_CHEBYSHEV_COST 0.0002   // time of a position of a Chebyshev approximation
+#define PLANNER_TAYLOR_SETUP 2.5        // time of expanding Taylor polynomials of order zero
+#define PLANNER_TAYLOR_ORDER 0.3        // growth of the time of expanding Taylor polynomials per order
+#define PLANNER_TAYLOR_COST 0.0001      // time of a position of Taylor polynomials
+
+/*
+ * An enumeration indexing patterns of time instants of queries.
+ */
+enum Plan_patterns {
+    PLAN_SINGLE = 0,    // single positions at scattered time instants within the span
+    PLAN_BATCH = 1,     // batches of positions at arbitrary time instants within the span
+    PLAN_GRID = 2       // positions at equally spaced time instants
+};
+
+/*
+ * An enumeration indexing backends of the planner.
+ */
+enum Plan_backends {
+    BACKEND_SERIES = 0,     // full series (geocentric_moon_positions)
+    BACKEND_TRUNCATED = 1,  // series truncated by an amplitude threshold (geocentric_moon_positions_truncated)
+    BACKEND_GEMM,           // truncated series computed by matrix products (geocentric_moon_positions_gemm)
+    BACKEND_DENSE_GRID,     // dense grid evaluator (geocentric_moon_dense_grid), for grids only
+    BACKEND_SESSION,        // session of the span (elp_session_position)
+    BACKEND_CHEBYSHEV,      // Chebyshev approximation of the span (chebyshev_evaluate)
+    BACKEND_TAYLOR = 6      // Taylor polynomials around the middle of the span (taylor_evaluate)
+};
+
+/*
+ * A datatype describing a query: its contract and the pattern of its time instants.
+ */
+typedef struct {
+    double tolerance;       // largest error allowed, units of the coordinates of the frame; zero for the full theory
+    double latency;         // largest time of a position allowed, seconds; zero for no budget
+    int pattern;            // pattern of time instants (one of Plan_patterns)
+    int frame;              // coordinates and reference frame of positions (one of ELP_frames)
+    double t0, t1;          // time span of the positions, Julian centuries since J2000; t1 is ignored by grids
+    double step;            // interval between time instants of grids, Julian centuries
+    int64_t epochs;         // expected amount of positions, or the amount of time instants of grids
+} elp_query;
+
+/*
+ * A datatype describing a plan: the backend chosen for a query, its state and estimates of all backends.
+ */
+typedef struct {
+    elp_query query;                        // the query
+    int backend;                            // chosen backend (one of Plan_backends)
+    double threshold;                       // amplitude threshold of truncated series
+    double series_time;                     // time of a position computed by the full series, seconds
+    double errors[TOTAL_PLAN_BACKENDS];     // estimated errors of the backends, units of the coordinates
+    double latencies[TOTAL_PLAN_BACKENDS];  // estimated times of a position of the backends, seconds
+    double costs[TOTAL_PLAN_BACKENDS];      // estimated total times of the query, HUGE_VAL for rejected backends
+    elp_session session;                    // session of the span (BACKEND_SESSION)
+    chebyshev_ephemeris ephemeris;          // Chebyshev approximation of the span (BACKEND_CHEBYSHEV)
+    int order;                              // order of Taylor polynomials (BACKEND_TAYLOR)
+    double taylor[3 * (TAYLOR_MAX_ORDER + 1)];  // coefficients of Taylor polynomials (BACKEND_TAYLOR)
+} elp_plan;
+
+/*
+ * Chooses and warms the backend of the least estimated total time meeting the contract of the given query.
+ * Returns zero on success or a negative value if the query is invalid.
+ */
+int elp_plan_create(const elp_query *query, elp_plan *plan);
+
+/*
+ * Computes positions of the Moon at n time instants with the backend of the plan, writing three values per time
+ * instant into the given array. Time instants outside the span of a session, an approximation or Taylor polynomials
+ * are computed by the full series; dense grid plans compute arbitrary time instants by matrix products.
+ */
+void elp_plan_positions(const elp_plan *plan, const double t[], int n, double positions[]);
+
+/*
+ * Computes positions of the Moon at all time instants of the grid of a query of the PLAN_GRID pattern with the backend
+ * of the plan, writing three values per time instant into the given array.
+ * Returns zero on success or a negative value if the query is not a grid.
+ */
+int elp_plan_grid(const elp_plan *plan, double positions[]);
+
+/*
+ * Returns the name of the given backend (one of Plan_backends).
+ */
+const char *elp_plan_backend_name(int backend);
+
+/*
+ * Writes a description of the plan into the given buffer of the given size: estimates of all backends and the chosen
+ * one. Returns the length of the description the same way as snprintf.
+ */
+int elp_plan_describe(const elp_plan *plan, char *buffer, size_t size);
+
+/*
+ * Releases the state of the chosen backend of a plan.
+ */
+void elp_plan_free(elp_plan *plan);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PLANNER_H
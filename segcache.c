@@ -0,0 +1,237 @@
+/*
+ * segcache.c
+ */
+
+#include "segcache.h"
+#include "chebyshev.h"
+#include "elp2000-82b.h"
+#include "tilecache.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EMPTY_KEY INT64_MIN             // key of a slot holding no segment
+#define KEY_HASH 0x9e3779b97f4a7c15ULL  // multiplier of Fibonacci hashing
+#define MAX_GRANULE_INDEX 4503599627370496.0    // 2⁵², bound of indices of granules, beyond which t has no fraction
+
+/*
+ * A datatype describing a slot of the cache, aligned to a cache line so that writers of neighbouring slots do not
+ * disturb readers.
+ */
+typedef struct {
+    _Alignas(64) atomic_uint_fast64_t sequence;             // sequence counter, odd while the slot is written
+    _Atomic int64_t key;                                    // granule and frame of the segment
+    atomic_uint_fast64_t used;                              // tick of the last use of the slot
+    double coefficients[3 * (CHEBYSHEV_MAX_DEGREE + 1)];    // coefficients of the segment
+} cache_slot;
+
+/*
+ * State of the cache.
+ */
+typedef struct {
+    cache_slot *slots;          // slots of the cache, SEGMENT_CACHE_WAYS consecutive slots per set
+    size_t sets;                // amount of sets
+    double granule;             // length of a granule, Julian centuries
+    int degree;                 // degree of the segments
+    atomic_uint_fast64_t tick;  // clock of the least recently used policy, advanced on each miss
+    atomic_ulong hits;
+    atomic_ulong misses;
+    atomic_ulong evictions;
+} segment_cache;
+
+static segment_cache *_Atomic cache;   // running cache, NULL if the cache is stopped
+
+int segment_cache_start(double granule, int degree, size_t budget)
+{
+    segment_cache *c;           // new cache
+    segment_cache *expected;    // expected state of the cache
+    size_t i;                   // loop index variable
+
+    granule = granule == 0.0 ? SEGMENT_CACHE_GRANULE : granule;
+    degree = degree == 0 ? SEGMENT_CACHE_DEGREE : degree;
+    if (!(granule > 0.0) || degree < CHEBYSHEV_MIN_DEGREE || degree > CHEBYSHEV_MAX_DEGREE ||
+        budget < sizeof(segment_cache) + SEGMENT_CACHE_WAYS * sizeof(cache_slot))
+        return -1;
+    if (atomic_load(&cache) != NULL || (c = calloc(1, sizeof(segment_cache))) == NULL)
+        return -1;
+
+    c->sets = (budget - sizeof(segment_cache)) / (SEGMENT_CACHE_WAYS * sizeof(cache_slot));
+    c->granule = granule;
+    c->degree = degree;
+    if ((c->slots = aligned_alloc(_Alignof(cache_slot), c->sets * SEGMENT_CACHE_WAYS * sizeof(cache_slot))) == NULL){
+        free(c);
+        return -1;
+    }
+    for (i = 0; i < c->sets * SEGMENT_CACHE_WAYS; i++){
+        atomic_init(&c->slots[i].sequence, 0);
+        atomic_init(&c->slots[i].key, EMPTY_KEY);
+        atomic_init(&c->slots[i].used, 0);
+    }
+
+    expected = NULL;
+    if (!atomic_compare_exchange_strong(&cache, &expected, c)){
+        free(c->slots);
+        free(c);
+        return -1;
+    }
+
+    return 0;
+}
+
+void segment_cache_stop(void)
+{
+    segment_cache *c = atomic_exchange(&cache, NULL);
+
+    if (c != NULL){
+        free(c->slots);
+        free(c);
+    }
+}
+
+int segment_cache_running(void)
+{
+    return atomic_load_explicit(&cache, memory_order_acquire) != NULL;
+}
+
+/*
+ * Looks for the segment with the given key in the given set and copies its coefficients. Returns non zero on a hit.
+ */
+static int lookup(segment_cache *c, cache_slot *set, int64_t key, double coefficients[])
+{
+    uint_fast64_t before, after;    // values of the sequence counter before and after copying
+    int way;                        // loop index variable
+
+    for (way = 0; way < SEGMENT_CACHE_WAYS; way++){
+        if (atomic_load_explicit(&set[way].key, memory_order_relaxed) != key)
+            continue;
+
+        before = atomic_load_explicit(&set[way].sequence, memory_order_acquire);
+        if (before & 1)
+            continue;
+        if (atomic_load_explicit(&set[way].key, memory_order_relaxed) != key)
+            continue;
+        memcpy(coefficients, set[way].coefficients, sizeof(double) * 3 * (c->degree + 1));
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&set[way].sequence, memory_order_relaxed);
+        if (before != after)
+            continue;
+
+        atomic_store_explicit(&set[way].used, atomic_load_explicit(&c->tick, memory_order_relaxed),
+                              memory_order_relaxed);
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Publishes the segment with the given key into the least recently used slot of the given set, unless the slot is
+ * being written by another thread.
+ */
+static void publish(segment_cache *c, cache_slot *set, int64_t key, const double coefficients[])
+{
+    cache_slot *victim;         // slot to be replaced
+    uint_fast64_t sequence;     // value of the sequence counter of the victim
+    int way;                    // loop index variable
+
+    for (way = 1, victim = &set[0]; way < SEGMENT_CACHE_WAYS; way++)
+        if (atomic_load_explicit(&set[way].used, memory_order_relaxed) <
+            atomic_load_explicit(&victim->used, memory_order_relaxed))
+            victim = &set[way];
+
+    sequence = atomic_load_explicit(&victim->sequence, memory_order_relaxed);
+    if ((sequence & 1) || !atomic_compare_exchange_strong_explicit(&victim->sequence, &sequence, sequence + 1,
+                                                                    memory_order_acquire, memory_order_relaxed))
+        return;
+
+    // the odd sequence must be visible before any write of the slot, otherwise readers may accept a torn segment
+    atomic_thread_fence(memory_order_release);
+
+    if (atomic_load_explicit(&victim->key, memory_order_relaxed) != EMPTY_KEY)
+        atomic_fetch_add_explicit(&c->evictions, 1, memory_order_relaxed);
+    atomic_store_explicit(&victim->key, key, memory_order_relaxed);
+    memcpy(victim->coefficients, coefficients, sizeof(double) * 3 * (c->degree + 1));
+    atomic_store_explicit(&victim->used, atomic_fetch_add_explicit(&c->tick, 1, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_store_explicit(&victim->sequence, sequence + 2, memory_order_release);
+}
+
+/*
+ * Computes position of the Moon at time instant t from the series when no segment is available; velocity is NAN and
+ * the error is zero.
+ */
+static void compute_series(double t, int frame, double position[], double velocity[], double error[])
+{
+    geocentric_moon_positions(&t, 1, frame, position);
+    if (velocity != NULL)
+        velocity[0] = velocity[1] = velocity[2] = NAN;
+    if (error != NULL)
+        error[0] = error[1] = error[2] = 0.0;
+}
+
+void segment_cache_position(double t, int frame, double position[], double velocity[], double error[])
+{
+    segment_cache *c = atomic_load_explicit(&cache, memory_order_acquire);
+    double coefficients[3 * (CHEBYSHEV_MAX_DEGREE + 1)];   // coefficients of the segment of the granule
+    chebyshev_ephemeris segment;    // segment of the granule
+    chebyshev_ephemeris fit;        // segment fitted on a miss
+    double index;                   // index of the granule
+    int64_t key;                    // key of the segment
+    cache_slot *set;                // set of slots the key belongs to
+
+    // the bound is applied before the conversion, which is undefined for values out of the range of int64_t
+    index = floor(t / c->granule);
+    if (!isfinite(index) || fabs(index) > MAX_GRANULE_INDEX){
+        compute_series(t, frame, position, velocity, error);
+        return;
+    }
+    key = (int64_t)index * TOTAL_ELP_FRAMES + frame;
+    set = &c->slots[(size_t)(((uint64_t)key * KEY_HASH) >> 32) % c->sets * SEGMENT_CACHE_WAYS];
+
+    segment.start = index * c->granule;
+    segment.granule = c->granule;
+    segment.granules = 1;
+    segment.degree = c->degree;
+    segment.frame = frame;
+    segment.tolerance = 0.0;
+    segment.coefficients = coefficients;
+
+    if (lookup(c, set, key, coefficients)){
+        atomic_fetch_add_explicit(&c->hits, 1, memory_order_relaxed);
+    } else {
+        atomic_fetch_add_explicit(&c->misses, 1, memory_order_relaxed);
+
+        // the segment is taken from the persistent cache if it is open, and fitted otherwise; the end of the fitted
+        // time span is put in the middle of the granule, so that rounding cannot add a granule
+        if (tile_cache_segment(t, frame, c->granule, c->degree, coefficients) < 0){
+            if (chebyshev_fit(segment.start, segment.start + 0.5 * c->granule, frame, c->granule, c->degree, &fit) < 0){
+                compute_series(t, frame, position, velocity, error);
+                return;
+            }
+            memcpy(coefficients, fit.coefficients, sizeof(double) * 3 * (c->degree + 1));
+            chebyshev_free(&fit);
+        }
+        publish(c, set, key, coefficients);
+    }
+
+    chebyshev_evaluate(&segment, t, position, velocity);
+    if (error != NULL)
+        chebyshev_residual(&segment, t, error);
+}
+
+void segment_cache_get_counters(segment_cache_counters *counters)
+{
+    segment_cache *c = atomic_load_explicit(&cache, memory_order_acquire);
+
+    if (c == NULL){
+        counters->hits = counters->misses = counters->evictions = 0;
+        return;
+    }
+
+    counters->hits = atomic_load_explicit(&c->hits, memory_order_relaxed);
+    counters->misses = atomic_load_explicit(&c->misses, memory_order_relaxed);
+    counters->evictions = atomic_load_explicit(&c->evictions, memory_order_relaxed);
+}
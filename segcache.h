@@ -0,0 +1,84 @@
+/*
+ * segcache.h
+ *
+ * This file contains routines to manage an opt-in in-memory cache of Chebyshev segments (see chebyshev.h) standing in
+ * front of the routines of elp2000-82b.h computing single positions of the Moon.
+ *
+ * Time is split into granules of fixed length counted from J2000. The first query falling into a granule fits a
+ * Chebyshev segment of the granule for the requested frame and publishes it into the cache; later queries falling into
+ * the same granule are computed from the segment. Segments are taken from the persistent cache of tiles (see
+ * tilecache.h) rather than fitted if it is open with the same granule length and degree. The cache is a fixed array of
+ * slots allocated once within the given memory budget and organized as a set associative table keyed by granule and
+ * frame: each key may be held by one of SEGMENT_CACHE_WAYS slots of its set, and a miss replaces the least recently
+ * used slot of the set.
+ *
+ * Lookups take no locks: each slot is guarded by a sequence counter, which is odd while the slot is written. A reader
+ * copies the slot and accepts the copy only if the counter was even and did not change meanwhile (seqlock). Writers
+ * claim slots by advancing the counter with compare-and-swap; a writer failing to claim a slot does not publish its
+ * segment, but still computes the position from it.
+ *
+ * While the cache is running geocentric_moon_position and geocentric_moon_position_in_frame (as well as the routines
+ * built upon geocentric_moon_position) return positions computed from the segments, thus within the tolerance of the
+ * fit rather than exactly equal to the series. Batch and parallel routines always compute the series.
+ */
+
+#ifndef SEGCACHE_H
+#define SEGCACHE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SEGMENT_CACHE_WAYS 4                    // amount of slots a key may be held by
+#define SEGMENT_CACHE_GRANULE (4.0 / 36525.0)   // default granule length, Julian centuries (4 days)
+#define SEGMENT_CACHE_DEGREE 14                 // default degree of the segments
+
+/*
+ * A datatype holding counters of the cache.
+ */
+typedef struct {
+    unsigned long hits;         // queries computed from a cached segment
+    unsigned long misses;       // queries that fitted a segment
+    unsigned long evictions;    // segments replaced by other ones
+} segment_cache_counters;
+
+/*
+ * Starts the cache with segments of the given degree over granules of the given length (Julian centuries) using at
+ * most budget bytes of memory. Zero granule or degree select defaults SEGMENT_CACHE_GRANULE and SEGMENT_CACHE_DEGREE.
+ * Returns zero on success or a negative value if the cache is already running, the arguments are invalid or memory
+ * could not be allocated.
+ */
+int segment_cache_start(double granule, int degree, size_t budget);
+
+/*
+ * Stops the cache and releases its memory. Must not be called while other threads query positions.
+ */
+void segment_cache_stop(void);
+
+/*
+ * Returns non zero if the cache is running.
+ */
+int segment_cache_running(void);
+
+/*
+ * Computes position of the Moon at time instant t in the given frame (one of ELP_frames) and its velocity, measured in
+ * units of the coordinates per Julian century, from the cached segment of the granule, fitting it on a miss. The
+ * estimate of the error of the segment at t (see chebyshev_residual) is written into the error array. Time instants
+ * that are not finite or too far from J2000 to be split into granules, and granules that could not be fitted, are
+ * computed from the series, with velocity set to NAN and zero error. Velocity and error may be NULL. The cache must be
+ * running.
+ */
+void segment_cache_position(double t, int frame, double position[], double velocity[], double error[]);
+
+/*
+ * Reads counters of the cache.
+ */
+void segment_cache_get_counters(segment_cache_counters *counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SEGCACHE_H
@@ -20,16 +20,130 @@
 #define URANUS 6
 #define NEPTUNE 7
 
-double compute_serie_a_sin(double delaunay_arguments[], int multipliers[], double coefficients[], int n)
+/*
+ * Computes the argument of a term of the Main Problem serie given the Delaunay arguments and multipliers of the term.
+ */
+static inline double serie_a_argument(const double delaunay_arguments[], const int multipliers[])
+{
+    double arg;                 // accumulating variable holding the argument
+    int j;                      // loop index variable
+
+    // adding Delaunay arguments
+    for (j = D, arg = 0.0; j <= F; j++)
+        arg += multipliers[j] * delaunay_arguments[j];
+
+    return arg;
+}
+
+/*
+ * Computes the argument of a term of the Poisson serie of type B given the precession argument, Delaunay arguments
+ * and multipliers of the term. Phase of the term is not included.
+ */
+static inline double serie_b_argument(double precession, const double delaunay_arguments[], const int multipliers[])
+{
+    double arg;                 // accumulating variable holding the argument
+    int j;                      // loop index variable
+
+    // adding precession argument
+    arg = multipliers[0] * precession;
+
+    // adding Delaunay arguments
+    for (j = D; j <= F; j++)
+        arg += multipliers[j + 1] * delaunay_arguments[j];
+
+    return arg;
+}
+
+/*
+ * Computes the argument of a term of the Poisson serie of type C given the planetary arguments, Delaunay arguments and
+ * multipliers of the term. Phase of the term is not included.
+ */
+static inline double serie_c_argument(const double planetary_arguments[], const double delaunay_arguments[],
+                                      const int multipliers[])
+{
+    double arg;                 // accumulating variable holding the argument
+    int j;                      // loop index variable
+
+    // adding planetary arguments from Mercury to Neptune
+    for (j = MERCURY, arg = 0.0; j <= NEPTUNE; j++)
+        arg += multipliers[j] * planetary_arguments[j];
+
+    // adding Delaunay arguments except l' argument
+    arg += multipliers[j + 1] * delaunay_arguments[D];
+    arg += multipliers[j + 1] * delaunay_arguments[L];
+    arg += multipliers[j + 1] * delaunay_arguments[F];
+
+    return arg;
+}
+
+/*
+ * Computes the argument of a term of the Poisson serie of type D given the planetary arguments, Delaunay arguments and
+ * multipliers of the term. Phase of the term is not included.
+ */
+static inline double serie_d_argument(const double planetary_arguments[], const double delaunay_arguments[],
+                                      const int multipliers[])
+{
+    double arg;                 // accumulating variable holding the argument
+    int j;                      // loop index variable
+
+    // adding planetary arguments from Mercury to Uranus
+    for (j = MERCURY, arg = 0.0; j <= URANUS; j++)
+        arg += multipliers[j] * planetary_arguments[j];
+
+    // adding Delaunay arguments
+    for (j = D; j <= F; j++)
+        arg += multipliers[TOTAL_PLANETARY_ARGUMENTS + j] * delaunay_arguments[j];
+
+    return arg;
+}
+
+/*
+ * Writes multipliers of Delaunay arguments and the precession argument of the term with index i of the given serie
+ * into the given array of TOTAL_DELAUNAY_ARGUMENTS + 1 values, combined exactly as the arguments of the term are.
+ */
+static inline void serie_term_argument_multipliers(const serie *s, int i, double multipliers[])
+{
+    const int *m;               // multipliers of the term
+    int j;                      // loop index variable
+
+    for (j = 0; j <= TOTAL_DELAUNAY_ARGUMENTS; j++)
+        multipliers[j] = 0.0;
+
+    switch (s->type){
+        case SERIE_A_SIN:
+        case SERIE_A_COS:
+            m = &s->multipliers[i * SERIE_A_TOTAL_MULTIPLIERS];
+            for (j = D; j <= F; j++)
+                multipliers[j] = m[j];
+            break;
+        case SERIE_B:
+            m = &s->multipliers[i * SERIE_B_TOTAL_MULTIPLIERS];
+            for (j = D; j <= F; j++)
+                multipliers[j] = m[j + 1];
+            multipliers[TOTAL_DELAUNAY_ARGUMENTS] = m[0];
+            break;
+        case SERIE_C:
+            // serie_c_argument uses the multiplier following Neptune for each of D, l and F
+            m = &s->multipliers[i * SERIE_C_TOTAL_MULTIPLIERS];
+            multipliers[D] = multipliers[L] = multipliers[F] = m[NEPTUNE + 2];
+            break;
+        case SERIE_D:
+            m = &s->multipliers[i * SERIE_D_TOTAL_MULTIPLIERS];
+            for (j = D; j <= F; j++)
+                multipliers[j] = m[TOTAL_PLANETARY_ARGUMENTS + j];
+            break;
+    }
+}
+
+double compute_serie_a_sin(const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n)
 {
     double acc;                 // accumualtive variable holding the sum of a serie
     double arg;                 // accumulating variable holding the argument of a sine
-    int i, j;                   // loop index variables
+    int i;                      // loop index variable
 
     for (i = 0, acc = 0.0; i < n; i++){
         // adding Delaunay arguments
-        for (j = D, arg = 0.0; j <= F; j++)
-            arg += multipliers[i * SERIE_A_TOTAL_MULTIPLIERS + j] * delaunay_arguments[j];
+        arg = serie_a_argument(delaunay_arguments, &multipliers[i * SERIE_A_TOTAL_MULTIPLIERS]);
 
         // converting argument from arcseconds to radians (π = 648000")
         arg *= M_PI / 648000.0;
@@ -41,16 +155,15 @@ double compute_serie_a_sin(double delaunay_arguments[], int multipliers[], doubl
     return acc;
 }
 
-double compute_serie_a_cos(double delaunay_arguments[], int multipliers[], double coefficients[], int n)
+double compute_serie_a_cos(const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n)
 {
     double acc;                 // accumualtive variable holding the sum of a serie
     double arg;                 // accumulating variable holding the argument of a cosine
-    int i, j;                   // loop index variables
+    int i;                      // loop index variable
 
     for (i = 0, acc = 0.0; i < n; i++){
         // adding Delaunay arguments
-        for (j = D, arg = 0.0; j <= F; j++)
-            arg += multipliers[i * SERIE_A_TOTAL_MULTIPLIERS + j] * delaunay_arguments[j];
+        arg = serie_a_argument(delaunay_arguments, &multipliers[i * SERIE_A_TOTAL_MULTIPLIERS]);
 
         // converting argument from arcseconds to radians (π = 648000")
         arg *= M_PI / 648000.0;
@@ -62,19 +175,15 @@ double compute_serie_a_cos(double delaunay_arguments[], int multipliers[], doubl
     return acc;
 }
 
-double compute_serie_b(double precession, double delaunay_arguments[], int multipliers[], double coefficients[], int n)
+double compute_serie_b(double precession, const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n)
 {
     double acc;                 // accumualtive variable holding the sum of a serie
     double arg;                 // accumulating variable holding the argument of a sine
-    int i, j;                   // loop index variables
+    int i;                      // loop index variable
 
     for (i = 0, acc = 0.0; i < n; i++){
-        // adding precession argument
-        arg = multipliers[i * SERIE_B_TOTAL_MULTIPLIERS] * precession;
-
-        // adding Delaunay arguments
-        for (j = D; j <= F; j++)
-            arg += multipliers[i * SERIE_B_TOTAL_MULTIPLIERS + j + 1] * delaunay_arguments[j];
+        // adding precession and Delaunay arguments
+        arg = serie_b_argument(precession, delaunay_arguments, &multipliers[i * SERIE_B_TOTAL_MULTIPLIERS]);
 
         // adding phase to the value of the argument
         arg += coefficients[i * SERIE_B_TOTAL_COEFFICIENTS];
@@ -89,21 +198,15 @@ double compute_serie_b(double precession, double delaunay_arguments[], int multi
     return acc;
 }
 
-double compute_serie_c(double planetary_arguments[], double delaunay_arguments[], int multipliers[], double coefficients[], int n)
+double compute_serie_c(const double planetary_arguments[], const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n)
 {
-    double acc;             // accumualtive variable holding the sum of a serie
+    double acc;                 // accumualtive variable holding the sum of a serie
     double arg;                 // accumulating variable holding the argument of a sine
-    int i, j;                   // loop index variables
+    int i;                      // loop index variable
 
     for (i = 0, acc = 0.0; i < n; i++){
-        // adding planetary arguments from Mercury to Neptune
-        for (j = MERCURY, arg = 0.0; j <= NEPTUNE; j++)
-            arg += multipliers[i * SERIE_C_TOTAL_MULTIPLIERS + j] * planetary_arguments[j];
-
-        // adding Delaunay arguments except l' argument
-        arg += multipliers[i * SERIE_C_TOTAL_MULTIPLIERS + j + 1] * delaunay_arguments[D];
-        arg += multipliers[i * SERIE_C_TOTAL_MULTIPLIERS + j + 1] * delaunay_arguments[L];
-        arg += multipliers[i * SERIE_C_TOTAL_MULTIPLIERS + j + 1] * delaunay_arguments[F];
+        // adding planetary and Delaunay arguments
+        arg = serie_c_argument(planetary_arguments, delaunay_arguments, &multipliers[i * SERIE_C_TOTAL_MULTIPLIERS]);
 
         // adding phase to the value of the argument
         arg += coefficients[i * SERIE_C_TOTAL_COEFFICIENTS];
@@ -118,20 +221,15 @@ double compute_serie_c(double planetary_arguments[], double delaunay_arguments[]
     return acc;
 }
 
-double compute_serie_d(double planetary_arguments[], double delaunay_arguments[], int multipliers[], double coefficients[], int n)
+double compute_serie_d(const double planetary_arguments[], const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n)
 {
-    double acc;         // accumualtive variable holding the sum of a serie
-    double arg;             // accumulating variable holding the argument of a sine
-    int i, j;               // loop index variables
-
-    for (i = 0, acc=0.0; i < n; i++) {
-        // adding planetary arguments from Mercury to Uranus
-        for (j = MERCURY, arg = 0.0; j <= URANUS; j++)
-            arg += multipliers[i * SERIE_D_TOTAL_MULTIPLIERS + j] * planetary_arguments[j];
+    double acc;                 // accumualtive variable holding the sum of a serie
+    double arg;                 // accumulating variable holding the argument of a sine
+    int i;                      // loop index variable
 
-        // adding Delaunay arguments
-        for (j = D; j <= F; j++)
-            arg += multipliers[i * SERIE_D_TOTAL_MULTIPLIERS + TOTAL_PLANETARY_ARGUMENTS + j] * delaunay_arguments[j];
+    for (i = 0, acc = 0.0; i < n; i++){
+        // adding planetary and Delaunay arguments
+        arg = serie_d_argument(planetary_arguments, delaunay_arguments, &multipliers[i * SERIE_D_TOTAL_MULTIPLIERS]);
 
         // adding phase to the value of the argument
         arg += coefficients[i * SERIE_D_TOTAL_COEFFICIENTS];
@@ -145,3 +243,272 @@ double compute_serie_d(double planetary_arguments[], double delaunay_arguments[]
 
     return acc;
 }
+
+void compute_serie_arguments(double t, serie_arguments *arguments)
+{
+    compute_delaunay_arguments(t, FULL_SERIES_TOTAL_TERMS, arguments->delaunay);
+    compute_delaunay_arguments(t, LINEAR_SERIES_TOTAL_TERMS, arguments->reduced_delaunay);
+    arguments->precession = compute_precession_argument(t);
+    compute_planetary_arguments(t, arguments->planetary);
+}
+
+void compute_serie_argument_rates(double t, serie_arguments *rates)
+{
+    double elp2000[TOTAL_ELP2000_ARGUMENTS];        // rates of ELP2000 arguments
+    double tn;                                      // n-th power of t at n-th iteration of the loop
+    int i, j;                                       // loop index variables
+
+    // rates of the full arguments are derivatives of their polynomials
+    for (i = W1; i <= OBP; i++)
+        for (j = 1, elp2000[i] = 0.0, tn = 1.0; j < FULL_SERIES_TOTAL_TERMS; j++, tn *= t)
+            elp2000[i] += j * elp2000_arguments_coefficients[i * FULL_SERIES_TOTAL_TERMS + j] * tn;
+
+    // Delaunay arguments are combined the same way as in compute_delaunay_arguments, constants vanish
+    rates->delaunay[D] = elp2000[W1] - elp2000[T];
+    rates->delaunay[LP] = elp2000[T] - elp2000[OBP];
+    rates->delaunay[L] = elp2000[W1] - elp2000[W2];
+    rates->delaunay[F] = elp2000[W1] - elp2000[W3];
+
+    // rates of the arguments reduced to linear terms are constant
+    for (i = W1; i <= OBP; i++)
+        elp2000[i] = elp2000_arguments_coefficients[i * FULL_SERIES_TOTAL_TERMS + 1];
+    rates->reduced_delaunay[D] = elp2000[W1] - elp2000[T];
+    rates->reduced_delaunay[LP] = elp2000[T] - elp2000[OBP];
+    rates->reduced_delaunay[L] = elp2000[W1] - elp2000[W2];
+    rates->reduced_delaunay[F] = elp2000[W1] - elp2000[W3];
+    rates->precession = elp2000[W1] + precession_constant;
+
+    for (i = 0; i < TOTAL_PLANETARY_ARGUMENTS; i++)
+        rates->planetary[i] = planetary_arguments_coefficients[i * LINEAR_SERIES_TOTAL_TERMS + 1];
+}
+
+double compute_serie(const serie *s, const serie_arguments *arguments, int first, int n)
+{
+    // each type of series is computed with its own routine, the part of the serie is selected by offsetting arrays of
+    // multipliers and coefficients to the first term
+    switch (s->type){
+        case SERIE_A_SIN:
+            return compute_serie_a_sin(arguments->delaunay, s->multipliers + first * SERIE_A_TOTAL_MULTIPLIERS,
+                                       s->coefficients + first * SERIE_A_TOTAL_COEFFICIENTS, n);
+        case SERIE_A_COS:
+            return compute_serie_a_cos(arguments->delaunay, s->multipliers + first * SERIE_A_TOTAL_MULTIPLIERS,
+                                       s->coefficients + first * SERIE_A_TOTAL_COEFFICIENTS, n);
+        case SERIE_B:
+            return compute_serie_b(arguments->precession, arguments->reduced_delaunay,
+                                   s->multipliers + first * SERIE_B_TOTAL_MULTIPLIERS,
+                                   s->coefficients + first * SERIE_B_TOTAL_COEFFICIENTS, n);
+        case SERIE_C:
+            return compute_serie_c(arguments->planetary, arguments->reduced_delaunay,
+                                   s->multipliers + first * SERIE_C_TOTAL_MULTIPLIERS,
+                                   s->coefficients + first * SERIE_C_TOTAL_COEFFICIENTS, n);
+        case SERIE_D:
+            return compute_serie_d(arguments->planetary, arguments->reduced_delaunay,
+                                   s->multipliers + first * SERIE_D_TOTAL_MULTIPLIERS,
+                                   s->coefficients + first * SERIE_D_TOTAL_COEFFICIENTS, n);
+        default:
+            return 0.0;
+    }
+}
+
+double compute_serie_term_argument(const serie *s, const serie_arguments *arguments, int i)
+{
+    switch (s->type){
+        case SERIE_A_SIN:
+        case SERIE_A_COS:
+            return serie_a_argument(arguments->delaunay, &s->multipliers[i * SERIE_A_TOTAL_MULTIPLIERS]);
+        case SERIE_B:
+            return serie_b_argument(arguments->precession, arguments->reduced_delaunay,
+                                    &s->multipliers[i * SERIE_B_TOTAL_MULTIPLIERS]);
+        case SERIE_C:
+            return serie_c_argument(arguments->planetary, arguments->reduced_delaunay,
+                                    &s->multipliers[i * SERIE_C_TOTAL_MULTIPLIERS]);
+        case SERIE_D:
+            return serie_d_argument(arguments->planetary, arguments->reduced_delaunay,
+                                    &s->multipliers[i * SERIE_D_TOTAL_MULTIPLIERS]);
+        default:
+            return 0.0;
+    }
+}
+
+double serie_term_phase(const serie *s, int i)
+{
+    switch (s->type){
+        case SERIE_A_SIN:
+            return 0.0;
+        case SERIE_A_COS:
+            // cos(x) = sin(x + π/2) (π/2 = 324000")
+            return 324000.0;
+        case SERIE_B:
+            return s->coefficients[i * SERIE_B_TOTAL_COEFFICIENTS];
+        case SERIE_C:
+            return s->coefficients[i * SERIE_C_TOTAL_COEFFICIENTS];
+        case SERIE_D:
+            return s->coefficients[i * SERIE_D_TOTAL_COEFFICIENTS];
+        default:
+            return 0.0;
+    }
+}
+
+double serie_term_period(const serie *s, const serie_arguments *rates, int i)
+{
+    double rate;                // rate of the argument of the term, arcseconds per Julian century
+
+    // a full revolution (1296000") per rate gives the period in Julian centuries of 36525 days
+    rate = fabs(compute_serie_term_argument(s, rates, i));
+
+    return rate > 0.0 ? 1296000.0 * 36525.0 / rate : HUGE_VAL;
+}
+
+double serie_term_amplitude(const serie *s, int i)
+{
+    switch (s->type){
+        case SERIE_A_SIN:
+        case SERIE_A_COS:
+            return s->coefficients[i * SERIE_A_TOTAL_COEFFICIENTS];
+        case SERIE_B:
+            return s->coefficients[i * SERIE_B_TOTAL_COEFFICIENTS + 1];
+        case SERIE_C:
+            return s->coefficients[i * SERIE_C_TOTAL_COEFFICIENTS + 1];
+        case SERIE_D:
+            return s->coefficients[i * SERIE_D_TOTAL_COEFFICIENTS + 1];
+        default:
+            return 0.0;
+    }
+}
+
+void compute_serie_block(const serie *s, const serie_arguments arguments[], int m, double threshold, double sums[])
+{
+    const int *multipliers;     // multipliers of the current term
+    const double *coefficients; // coefficients of the current term
+    double arg;                 // argument of the current term
+    int i, k;                   // loop index variables
+
+    for (k = 0; k < m; k++)
+        sums[k] = 0.0;
+
+    // going through the terms of the serie once for all sets of arguments; the order of operations matches the one of
+    // the routines above, thus each sum equals to the one computed for a single set of arguments; terms with amplitudes
+    // below the threshold are skipped
+    switch (s->type){
+        case SERIE_A_SIN:
+        case SERIE_A_COS:
+            for (i = 0; i < s->n; i++){
+                multipliers = &s->multipliers[i * SERIE_A_TOTAL_MULTIPLIERS];
+                coefficients = &s->coefficients[i * SERIE_A_TOTAL_COEFFICIENTS];
+                if (fabs(coefficients[0]) < threshold)
+                    continue;
+                for (k = 0; k < m; k++){
+                    arg = serie_a_argument(arguments[k].delaunay, multipliers);
+                    arg *= M_PI / 648000.0;
+                    sums[k] += coefficients[0] * (s->type == SERIE_A_SIN ? sin(arg) : cos(arg));
+                }
+            }
+            break;
+        case SERIE_B:
+            for (i = 0; i < s->n; i++){
+                multipliers = &s->multipliers[i * SERIE_B_TOTAL_MULTIPLIERS];
+                coefficients = &s->coefficients[i * SERIE_B_TOTAL_COEFFICIENTS];
+                if (fabs(coefficients[1]) < threshold)
+                    continue;
+                for (k = 0; k < m; k++){
+                    arg = serie_b_argument(arguments[k].precession, arguments[k].reduced_delaunay, multipliers);
+                    arg += coefficients[0];
+                    arg *= M_PI / 648000.0;
+                    sums[k] += coefficients[1] * sin(arg);
+                }
+            }
+            break;
+        case SERIE_C:
+            for (i = 0; i < s->n; i++){
+                multipliers = &s->multipliers[i * SERIE_C_TOTAL_MULTIPLIERS];
+                coefficients = &s->coefficients[i * SERIE_C_TOTAL_COEFFICIENTS];
+                if (fabs(coefficients[1]) < threshold)
+                    continue;
+                for (k = 0; k < m; k++){
+                    arg = serie_c_argument(arguments[k].planetary, arguments[k].reduced_delaunay, multipliers);
+                    arg += coefficients[0];
+                    arg *= M_PI / 648000.0;
+                    sums[k] += coefficients[1] * sin(arg);
+                }
+            }
+            break;
+        case SERIE_D:
+            for (i = 0; i < s->n; i++){
+                multipliers = &s->multipliers[i * SERIE_D_TOTAL_MULTIPLIERS];
+                coefficients = &s->coefficients[i * SERIE_D_TOTAL_COEFFICIENTS];
+                if (fabs(coefficients[1]) < threshold)
+                    continue;
+                for (k = 0; k < m; k++){
+                    arg = serie_d_argument(arguments[k].planetary, arguments[k].reduced_delaunay, multipliers);
+                    arg += coefficients[0];
+                    arg *= M_PI / 648000.0;
+                    sums[k] += coefficients[1] * sin(arg);
+                }
+            }
+            break;
+    }
+}
+
+double compute_serie_sigma_partials(const serie *s, const serie_arguments *arguments, double derivatives[])
+{
+    double acc;                 // accumualtive variable holding the sum of a serie
+    double value;               // sine or cosine of the argument of a term
+    const double *coefficients; // coefficients of the current term
+    int i, j;                   // loop index variables
+
+    for (j = 0; j < TOTAL_SIGMA_CONSTANTS; j++)
+        derivatives[j] = 0.0;
+    if (s->type != SERIE_A_SIN && s->type != SERIE_A_COS)
+        return compute_serie(s, arguments, 0, s->n);
+
+    for (i = 0, acc = 0.0; i < s->n; i++){
+        // converting argument from arcseconds to radians (π = 648000")
+        value = serie_a_argument(arguments->delaunay, &s->multipliers[i * SERIE_A_TOTAL_MULTIPLIERS]);
+        value = s->type == SERIE_A_SIN ? sin(value * (M_PI / 648000.0)) : cos(value * (M_PI / 648000.0));
+
+        // the amplitude is followed by its derivatives
+        coefficients = &s->coefficients[i * SERIE_A_TOTAL_COEFFICIENTS];
+        acc += coefficients[0] * value;
+        for (j = 0; j < TOTAL_SIGMA_CONSTANTS; j++)
+            derivatives[j] += coefficients[j + 1] * value;
+    }
+
+    return acc;
+}
+
+double compute_serie_argument_partials(const serie *s, const serie_arguments *arguments, double derivatives[])
+{
+    double acc;                 // accumualtive variable holding the sum of a serie
+    double arg;                 // argument of the current term, radians
+    double amplitude;           // amplitude of the current term
+    double slope;               // derivative of the current term with respect to its argument, per arcsecond
+    double multipliers[TOTAL_DELAUNAY_ARGUMENTS + 1];   // multipliers of the arguments of the current term
+    int i, j;                   // loop index variables
+
+    for (j = 0; j <= TOTAL_DELAUNAY_ARGUMENTS; j++)
+        derivatives[j] = 0.0;
+
+    for (i = 0, acc = 0.0; i < s->n; i++){
+        // arguments are found and converted from arcseconds to radians (π = 648000") as the serie does, the phase of
+        // the cosine serie is not added to keep its values exact
+        arg = compute_serie_term_argument(s, arguments, i);
+        if (s->type != SERIE_A_SIN && s->type != SERIE_A_COS)
+            arg += serie_term_phase(s, i);
+        arg *= M_PI / 648000.0;
+        amplitude = serie_term_amplitude(s, i);
+
+        if (s->type == SERIE_A_COS){
+            acc += amplitude * cos(arg);
+            slope = -amplitude * sin(arg) * (M_PI / 648000.0);
+        } else {
+            acc += amplitude * sin(arg);
+            slope = amplitude * cos(arg) * (M_PI / 648000.0);
+        }
+
+        serie_term_argument_multipliers(s, i, multipliers);
+        for (j = 0; j <= TOTAL_DELAUNAY_ARGUMENTS; j++)
+            derivatives[j] += slope * multipliers[j];
+    }
+
+    return acc;
+}
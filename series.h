@@ -34,13 +34,67 @@
 #ifndef SERIES_H
 #define SERIES_H
 
+#include "arguments.h"
+
+/*
+ * Storage of the data arrays of the theory (see mainprob.h and the other data headers). In C the arrays are constant
+ * and local to the translation unit including them. In C++ they are constexpr, thus their values are known at compile
+ * time and may be used to generate code for particular series (see kernels.hpp).
+ */
+#ifdef __cplusplus
+#define ELP_DATA constexpr
+#else
+#define ELP_DATA static const
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOTAL_SIGMA_CONSTANTS 6         // amount of constants σ the amplitudes of the Main Problem are derived by
+
+/*
+ * An enumeration indexing types of the series of the ELP theory.
+ */
+enum Serie_types {
+    SERIE_A_SIN = 0,    // sine Fourier serie of the Main Problem
+    SERIE_A_COS = 1,    // cosine Fourier serie of the Main Problem
+    SERIE_B,            // Poisson serie of figures, relativistic, tidal and solar eccentricity perturbations
+    SERIE_C,            // Poisson serie of the first type of planetary perturbations
+    SERIE_D = 4         // Poisson serie of the second type of planetary perturbations
+};
+
+/*
+ * A datatype describing a single serie of the ELP theory: its type, the spherical coordinate it contributes to, the
+ * power of t the serie is multiplied by, its arrays of multipliers and coefficients and its size.
+ */
+typedef struct {
+    int type;                   // type of the serie (one of Serie_types)
+    int coordinate;             // spherical coordinate the serie contributes to (longitude, latitude or distance)
+    int power;                  // power of t the serie is multiplied by
+    const int *multipliers;     // array of multipliers
+    const double *coefficients; // array of coefficients
+    int n;                      // size of the serie
+} serie;
+
+/*
+ * A datatype holding all arguments needed to compute any serie of the ELP theory at a given time instant. All
+ * arguments are measured in arcseconds.
+ */
+typedef struct {
+    double delaunay[TOTAL_DELAUNAY_ARGUMENTS];          // Delaunay arguments (used by the Main Problem)
+    double reduced_delaunay[TOTAL_DELAUNAY_ARGUMENTS];  // Delaunay arguments reduced to linear terms
+    double precession;                                  // precession argument (ζ)
+    double planetary[TOTAL_PLANETARY_ARGUMENTS];        // planetary arguments
+} serie_arguments;
+
 /*
  * Computes a sine Fourier serie for the Main Problem of the ELP theory given the Delaunay arguments, array of
  * mutipliers, array of coefficients and the size of the serie.
  *
  * Source: Lunar Solution ELP 2000-82B. Explanatory note, p. 2
  */
-double compute_serie_a_sin(double delaunay_arguments[], int multipliers[], double coefficients[], int n);
+double compute_serie_a_sin(const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n);
 
 /*
  * Computes a cosine Fourier serie for the Main Problem of the ELP theory given the Delaunay arguments, array of
@@ -48,7 +102,7 @@ double compute_serie_a_sin(double delaunay_arguments[], int multipliers[], doubl
  *
  * Source: Lunar Solution ELP 2000-82B. Explanatory note, p. 2
  */
-double compute_serie_a_cos(double delaunay_arguments[], int multipliers[], double coefficients[], int n);
+double compute_serie_a_cos(const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n);
 
 /*
  * Computes a Poisson serie for either Earth figure perturbations, Moon figure perturbations, relativistic
@@ -57,7 +111,7 @@ double compute_serie_a_cos(double delaunay_arguments[], int multipliers[], doubl
  *
  * Source: Lunar Solution ELP 2000-82B. Explanatory note, p. 2
  */
-double compute_serie_b(double precession, double delaunay_arguments[], int multipliers[], double coefficients[], int n);
+double compute_serie_b(double precession, const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n);
 
 /*
  * Computes a Poisson serie for the first type of planetary perturbations of the ELP theory given planetary arguments,
@@ -65,7 +119,7 @@ double compute_serie_b(double precession, double delaunay_arguments[], int multi
  *
  * Source: Lunar Solution ELP 2000-82B. Explanatory note, p. 3
  */
-double compute_serie_c(double planetary_arguments[], double delaunay_arguments[], int multipliers[], double coefficients[], int n);
+double compute_serie_c(const double planetary_arguments[], const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n);
 
 /*
  * Computes a Poisson serie for the second type of planetary perturbations of the ELP theory given planetary arguments,
@@ -73,6 +127,78 @@ double compute_serie_c(double planetary_arguments[], double delaunay_arguments[]
  *
  * Source: Lunar Solution ELP 2000-82B. Explanatory note, p. 3
  */
-double compute_serie_d(double planetary_arguments[], double delaunay_arguments[], int multipliers[], double coefficients[], int n);
+double compute_serie_d(const double planetary_arguments[], const double delaunay_arguments[], const int multipliers[], const double coefficients[], int n);
+
+/*
+ * Computes all arguments needed to compute series of the ELP theory given time instant (t) measured in Julian
+ * centuries since the beginning of the epoch J2000.
+ */
+void compute_serie_arguments(double t, serie_arguments *arguments);
+
+/*
+ * Computes time derivatives of all arguments computed by compute_serie_arguments at time instant t, measured in
+ * arcseconds per Julian century.
+ */
+void compute_serie_argument_rates(double t, serie_arguments *rates);
+
+/*
+ * Computes a part of the given serie consisting of n terms starting from the term with index first. Arguments of the
+ * serie are to be computed beforehand. Computing a serie in parts and adding them together yields the value of the
+ * whole serie up to the rounding errors.
+ */
+double compute_serie(const serie *s, const serie_arguments *arguments, int first, int n);
+
+/*
+ * Computes the argument of the term with index i of the given serie, measured in arcseconds. Phase of the term is not
+ * included. The argument is a linear combination of the given arguments, thus given time derivatives of arguments
+ * instead, this routine computes the time derivative of the argument of the term.
+ */
+double compute_serie_term_argument(const serie *s, const serie_arguments *arguments, int i);
+
+/*
+ * Returns the phase of the term with index i of the given serie, measured in arcseconds. For the cosine serie of the
+ * Main Problem the phase is π/2, so that each term of any serie equals to Asin(argument + phase).
+ */
+double serie_term_phase(const serie *s, int i);
+
+/*
+ * Returns the period of the term with index i of the given serie in days, found from the given rates of the arguments
+ * (see compute_serie_argument_rates) rather than the approximate periods P of the data tables, or HUGE_VAL if the
+ * argument of the term is constant.
+ */
+double serie_term_period(const serie *s, const serie_arguments *rates, int i);
+
+/*
+ * Returns the amplitude (A) of the term with index i of the given serie.
+ */
+double serie_term_amplitude(const serie *s, int i);
+
+/*
+ * Computes the given serie for m sets of arguments at once, reading the arrays of the serie only once. Terms with
+ * absolute values of amplitudes less than the given threshold are skipped, zero threshold keeps all terms. Output is
+ * written into the given array of m sums; without skipped terms each of them equals to the value computed by
+ * compute_serie.
+ */
+void compute_serie_block(const serie *s, const serie_arguments arguments[], int m, double threshold, double sums[]);
+
+/*
+ * Computes the given serie the same way as compute_serie, writing its derivatives with respect to the constants σ₁ …
+ * σ₆ of the Main Problem (see mainprob.h) into the given array of TOTAL_SIGMA_CONSTANTS values. The sine or cosine of
+ * each term is shared by the value and all derivatives. Derivatives of series other than the Main Problem are zero.
+ */
+double compute_serie_sigma_partials(const serie *s, const serie_arguments *arguments, double derivatives[]);
+
+/*
+ * Computes the given serie the same way as compute_serie, writing its derivatives with respect to the arguments of the
+ * theory the serie uses into the given array of TOTAL_DELAUNAY_ARGUMENTS + 1 values: Delaunay arguments D, l', l and
+ * F (full for the Main Problem, reduced to linear terms otherwise) followed by the precession argument (ζ). Derivatives
+ * are measured in units of the serie per arcsecond. Each term contributes its amplitude times the derivative of its
+ * sine, scaled by the multipliers of the arguments exactly as the serie combines them.
+ */
+double compute_serie_argument_partials(const serie *s, const serie_arguments *arguments, double derivatives[]);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif // SERIES_H
\ No newline at end of file
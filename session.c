@@ -0,0 +1,286 @@
+/*
+ * session.c
+ */
+
+#include "session.h"
+#include "elp2000-82b.h"
+#include "theory.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define POLYNOMIAL_NODES (SESSION_POLYNOMIAL_DEGREE + 3)    // nodes interpolating folded terms, two for the estimate
+#define ENVELOPE_NODES (SESSION_ENVELOPE_DEGREE + 3)        // nodes interpolating envelopes, two for the estimate
+
+/*
+ * A datatype describing a term of the series while consolidating them.
+ */
+typedef struct {
+    double rate;                // frequency, radians per unit of scaled time
+    int serie;                  // index of the serie
+    int term;                   // index of the term within the serie
+} candidate;
+
+/*
+ * A datatype describing Chebyshev nodes of a span and the arguments of the series at them.
+ */
+typedef struct {
+    int n;                                          // amount of nodes
+    double x[POLYNOMIAL_NODES];                     // scaled time instants
+    double t[POLYNOMIAL_NODES];                     // time instants, Julian centuries since J2000
+    serie_arguments arguments[POLYNOMIAL_NODES];    // arguments of the series
+} node_set;
+
+/*
+ * Compares candidates by absolute values of their frequencies.
+ */
+static int compare_candidates(const void *a, const void *b)
+{
+    double ra = fabs(((const candidate *)a)->rate);   // frequency of the first candidate
+    double rb = fabs(((const candidate *)b)->rate);   // frequency of the second candidate
+
+    return ra < rb ? -1 : ra > rb ? 1 : 0;
+}
+
+/*
+ * Places n Chebyshev nodes over the span of a session and computes the arguments of the series at them.
+ */
+static void place_nodes(const elp_session *session, int n, node_set *nodes)
+{
+    int k;                      // loop index variable
+
+    nodes->n = n;
+    for (k = 0; k < n; k++){
+        nodes->x[k] = cos(M_PI * (k + 0.5) / n);
+        nodes->t[k] = 0.5 * (session->t0 + session->t1) + 0.5 * (session->t1 - session->t0) * nodes->x[k];
+        compute_serie_arguments(nodes->t[k], &nodes->arguments[k]);
+    }
+}
+
+/*
+ * Computes Chebyshev coefficients of the function of the given values at the nodes.
+ */
+static void interpolate(const node_set *nodes, const double values[], double coefficients[])
+{
+    int j, k;                   // loop index variables
+
+    for (j = 0; j < nodes->n; j++){
+        for (k = 0, coefficients[j] = 0.0; k < nodes->n; k++)
+            coefficients[j] += values[k] * cos(M_PI * j * (k + 0.5) / nodes->n);
+        coefficients[j] *= (j == 0 ? 1.0 : 2.0) / nodes->n;
+    }
+}
+
+/*
+ * Computes Chebyshev coefficients of the envelopes S and C of a term of the series relative to the frequency ω̄ ≥ 0:
+ * the term equals S(x)sin(ω̄x) + C(x)cos(ω̄x). The sign of the frequency of the term is given by the last argument.
+ * Returns the magnitude of the omitted coefficients, i.e. the estimate of the error of the envelopes.
+ */
+static double compute_envelopes(const node_set *nodes, const serie *s, int i, double rate, int sign,
+                                double sine[], double cosine[])
+{
+    double values_s[POLYNOMIAL_NODES], values_c[POLYNOMIAL_NODES];  // values of the envelopes at the nodes
+    double amplitude;                                               // amplitude of the term at a node
+    double psi;                                                     // argument of the envelopes at a node, radians
+    int j, k;                                                       // loop index variables
+
+    for (k = 0; k < nodes->n; k++){
+        for (j = 0, amplitude = serie_term_amplitude(s, i); j < s->power; j++)
+            amplitude *= nodes->t[k];
+        psi = (compute_serie_term_argument(s, &nodes->arguments[k], i) + serie_term_phase(s, i)) * (M_PI / 648000.0);
+        psi -= sign * rate * nodes->x[k];
+        values_s[k] = sign * amplitude * cos(psi);
+        values_c[k] = amplitude * sin(psi);
+    }
+    interpolate(nodes, values_s, sine);
+    interpolate(nodes, values_c, cosine);
+
+    return fabs(sine[nodes->n - 2]) + fabs(sine[nodes->n - 1]) + fabs(cosine[nodes->n - 2]) +
+           fabs(cosine[nodes->n - 1]);
+}
+
+/*
+ * Computes a Chebyshev series of the given degree at x by Clenshaw's recurrence.
+ */
+static double chebyshev_sum(const double coefficients[], int degree, double x)
+{
+    double b0, b1, b2;          // terms of the recurrence
+    int k;                      // loop index variable
+
+    for (k = degree, b1 = b2 = 0.0; k >= 1; k--){
+        b0 = 2.0 * x * b1 - b2 + coefficients[k];
+        b2 = b1;
+        b1 = b0;
+    }
+
+    return coefficients[0] + x * b1 - b2;
+}
+
+int elp_session_create(double t0, double t1, double tolerance, elp_session *session)
+{
+    node_set *polynomial_nodes;                         // nodes interpolating folded terms
+    node_set *envelope_nodes;                           // nodes interpolating envelopes
+    candidate *candidates;                              // terms of a coordinate
+    serie_arguments rates;                              // rates of the arguments at the middle of the span
+    double sine[POLYNOMIAL_NODES], cosine[POLYNOMIAL_NODES];    // coefficients of the envelopes of a term
+    double budget;                                      // share of the tolerance of a single term
+    double rate;                                        // frequency of the current consolidated term
+    double error;                                       // estimate of the error of the envelopes of a term
+    session_term *term;                                 // current consolidated term
+    session_exact_term *exact;                          // terms kept exact, once reallocated
+    int total;                                          // amount of terms of a coordinate
+    int sign;                                           // sign of the frequency of a term
+    int i, j, k, l;                                     // loop index variables
+
+    if (!(t1 > t0) || !(tolerance > 0.0))
+        return -1;
+
+    session->t0 = t0;
+    session->t1 = t1;
+    session->tolerance = tolerance;
+    session->n = session->kept = session->total = session->folded = 0;
+    for (i = 0, total = 0; i < TOTAL_ELP2000_SERIES; i++)
+        total += elp2000_series[i].n;
+
+    polynomial_nodes = malloc(sizeof(node_set));
+    envelope_nodes = malloc(sizeof(node_set));
+    candidates = malloc(sizeof(candidate) * total);
+    session->terms = malloc(sizeof(session_term) * total);
+    session->exact = malloc(sizeof(session_exact_term) * total);
+    if (polynomial_nodes == NULL || envelope_nodes == NULL || candidates == NULL || session->terms == NULL ||
+        session->exact == NULL){
+        free(polynomial_nodes);
+        free(envelope_nodes);
+        free(candidates);
+        free(session->terms);
+        free(session->exact);
+        session->terms = NULL;
+        session->exact = NULL;
+        return -1;
+    }
+
+    place_nodes(session, POLYNOMIAL_NODES, polynomial_nodes);
+    place_nodes(session, ENVELOPE_NODES, envelope_nodes);
+    compute_serie_argument_rates(0.5 * (t0 + t1), &rates);
+
+    for (l = 0; l < 3; l++){
+        // collecting terms of the coordinate with their frequencies, sorted by absolute values
+        for (i = 0, total = 0; i < TOTAL_ELP2000_SERIES; i++)
+            for (j = 0; elp2000_series[i].coordinate == l && j < elp2000_series[i].n; j++){
+                candidates[total].rate = compute_serie_term_argument(&elp2000_series[i], &rates, j) *
+                                         (0.5 * (t1 - t0) * M_PI / 648000.0);
+                candidates[total].serie = i;
+                candidates[total].term = j;
+                total++;
+            }
+        qsort(candidates, total, sizeof(candidate), compare_candidates);
+        session->total += total;
+        budget = tolerance / total;
+
+        for (k = 0; k <= SESSION_POLYNOMIAL_DEGREE; k++)
+            session->polynomials[l][k] = 0.0;
+
+        for (i = 0, term = NULL, rate = 0.0; i < total; i++){
+            sign = candidates[i].rate < 0.0 ? -1 : 1;
+
+            // folding terms of long periods into the polynomial, where the envelope C is the term itself
+            if (fabs(candidates[i].rate) < SESSION_POLYNOMIAL_DEGREE &&
+                compute_envelopes(polynomial_nodes, &elp2000_series[candidates[i].serie], candidates[i].term, 0.0,
+                                  sign, sine, cosine) <= budget){
+                for (k = 0; k <= SESSION_POLYNOMIAL_DEGREE; k++)
+                    session->polynomials[l][k] += cosine[k];
+                session->folded++;
+                continue;
+            }
+
+            // merging the term with the current consolidated one or starting a new one at its frequency, unless its
+            // envelopes do not fit even at its own frequency, in which case the term is kept exact
+            if (term == NULL || compute_envelopes(envelope_nodes, &elp2000_series[candidates[i].serie],
+                                                  candidates[i].term, rate, sign, sine, cosine) > budget){
+                error = compute_envelopes(envelope_nodes, &elp2000_series[candidates[i].serie], candidates[i].term,
+                                          fabs(candidates[i].rate), sign, sine, cosine);
+                if (error > budget){
+                    session->exact[session->kept].serie = candidates[i].serie;
+                    session->exact[session->kept].term = candidates[i].term;
+                    session->kept++;
+                    continue;
+                }
+                rate = fabs(candidates[i].rate);
+                term = &session->terms[session->n++];
+                term->rate = rate;
+                term->coordinate = l;
+                for (k = 0; k <= SESSION_ENVELOPE_DEGREE; k++)
+                    term->sine[k] = term->cosine[k] = 0.0;
+            }
+            for (k = 0; k <= SESSION_ENVELOPE_DEGREE; k++){
+                term->sine[k] += sine[k];
+                term->cosine[k] += cosine[k];
+            }
+        }
+    }
+
+    free(polynomial_nodes);
+    free(envelope_nodes);
+    free(candidates);
+
+    // releasing unused terms
+    term = realloc(session->terms, sizeof(session_term) * (session->n > 0 ? session->n : 1));
+    if (term != NULL)
+        session->terms = term;
+    exact = realloc(session->exact, sizeof(session_exact_term) * (session->kept > 0 ? session->kept : 1));
+    if (exact != NULL)
+        session->exact = exact;
+
+    return 0;
+}
+
+void elp_session_position(const elp_session *session, double t, int frame, double position[])
+{
+    double coordinates[TOTAL_SPHERICAL_COORDINATES];    // longitude, latitude and distance
+    double elp2000_arguments[TOTAL_ELP2000_ARGUMENTS];  // ELP2000 arguments
+    serie_arguments arguments;                          // arguments of the series, for terms kept exact
+    double x;                                           // scaled time
+    double value;                                       // value of a term kept exact
+    const session_term *term;                           // current term
+    const serie *s;                                     // serie of a term kept exact
+    int i, j, l;                                        // loop index variables
+
+    x = (2.0 * t - session->t0 - session->t1) / (session->t1 - session->t0);
+
+    for (l = 0; l < TOTAL_SPHERICAL_COORDINATES; l++)
+        coordinates[l] = chebyshev_sum(session->polynomials[l], SESSION_POLYNOMIAL_DEGREE, x);
+
+    for (i = 0; i < session->n; i++){
+        term = &session->terms[i];
+        coordinates[term->coordinate] += chebyshev_sum(term->sine, SESSION_ENVELOPE_DEGREE, x) * sin(term->rate * x) +
+                                         chebyshev_sum(term->cosine, SESSION_ENVELOPE_DEGREE, x) * cos(term->rate * x);
+    }
+
+    // computing terms kept exact from the series, each multiplied by its power of t
+    if (session->kept > 0)
+        compute_serie_arguments(t, &arguments);
+    for (i = 0; i < session->kept; i++){
+        s = &elp2000_series[session->exact[i].serie];
+        value = serie_term_amplitude(s, session->exact[i].term) *
+                sin((compute_serie_term_argument(s, &arguments, session->exact[i].term) +
+                     serie_term_phase(s, session->exact[i].term)) * (M_PI / 648000.0));
+        for (j = 0; j < s->power; j++)
+            value *= t;
+        coordinates[s->coordinate] += value;
+    }
+
+    // adding mean mean longitude of the Moon (W₁)
+    compute_elp2000_arguments(t, FULL_SERIES_TOTAL_TERMS, elp2000_arguments);
+    coordinates[LONGITUDE] += elp2000_arguments[W1];
+
+    refer_position_to_frame(t, coordinates, frame, position);
+}
+
+void elp_session_free(elp_session *session)
+{
+    free(session->terms);
+    free(session->exact);
+    session->terms = NULL;
+    session->exact = NULL;
+    session->n = session->kept = 0;
+}
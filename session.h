@@ -0,0 +1,96 @@
+/*
+ * session.h
+ *
+ * This file contains routines to specialize the series of the ELP theory for a fixed time span: a session holds a
+ * much smaller set of terms reproducing the theory within a tolerance over the span only.
+ *
+ * Within a span [t₀, t₁] of half-length h time is scaled to x ∈ [-1, 1], so that each term At^psin(φ(t)) becomes a
+ * sinusoid of frequency ω = hφ'(t_m), t_m being the middle of the span, modulated by a slowly varying envelope holding
+ * the secular factor t^p and the non linear part of the argument. Terms are consolidated per coordinate:
+ *      - terms of long periods (ω up to a few radians) are folded into a Chebyshev polynomial of degree
+ *        SESSION_POLYNOMIAL_DEGREE in x;
+ *      - the other terms are sorted by |ω| and terms of near-degenerate frequencies are merged into a single term
+ *
+ *                                  S(x)sin(ω̄x) + C(x)cos(ω̄x),
+ *
+ *        whose envelopes S and C are Chebyshev polynomials of degree SESSION_ENVELOPE_DEGREE. Terms of the series
+ *        multiplied by t and t² merge with the terms of equal frequencies of the other series, thus secular factors
+ *        are frozen into the envelopes and never computed while evaluating.
+ * Envelopes are found by interpolation at the Chebyshev nodes of the span. A term is folded or merged only if the
+ * magnitudes of the omitted Chebyshev coefficients of its contribution stay within its share of the tolerance (the
+ * tolerance divided by the amount of terms of the coordinate). Over long spans the envelope of a term may not fit even
+ * at its own frequency, as the non linear part of its argument and its secular factor vary too much; such a term is
+ * kept exact and computed from the series at each time instant. Thus a session agrees with the theory within the
+ * tolerance over any span, though it is slower the more terms are kept exact. Time instants outside the span are
+ * extrapolated and are not accurate.
+ *
+ * Frequencies are found from the arguments exactly as the series compute them rather than from approximate periods P
+ * of the tables, which do not match the arguments of some series.
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SESSION_POLYNOMIAL_DEGREE 16    // degree of polynomials holding folded terms
+#define SESSION_ENVELOPE_DEGREE 3       // degree of envelopes of merged terms
+
+/*
+ * A datatype describing a consolidated term of a session.
+ */
+typedef struct {
+    double rate;                                    // frequency ω̄ ≥ 0, radians per unit of scaled time
+    int coordinate;                                 // spherical coordinate the term contributes to
+    double sine[SESSION_ENVELOPE_DEGREE + 1];       // Chebyshev coefficients of the envelope S of sin(ω̄x)
+    double cosine[SESSION_ENVELOPE_DEGREE + 1];     // Chebyshev coefficients of the envelope C of cos(ω̄x)
+} session_term;
+
+/*
+ * A datatype describing a term of the series kept exact by a session.
+ */
+typedef struct {
+    int serie;                  // index of the serie (see elp2000_series)
+    int term;                   // index of the term within the serie
+} session_exact_term;
+
+/*
+ * A datatype describing a session: the theory specialized for a time span.
+ */
+typedef struct {
+    double t0, t1;                  // time span, Julian centuries since J2000
+    double tolerance;               // tolerance, arcseconds for angles and kilometers for distance
+    double polynomials[3][SESSION_POLYNOMIAL_DEGREE + 1];  // Chebyshev coefficients of folded terms per coordinate
+    session_term *terms;            // consolidated terms, sorted by coordinate
+    int n;                          // amount of consolidated terms
+    session_exact_term *exact;      // terms of the series kept exact
+    int kept;                       // amount of terms of the series kept exact
+    int total;                      // amount of terms of the series
+    int folded;                     // amount of terms of the series folded into the polynomials
+} elp_session;
+
+/*
+ * Creates a session reproducing the theory over the time span [t0, t1] (Julian centuries since J2000) within the
+ * given tolerance, measured in arcseconds for longitude and latitude and in kilometers for distance.
+ * Returns zero on success or a negative value if the arguments are invalid or memory could not be allocated.
+ */
+int elp_session_create(double t0, double t1, double tolerance, elp_session *session);
+
+/*
+ * Computes position of the Moon at time instant t (Julian centuries since J2000) in the given coordinates and reference
+ * frame (one of ELP_frames) from the terms of a session, writing it into the given array of three values.
+ */
+void elp_session_position(const elp_session *session, double t, int frame, double position[]);
+
+/*
+ * Releases terms of a session, consolidated and exact ones.
+ */
+void elp_session_free(elp_session *session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SESSION_H
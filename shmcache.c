@@ -0,0 +1,235 @@
+/*
+ * shmcache.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "shmcache.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * A datatype describing the header of a shared memory object, followed by the coefficients of the approximation.
+ * All fields but the sequence counter are written by the publisher while the counter is odd.
+ */
+typedef struct {
+    char magic[8];                  // SHM_CACHE_MAGIC
+    uint32_t version;               // SHM_CACHE_VERSION
+    uint32_t header_size;           // size of the header, bytes
+    _Atomic uint64_t sequence;      // sequence counter, odd while the object is written
+    int32_t frame;                  // coordinates and reference frame of positions (one of ELP_frames)
+    int32_t degree;                 // degree of the polynomials
+    int32_t granules;               // amount of granules
+    int32_t reserved;               // zero
+    double start;                   // beginning of the time span, Julian centuries since J2000
+    double granule;                 // length of a granule, Julian centuries
+    double tolerance;               // maximum approximation error in units of the coordinates of the frame
+    uint64_t coefficients_size;     // size of the coefficients, bytes
+} shared_header;
+
+/*
+ * A datatype describing the object the process is attached to.
+ */
+typedef struct {
+    const shared_header *header;    // mapped object
+    size_t size;                    // size of the mapping, bytes
+} shared_object;
+
+static shared_object *_Atomic attached;     // object the process is attached to, NULL if the process is detached
+
+int shm_cache_publish(const char *name, const chebyshev_ephemeris *ephemeris)
+{
+    shared_header *header;      // header of the mapped object
+    struct stat status;         // status of the object
+    size_t coefficients_size;   // size of the coefficients, bytes
+    size_t size;                // size of the object, bytes
+    uint64_t sequence;          // odd value of the sequence counter while the object is written
+    void *mapping;              // mapped object
+    int fd;                     // descriptor of the object
+
+    coefficients_size = sizeof(double) * 3 * (ephemeris->degree + 1) * (size_t)ephemeris->granules;
+    size = sizeof(shared_header) + coefficients_size;
+
+    if ((fd = shm_open(name, O_RDWR | O_CREAT, 0644)) < 0)
+        return -1;
+    if (fstat(fd, &status) < 0){
+        close(fd);
+        return -1;
+    }
+
+    // an object of another size is replaced rather than resized, since attached processes might touch pages beyond
+    // the end of a shrunk object
+    if (status.st_size != 0 && (size_t)status.st_size != size){
+        close(fd);
+        shm_unlink(name);
+        if ((fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644)) < 0)
+            return -1;
+        status.st_size = 0;
+    }
+    if (status.st_size == 0 && ftruncate(fd, size) < 0){
+        close(fd);
+        return -1;
+    }
+
+    mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return -1;
+
+    // the counter is made odd before anything is written and advanced to the next even value when everything is;
+    // a counter left odd by a publisher that died is taken over as it is
+    header = mapping;
+    sequence = atomic_load_explicit(&header->sequence, memory_order_relaxed) | 1;
+    atomic_store_explicit(&header->sequence, sequence, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    memcpy(header->magic, SHM_CACHE_MAGIC, sizeof(SHM_CACHE_MAGIC));
+    header->version = SHM_CACHE_VERSION;
+    header->header_size = sizeof(shared_header);
+    header->frame = ephemeris->frame;
+    header->degree = ephemeris->degree;
+    header->granules = ephemeris->granules;
+    header->reserved = 0;
+    header->start = ephemeris->start;
+    header->granule = ephemeris->granule;
+    header->tolerance = ephemeris->tolerance;
+    header->coefficients_size = coefficients_size;
+    memcpy(header + 1, ephemeris->coefficients, coefficients_size);
+
+    atomic_store_explicit(&header->sequence, sequence + 1, memory_order_release);
+    munmap(mapping, size);
+
+    return 0;
+}
+
+int shm_cache_remove(const char *name)
+{
+    return shm_unlink(name) < 0 ? -1 : 0;
+}
+
+int shm_cache_attach(const char *name)
+{
+    shared_object *object;      // object to attach to
+    shared_object *expected;    // expected state of the attached object
+    struct stat status;         // status of the object
+    void *mapping;              // mapped object
+    int fd;                     // descriptor of the object
+
+    if (atomic_load(&attached) != NULL)
+        return -1;
+    if ((fd = shm_open(name, O_RDONLY, 0)) < 0)
+        return -1;
+    if (fstat(fd, &status) < 0 || (size_t)status.st_size < sizeof(shared_header)){
+        close(fd);
+        return -1;
+    }
+
+    mapping = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return -1;
+
+    // the signature is written once with the first approximation and never changes later
+    object = malloc(sizeof(shared_object));
+    if (object == NULL || memcmp(((const shared_header *)mapping)->magic, SHM_CACHE_MAGIC,
+                                 sizeof(SHM_CACHE_MAGIC)) != 0){
+        free(object);
+        munmap(mapping, status.st_size);
+        return -1;
+    }
+    object->header = mapping;
+    object->size = status.st_size;
+
+    expected = NULL;
+    if (!atomic_compare_exchange_strong(&attached, &expected, object)){
+        munmap(mapping, status.st_size);
+        free(object);
+        return -1;
+    }
+
+    return 0;
+}
+
+void shm_cache_detach(void)
+{
+    shared_object *object = atomic_exchange(&attached, NULL);
+
+    if (object != NULL){
+        munmap((void *)object->header, object->size);
+        free(object);
+    }
+}
+
+int shm_cache_running(void)
+{
+    return atomic_load_explicit(&attached, memory_order_acquire) != NULL;
+}
+
+int shm_cache_position(double t, int frame, double position[], double velocity[], double error[])
+{
+    shared_object *object = atomic_load_explicit(&attached, memory_order_acquire);
+    double coefficients[3 * (CHEBYSHEV_MAX_DEGREE + 1)];   // coefficients of the granule covering t
+    chebyshev_ephemeris segment;    // approximation of the granule covering t
+    const shared_header *header;    // header of the object
+    uint64_t before, after;         // values of the sequence counter before and after copying
+    int covered;                    // non zero if the copied approximation covers the frame and t
+    int granules;                   // amount of granules of the copied approximation
+    int i;                          // index of the granule covering t
+    int attempt;                    // loop index variable
+
+    if (object == NULL)
+        return -1;
+    header = object->header;
+
+    for (attempt = 0; attempt < SHM_CACHE_RETRIES; attempt++){
+        if ((before = atomic_load_explicit(&header->sequence, memory_order_acquire)) & 1)
+            continue;
+
+        // fields are copied before they are checked, since they are valid only if the counter did not change; they
+        // are checked against the size of the mapping before the coefficients are copied, so that a torn copy cannot
+        // read beyond it
+        segment.granule = header->granule;
+        segment.degree = header->degree;
+        segment.frame = header->frame;
+        segment.start = header->start;
+        segment.tolerance = header->tolerance;
+        granules = header->granules;
+        covered = segment.frame == frame && segment.degree >= CHEBYSHEV_MIN_DEGREE &&
+                  segment.degree <= CHEBYSHEV_MAX_DEGREE && granules >= 1 && segment.granule > 0.0 &&
+                  sizeof(double) * 3 * (segment.degree + 1) * (size_t)granules <=
+                  object->size - sizeof(shared_header) &&
+                  t >= segment.start && t <= segment.start + granules * segment.granule;
+        if (covered){
+            i = (int)floor((t - segment.start) / segment.granule);
+            i = i < granules ? i : granules - 1;
+            memcpy(coefficients, (const double *)(header + 1) + i * 3 * (segment.degree + 1),
+                   sizeof(double) * 3 * (segment.degree + 1));
+            segment.start += i * segment.granule;
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&header->sequence, memory_order_relaxed);
+        if (before != after)
+            continue;
+        if (!covered)
+            return -1;
+
+        segment.granules = 1;
+        segment.coefficients = coefficients;
+        chebyshev_evaluate(&segment, t, position, velocity);
+        if (error != NULL)
+            chebyshev_residual(&segment, t, error);
+
+        return 0;
+    }
+
+    return -1;
+}
@@ -0,0 +1,80 @@
+/*
+ * shmcache.h
+ *
+ * This file contains routines to share Chebyshev approximations of positions of the Moon (see chebyshev.h) between
+ * processes of a host through a POSIX shared memory object, so that pre-forked workers evaluate positions from a
+ * single copy of the coefficients instead of warming caches of their own.
+ *
+ * A single process publishes an approximation into an object of the given name; any number of processes attach to the
+ * object and read it. The object starts with a header describing the approximation, followed by its coefficients. The
+ * header holds a sequence counter, which is odd while the object is written: readers copy the coefficients they need
+ * and accept the copy only if the counter was even and did not change meanwhile (seqlock), thus reading takes no locks
+ * and readers never block the publisher. The object lives until it is removed, independently of the processes that
+ * published or attached to it, so that restarted workers attach to the coefficients published before. Publishing an
+ * approximation of the same size replaces the coefficients in place; an approximation of another size is published
+ * into a new object under the same name, and processes attached to the old one keep reading it until they attach
+ * again.
+ *
+ * While a process is attached geocentric_moon_position and geocentric_moon_position_in_frame (as well as the routines
+ * built upon geocentric_moon_position) return positions computed from the shared approximation for time instants and
+ * the frame it covers, falling back to other caches or the series otherwise. Batch and parallel routines always compute
+ * the series.
+ */
+
+#ifndef SHMCACHE_H
+#define SHMCACHE_H
+
+#include "chebyshev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHM_CACHE_MAGIC "ELPSHM"        // signature of the shared objects, followed by zero bytes
+#define SHM_CACHE_VERSION 1             // version of the layout of the shared objects
+#define SHM_CACHE_RETRIES 64            // amount of attempts to read a consistent copy while the object is written
+
+/*
+ * Publishes the given approximation into the shared memory object of the given name (starting with a slash, see
+ * shm_open), creating the object if needed. Only one process may publish into an object at a time.
+ * Returns zero on success or a negative value if the object could not be created, resized or mapped.
+ */
+int shm_cache_publish(const char *name, const chebyshev_ephemeris *ephemeris);
+
+/*
+ * Removes the shared memory object of the given name. Processes attached to it keep reading it until they detach.
+ * Returns zero on success or a negative value on failure.
+ */
+int shm_cache_remove(const char *name);
+
+/*
+ * Attaches the process to the shared memory object of the given name, mapping it read only.
+ * Returns zero on success or a negative value if the process is already attached, or the object does not exist or is
+ * not a shared approximation.
+ */
+int shm_cache_attach(const char *name);
+
+/*
+ * Detaches the process from the shared memory object. Must not be called while other threads query positions.
+ */
+void shm_cache_detach(void);
+
+/*
+ * Returns non zero if the process is attached to a shared memory object.
+ */
+int shm_cache_running(void);
+
+/*
+ * Computes position of the Moon at time instant t in the given frame (one of ELP_frames) and its velocity, measured in
+ * units of the coordinates per Julian century, from the shared approximation, and the estimate of its error at t (see
+ * chebyshev_residual). Velocity and error may be NULL.
+ * Returns zero on success or a negative value if the process is not attached, the approximation does not cover the
+ * frame or t, or no consistent copy could be read because the approximation is being published.
+ */
+int shm_cache_position(double t, int frame, double position[], double velocity[], double error[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SHMCACHE_H
@@ -0,0 +1,160 @@
+/*
+ * spk.c
+ */
+
+#include "spk.h"
+#include "elp2000-82b.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DAF_RECORD_WORDS 128            // amount of double precision words of a DAF record
+#define DAF_RECORD_SIZE 1024            // size of a DAF record, bytes
+#define SPK_DOUBLE_COMPONENTS 2         // amount of double precision components of an SPK segment summary (ND)
+#define SPK_INTEGER_COMPONENTS 6        // amount of integer components of an SPK segment summary (NI)
+#define SPK_SUMMARY_RECORD 2            // record holding the summary of the segment
+#define SPK_NAME_RECORD 3               // record holding the name of the segment
+#define SPK_DATA_RECORD 4               // first record holding data of the segment
+#define SECONDS_PER_CENTURY 3155760000.0    // length of a Julian century, measured in seconds
+
+// string detecting transfers of the file in text mode, fixed by the DAF specification
+static const char ftp_string[28] = "FTPSTR:\r:\n:\r\n:\r\x00:\x81:\x10\xce:ENDFTP";
+
+/*
+ * Writes a string into a field of the given size, padding it with blanks.
+ */
+static void write_field(char field[], const char *text, size_t size)
+{
+    size_t n = strlen(text) < size ? strlen(text) : size;
+
+    memset(field, ' ', size);
+    memcpy(field, text, n);
+}
+
+/*
+ * Computes coefficients of the derivative of a Chebyshev series of degree n with the given coefficients with respect to
+ * the scaled time x, given by the recurrence c'ₖ₋₁ = c'ₖ₊₁ + 2kcₖ. The derivative has degree n - 1, its coefficient of
+ * degree n is set to zero. Degree n must be positive.
+ */
+static void differentiate(const double c[], int n, double derivative[])
+{
+    int k;                      // loop index variable
+
+    derivative[n] = 0.0;
+    derivative[n - 1] = 2.0 * n * c[n];
+    for (k = n - 1; k >= 1; k--)
+        derivative[k - 1] = derivative[k + 1] + 2.0 * k * c[k];
+    derivative[0] *= 0.5;
+}
+
+int spk_write(const char *path, const chebyshev_ephemeris *ephemeris, int type)
+{
+    double words[DAF_RECORD_WORDS];         // current record of the file
+    char *record = (char *)words;           // current record of the file as characters
+    int32_t integers[SPK_INTEGER_COMPONENTS];
+    double *data;                           // data of a single record of the segment
+    double radius;                          // half of the length of a record, seconds
+    double scale;                           // scale of velocities, from km per scaled time to km per second
+    uint16_t probe = 1;                     // value detecting the byte order of the system
+    int n;                                  // amount of coefficients of each coordinate
+    int size;                               // size of a record of the segment, words
+    int first, last;                        // word addresses of the first and the last words of the segment
+    int i, k, l;                            // loop index variables
+    long total;                             // total amount of words of the segment
+    FILE *file;                             // output file
+    int failed;                             // non zero if writing failed
+
+    if (type != SPK_CHEBYSHEV_POSITION && type != SPK_CHEBYSHEV_POSITION_VELOCITY)
+        return -1;
+    if (ephemeris->frame != J2000_CARTESIAN && ephemeris->frame != FK5_CARTESIAN)
+        return -1;
+
+    n = ephemeris->degree + 1;
+    size = 2 + (type == SPK_CHEBYSHEV_POSITION ? 3 : 6) * n;
+    total = (long)size * ephemeris->granules + 4;
+    first = (SPK_DATA_RECORD - 1) * DAF_RECORD_WORDS + 1;
+    if (total > 2147483647L - first)
+        return -1;
+    last = first + total - 1;
+    radius = 0.5 * ephemeris->granule * SECONDS_PER_CENTURY;
+    scale = 1.0 / radius;
+
+    if ((file = fopen(path, "wb")) == NULL)
+        return -1;
+    if ((data = malloc(sizeof(double) * size)) == NULL){
+        fclose(file);
+        return -1;
+    }
+
+    // file record
+    memset(record, 0, DAF_RECORD_SIZE);
+    memcpy(record, "DAF/SPK ", 8);
+    integers[0] = SPK_DOUBLE_COMPONENTS;
+    integers[1] = SPK_INTEGER_COMPONENTS;
+    memcpy(record + 8, integers, 8);
+    write_field(record + 16, "ELP 2000-82B", 60);
+    integers[0] = SPK_SUMMARY_RECORD;           // first summary record
+    integers[1] = SPK_SUMMARY_RECORD;           // last summary record
+    integers[2] = last + 1;                     // first free word address
+    memcpy(record + 76, integers, 12);
+    memcpy(record + 88, *(uint8_t *)&probe == 1 ? "LTL-IEEE" : "BIG-IEEE", 8);
+    memcpy(record + 699, ftp_string, sizeof(ftp_string));
+    failed = fwrite(record, DAF_RECORD_SIZE, 1, file) != 1;
+
+    // summary record: next and previous summary records, amount of summaries and the summary of the segment
+    memset(record, 0, DAF_RECORD_SIZE);
+    words[0] = 0.0;
+    words[1] = 0.0;
+    words[2] = 1.0;
+    words[3] = ephemeris->start * SECONDS_PER_CENTURY;
+    words[4] = (ephemeris->start + ephemeris->granules * ephemeris->granule) * SECONDS_PER_CENTURY;
+    integers[0] = SPK_MOON;
+    integers[1] = SPK_EARTH;
+    integers[2] = ephemeris->frame == FK5_CARTESIAN ? SPK_J2000 : SPK_ECLIPJ2000;
+    integers[3] = type;
+    integers[4] = first;
+    integers[5] = last;
+    memcpy(&words[5], integers, sizeof(integers));
+    failed = failed || fwrite(record, DAF_RECORD_SIZE, 1, file) != 1;
+
+    // name record
+    memset(record, ' ', DAF_RECORD_SIZE);
+    write_field(record, "ELP 2000-82B MOON", 8 * (SPK_DOUBLE_COMPONENTS + (SPK_INTEGER_COMPONENTS + 1) / 2));
+    failed = failed || fwrite(record, DAF_RECORD_SIZE, 1, file) != 1;
+
+    // data of the segment: a record per granule holding its midpoint, radius and coefficients of each coordinate,
+    // followed by the directory: initial epoch, length of the interval, size of a record and amount of records
+    for (i = 0; i < ephemeris->granules && !failed; i++){
+        const double *c = &ephemeris->coefficients[i * 3 * n];
+
+        data[0] = (ephemeris->start + (i + 0.5) * ephemeris->granule) * SECONDS_PER_CENTURY;
+        data[1] = radius;
+        for (l = 0; l < 3; l++)
+            for (k = 0; k < n; k++)
+                data[2 + l * n + k] = c[k * 3 + l];
+        if (type == SPK_CHEBYSHEV_POSITION_VELOCITY)
+            for (l = 0; l < 3; l++){
+                differentiate(&data[2 + l * n], ephemeris->degree, &data[2 + (3 + l) * n]);
+                for (k = 0; k < n; k++)
+                    data[2 + (3 + l) * n + k] *= scale;
+            }
+        failed = fwrite(data, sizeof(double), size, file) != (size_t)size;
+    }
+    data[0] = ephemeris->start * SECONDS_PER_CENTURY;
+    data[1] = 2.0 * radius;
+    data[2] = size;
+    data[3] = ephemeris->granules;
+    failed = failed || fwrite(data, sizeof(double), 4, file) != 4;
+
+    // padding the last record
+    memset(record, 0, DAF_RECORD_SIZE);
+    k = (DAF_RECORD_WORDS - total % DAF_RECORD_WORDS) % DAF_RECORD_WORDS;
+    failed = failed || fwrite(record, sizeof(double), k, file) != (size_t)k;
+
+    free(data);
+    failed = fclose(file) != 0 || failed;
+
+    return failed ? -1 : 0;
+}
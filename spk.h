@@ -0,0 +1,51 @@
+/*
+ * spk.h
+ *
+ * This file contains routines to export Chebyshev approximations of positions of the Moon (see chebyshev.h) as SPICE
+ * SPK kernels, so that tools reading SPK files compute ELP 2000-82B positions without the series.
+ *
+ * A kernel is a DAF file holding a single segment of type 2 (Chebyshev polynomials of position) or type 3 (Chebyshev
+ * polynomials of position and velocity) for the Moon (NAIF code 301) relative to the Earth (399). Approximations in
+ * rectangular coordinates referred to the FK5 equator are stored in the J2000 frame (1), those referred to the mean
+ * ecliptic and equinox of J2000 in the ECLIPJ2000 frame (17). Granules of the approximation become records of the
+ * segment as they are: both use Chebyshev polynomials of time scaled to [-1, 1] within each record. Time is measured in
+ * seconds of TDB since J2000 and positions in kilometers, velocities in kilometers per second.
+ *
+ * Source: NAIF. DAF Required Reading; SPK Required Reading.
+ */
+
+#ifndef SPK_H
+#define SPK_H
+
+#include "chebyshev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPK_MOON 301                    // NAIF code of the Moon
+#define SPK_EARTH 399                   // NAIF code of the Earth
+#define SPK_J2000 1                     // NAIF code of the J2000 frame (FK5 equator)
+#define SPK_ECLIPJ2000 17               // NAIF code of the ECLIPJ2000 frame (mean ecliptic and equinox of J2000)
+
+/*
+ * An enumeration of segment types written by spk_write.
+ */
+enum SPK_types {
+    SPK_CHEBYSHEV_POSITION = 2,             // type 2: Chebyshev polynomials of position
+    SPK_CHEBYSHEV_POSITION_VELOCITY = 3     // type 3: Chebyshev polynomials of position and velocity
+};
+
+/*
+ * Writes the given approximation, which must be in J2000_CARTESIAN or FK5_CARTESIAN frame, into an SPK file with the
+ * given path as a single segment of the given type (one of SPK_types). Velocity polynomials of type 3 segments are
+ * derivatives of position polynomials.
+ * Returns zero on success or a negative value if the frame or type is not supported or the file could not be written.
+ */
+int spk_write(const char *path, const chebyshev_ephemeris *ephemeris, int type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPK_H
@@ -0,0 +1,231 @@
+/*
+ * statefile.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "statefile.h"
+#include "autotune.h"
+#include "chebfile.h"
+#include "elp2000-82b.h"
+#include "taylor.h"
+#include "threadpool.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * A datatype holding the context of a block of epochs computed by the pool of threads.
+ */
+typedef struct {
+    int frame;                  // reference frame of the file
+    double *const *columns;     // mapped columns
+    int64_t first;              // first epoch of the block
+    int n;                      // amount of epochs of the block
+} state_block;
+
+static pthread_once_t pool_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Starts the pool of threads the same way the batch routines do, unless it was started by the user.
+ */
+static void start_pool(void)
+{
+    if (thread_pool_size() == 0)
+        thread_pool_start_from_environment(elp_tuning_current()->threads);
+}
+
+/*
+ * Computes a chunk of a block: state vectors at up to STATE_FILE_TASK_EPOCHS consecutive epochs from the series, as
+ * Taylor polynomials of the first order, whose coefficients are the position and the velocity.
+ */
+static void compute_block_chunk(void *context, int index)
+{
+    const state_block *block = context;
+    double coefficients[6];     // coefficients of the Taylor polynomials
+    int64_t e;                  // current epoch
+    int i, k;                   // loop index variables
+
+    for (i = index * STATE_FILE_TASK_EPOCHS; i < block->n && i < (index + 1) * STATE_FILE_TASK_EPOCHS; i++){
+        e = block->first + i;
+        geocentric_moon_taylor(block->columns[STATE_T][e], 1, block->frame, coefficients);
+        for (k = 0; k < 3; k++){
+            block->columns[STATE_X + k][e] = coefficients[k];
+            block->columns[STATE_VX + k][e] = coefficients[3 + k];
+        }
+    }
+}
+
+/*
+ * Computes state vectors at n epochs starting with the given one, storing them into the given columns at the given
+ * index.
+ */
+static void compute_block(const state_file_header *header, const chebyshev_ephemeris *source, double *columns[],
+                          int64_t first, int n)
+{
+    state_block block;                  // context of the block computed by the pool
+    double position[3], velocity[3];    // state vector computed from an approximation
+    int i, k;                           // loop index variables
+
+    for (i = 0; i < n; i++)
+        columns[STATE_T][first + i] = header->start + (first + i) * header->step;
+
+    if (source != NULL){
+        for (i = 0; i < n; i++){
+            chebyshev_evaluate(source, columns[STATE_T][first + i], position, velocity);
+            for (k = 0; k < 3; k++){
+                columns[STATE_X + k][first + i] = position[k];
+                columns[STATE_VX + k][first + i] = velocity[k];
+            }
+        }
+        return;
+    }
+
+    // velocities are derivatives of the series found term by term together with positions, which costs about two
+    // positions rather than the five of numerical differentiation
+    block.frame = header->frame;
+    block.columns = columns;
+    block.first = first;
+    block.n = n;
+    thread_pool_run(compute_block_chunk, &block, (n + STATE_FILE_TASK_EPOCHS - 1) / STATE_FILE_TASK_EPOCHS);
+}
+
+int state_file_write(const char *path, double start, double step, int64_t epochs, int frame,
+                     const chebyshev_ephemeris *source)
+{
+    state_file_header header;           // header of the file
+    double *columns[TOTAL_STATE_COLUMNS];   // mapped columns
+    uint64_t column_size;               // size of a column including its padding, bytes
+    uint64_t size;                      // size of the file, bytes
+    int64_t first;                      // first epoch of the current block
+    char *temporary;                    // temporary name of the file
+    void *mapping;                      // mapped file
+    int fd;                             // descriptor of the file
+    int n;                              // amount of epochs of the current block
+    int k;                              // loop index variable
+    int failed;                         // non zero if writing failed
+
+    if (epochs < 1 || !(step > 0.0) || frame < 0 || frame >= TOTAL_ELP_FRAMES ||
+        (source != NULL && source->frame != frame) || (uint64_t)epochs > UINT64_MAX / 8 / (TOTAL_STATE_COLUMNS + 1))
+        return STATE_FILE_FORMAT_ERROR;
+
+    column_size = (sizeof(double) * epochs + STATE_FILE_ALIGNMENT - 1) / STATE_FILE_ALIGNMENT * STATE_FILE_ALIGNMENT;
+    size = STATE_FILE_ALIGNMENT + TOTAL_STATE_COLUMNS * column_size;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STATE_FILE_MAGIC, sizeof(STATE_FILE_MAGIC));
+    header.byte_order = STATE_FILE_BYTE_ORDER;
+    header.version = STATE_FILE_VERSION;
+    header.header_size = sizeof(header);
+    header.frame = frame;
+    header.epochs = epochs;
+    header.start = start;
+    header.step = step;
+    for (k = 0; k < TOTAL_STATE_COLUMNS; k++)
+        header.columns[k] = STATE_FILE_ALIGNMENT + k * column_size;
+    header.header_checksum = chebyshev_file_checksum(&header, offsetof(state_file_header, header_checksum));
+
+    if (source == NULL)
+        pthread_once(&pool_once, start_pool);
+    if ((fd = chebyshev_file_create_temporary(path, &temporary)) < 0)
+        return STATE_FILE_IO_ERROR;
+
+    // space of the whole file is allocated beforehand, so that running out of it is reported here rather than by a
+    // signal while writing into the mapping
+    failed = posix_fallocate(fd, 0, size) != 0;
+    mapping = failed ? MAP_FAILED : mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    failed = failed || mapping == MAP_FAILED;
+
+    if (!failed){
+        memcpy(mapping, &header, sizeof(header));
+        for (k = 0; k < TOTAL_STATE_COLUMNS; k++)
+            columns[k] = (double *)((char *)mapping + header.columns[k]);
+
+        for (first = 0; first < epochs; first += n){
+            n = epochs - first < STATE_FILE_BLOCK_EPOCHS ? epochs - first : STATE_FILE_BLOCK_EPOCHS;
+            compute_block(&header, source, columns, first, n);
+        }
+
+        failed = msync(mapping, size, MS_SYNC) < 0;
+        munmap(mapping, size);
+    }
+    failed = close(fd) < 0 || failed;
+
+    // publishing the complete file under its name
+    if (!failed)
+        failed = rename(temporary, path);
+    if (failed)
+        unlink(temporary);
+
+    free(temporary);
+
+    return failed ? STATE_FILE_IO_ERROR : 0;
+}
+
+int state_file_map(const char *path, state_file *file)
+{
+    const state_file_header *header;    // header of the mapped file
+    struct stat status;                 // status of the file
+    void *mapping;                      // mapped file
+    int fd;                             // descriptor of the file
+    int error;                          // error found in the header
+    int k;                              // loop index variable
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return STATE_FILE_IO_ERROR;
+    if (fstat(fd, &status) < 0){
+        close(fd);
+        return STATE_FILE_IO_ERROR;
+    }
+    if ((size_t)status.st_size < sizeof(state_file_header)){
+        close(fd);
+        return STATE_FILE_FORMAT_ERROR;
+    }
+
+    mapping = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return STATE_FILE_IO_ERROR;
+
+    header = mapping;
+    error = 0;
+    if (memcmp(header->magic, STATE_FILE_MAGIC, sizeof(STATE_FILE_MAGIC)) != 0)
+        error = STATE_FILE_FORMAT_ERROR;
+    else if (header->byte_order != STATE_FILE_BYTE_ORDER)
+        error = STATE_FILE_BYTE_ORDER_ERROR;
+    else if (header->version != STATE_FILE_VERSION || header->header_size != sizeof(state_file_header))
+        error = STATE_FILE_VERSION_ERROR;
+    else if (header->header_checksum != chebyshev_file_checksum(header, offsetof(state_file_header, header_checksum)))
+        error = STATE_FILE_CHECKSUM_ERROR;
+    else if (header->frame < 0 || header->frame >= TOTAL_ELP_FRAMES || header->epochs < 1 ||
+             (uint64_t)header->epochs > (uint64_t)status.st_size / sizeof(double))
+        error = STATE_FILE_FORMAT_ERROR;
+    for (k = 0; k < TOTAL_STATE_COLUMNS && !error; k++)
+        if (header->columns[k] % sizeof(double) != 0 || header->columns[k] > (uint64_t)status.st_size ||
+            ((uint64_t)status.st_size - header->columns[k]) / sizeof(double) < (uint64_t)header->epochs)
+            error = STATE_FILE_FORMAT_ERROR;
+
+    if (error){
+        munmap(mapping, status.st_size);
+        return error;
+    }
+
+    file->header = header;
+    file->size = status.st_size;
+    for (k = 0; k < TOTAL_STATE_COLUMNS; k++)
+        file->columns[k] = (const double *)((const char *)mapping + header->columns[k]);
+
+    return 0;
+}
+
+void state_file_unmap(state_file *file)
+{
+    munmap((void *)file->header, file->size);
+    file->header = NULL;
+}
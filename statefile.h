@@ -0,0 +1,113 @@
+/*
+ * statefile.h
+ *
+ * This file contains routines to generate large files of state vectors of the Moon (positions and velocities at
+ * equally spaced epochs) and to map them into memory, so that readers use the values in place.
+ *
+ * The file is sized for all epochs before anything is computed and mapped into memory; blocks of epochs are computed
+ * by the pool of threads and stored straight into the mapping, thus values are never copied through stdio buffers and
+ * the system writes the pages back in large chunks. Values are laid out in columns: time instants, three coordinates
+ * of positions and three coordinates of velocities, each column being a contiguous array of doubles starting at an
+ * offset aligned to STATE_FILE_ALIGNMENT bytes. A header of fixed layout at the beginning of the file holds the offsets
+ * of the columns. Values are stored in the byte order of the writer, which is tagged in the header.
+ */
+
+#ifndef STATEFILE_H
+#define STATEFILE_H
+
+#include "chebyshev.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STATE_FILE_MAGIC "ELPSTAT"              // signature of the files, followed by a zero byte
+#define STATE_FILE_VERSION 1                    // version of the layout of the files
+#define STATE_FILE_BYTE_ORDER 0x01020304        // tag of the byte order, read back as 0x04030201 on foreign systems
+#define STATE_FILE_ALIGNMENT 65536              // alignment of the columns, bytes
+#define STATE_FILE_BLOCK_EPOCHS 4096            // amount of epochs computed at once
+#define STATE_FILE_TASK_EPOCHS 16               // amount of epochs of a block computed by a single task of the pool
+
+/*
+ * An enumeration of the columns of a file.
+ */
+enum State_columns {
+    STATE_T = 0,                // time instants, Julian centuries since J2000
+    STATE_X = 1,                // first coordinate of positions
+    STATE_Y = 2,                // second coordinate of positions
+    STATE_Z = 3,                // third coordinate of positions
+    STATE_VX = 4,               // first coordinate of velocities, units of the coordinate per Julian century
+    STATE_VY = 5,               // second coordinate of velocities, units of the coordinate per Julian century
+    STATE_VZ = 6,               // third coordinate of velocities, units of the coordinate per Julian century
+    TOTAL_STATE_COLUMNS = 7
+};
+
+/*
+ * An enumeration of errors of the routines handling files.
+ */
+enum State_file_errors {
+    STATE_FILE_IO_ERROR = -1,           // file could not be opened, sized, written or mapped
+    STATE_FILE_FORMAT_ERROR = -2,       // file is not a state file, is truncated or the arguments are invalid
+    STATE_FILE_VERSION_ERROR = -3,      // file has unsupported version
+    STATE_FILE_BYTE_ORDER_ERROR = -4,   // file was written on a system of the other byte order
+    STATE_FILE_CHECKSUM_ERROR = -5      // header of the file is corrupted
+};
+
+/*
+ * A datatype describing the header of a file.
+ */
+typedef struct {
+    char magic[8];                  // STATE_FILE_MAGIC
+    uint32_t byte_order;            // STATE_FILE_BYTE_ORDER
+    uint32_t version;               // STATE_FILE_VERSION
+    uint32_t header_size;           // size of the header, bytes
+    int32_t frame;                  // coordinates and reference frame of positions (one of ELP_frames)
+    int64_t epochs;                 // amount of epochs
+    double start;                   // first epoch, Julian centuries since J2000
+    double step;                    // interval between epochs, Julian centuries
+    uint64_t columns[TOTAL_STATE_COLUMNS];  // offsets of the columns from the beginning of the file, bytes
+    uint64_t header_checksum;       // checksum of all the previous fields of the header
+} state_file_header;
+
+/*
+ * A datatype describing a mapped file: its header, the mapped columns and the size of the mapping.
+ */
+typedef struct {
+    const state_file_header *header;                // header of the file
+    const double *columns[TOTAL_STATE_COLUMNS];     // columns of the file
+    size_t size;                                    // size of the mapping, bytes
+} state_file;
+
+/*
+ * Writes state vectors of the Moon in the given frame at the given amount of epochs start + i·step (Julian centuries
+ * since J2000) into a file with the given path. Velocities are measured in units of the coordinates of the frame per
+ * Julian century (arcseconds or kilometers per Julian century). State vectors are computed from the given Chebyshev
+ * approximation, which must be of the same frame and cover the epochs, or, if it is NULL, from the series expanded
+ * into Taylor polynomials of the first order at each epoch (see geocentric_moon_taylor), whose coefficients are the
+ * position and its exact derivative; epochs are spread over the pool of threads (see threadpool.h), started the same
+ * way as by the batch routines unless it is running. Positions agree with geocentric_moon_positions within
+ * rounding. The file is written under a temporary name and renamed when complete.
+ * Returns zero on success or one of State_file_errors.
+ */
+int state_file_write(const char *path, double start, double step, int64_t epochs, int frame,
+                     const chebyshev_ephemeris *source);
+
+/*
+ * Maps the file with the given path into memory, read only and shared with other processes, and checks its header.
+ * Returns zero on success or one of State_file_errors.
+ */
+int state_file_map(const char *path, state_file *file);
+
+/*
+ * Unmaps a mapped file.
+ */
+void state_file_unmap(state_file *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STATEFILE_H
@@ -0,0 +1,427 @@
+/*
+ * taylor.c
+ */
+
+#include "taylor.h"
+#include "elp2000-82b.h"
+#include "frames.h"
+#include "theory.h"
+
+#include <math.h>
+#include <stddef.h>
+
+#define ARGUMENT_DEGREE 4               // degree of polynomials of the arguments of the Main Problem
+#define MINIMUM_DISTANCE 350000.0       // bound of the distance of the Moon from below, kilometers
+#define MAXIMUM_DISTANCE 410000.0       // bound of the distance of the Moon, kilometers
+
+/*
+ * Computes the first n + 1 Taylor coefficients around t0 of the polynomial of the given degree with the given
+ * coefficients, i.e. coefficients of the same polynomial in powers of t - t0.
+ */
+static void shift_polynomial(const double coefficients[], int degree, double t0, int n, double result[])
+{
+    double shifted[LASKAR_TOTAL_TERMS]; // coefficients being shifted
+    int i, k;                           // loop index variables
+
+    // repeated synthetic division by t - t0 leaves the k-th coefficient in its place after the k-th pass
+    for (i = 0; i <= degree; i++)
+        shifted[i] = coefficients[i];
+    for (k = 0; k <= degree; k++)
+        for (i = degree - 1; i >= k; i--)
+            shifted[i] += t0 * shifted[i + 1];
+
+    for (k = 0; k <= n; k++)
+        result[k] = k <= degree ? shifted[k] : 0.0;
+}
+
+/*
+ * Computes the first n + 1 coefficients of the product of two truncated power series.
+ */
+static void multiply_series(const double a[], const double b[], int n, double result[])
+{
+    double product[TAYLOR_MAX_ORDER + 1];   // product, kept aside so that the result may be one of the factors
+    int i, k;                               // loop index variables
+
+    for (k = 0; k <= n; k++)
+        for (i = 0, product[k] = 0.0; i <= k; i++)
+            product[k] += a[i] * b[k - i];
+    for (k = 0; k <= n; k++)
+        result[k] = product[k];
+}
+
+/*
+ * Computes the first n + 1 coefficients of sine and cosine of a truncated power series, whose coefficients vanish past
+ * the given degree.
+ */
+static void sine_cosine_series(const double u[], int degree, int n, double s[], double c[])
+{
+    int j, k;                   // loop index variables
+
+    s[0] = sin(u[0]);
+    c[0] = cos(u[0]);
+    for (k = 1; k <= n; k++){
+        for (j = 1, s[k] = c[k] = 0.0; j <= k && j <= degree; j++){
+            s[k] += j * u[j] * c[k - j];
+            c[k] -= j * u[j] * s[k - j];
+        }
+        s[k] /= k;
+        c[k] /= k;
+    }
+}
+
+/*
+ * Computes the first n + 1 coefficients of the square root of a truncated power series with a positive leading
+ * coefficient.
+ */
+static void square_root_series(const double a[], int n, double result[])
+{
+    int j, k;                   // loop index variables
+
+    result[0] = sqrt(a[0]);
+    for (k = 1; k <= n; k++){
+        for (j = 1, result[k] = a[k]; j < k; j++)
+            result[k] -= result[j] * result[k - j];
+        result[k] /= 2.0 * result[0];
+    }
+}
+
+/*
+ * Computes Taylor coefficients around t0 of the arguments of the series: coefficients of τᵏ are stored into the k-th
+ * element of the given array for k up to n. Coefficients of the arguments of other series than the Main Problem vanish
+ * past the first power.
+ */
+static void compute_argument_series(double t0, int n, serie_arguments arguments[])
+{
+    double full[TOTAL_ELP2000_ARGUMENTS][TAYLOR_MAX_ORDER + 1];     // series of full ELP2000 arguments
+    double linear[TOTAL_ELP2000_ARGUMENTS][TAYLOR_MAX_ORDER + 1];   // series of linear ELP2000 arguments
+    double planetary[TAYLOR_MAX_ORDER + 1];                         // series of a planetary argument
+    double constant;                                                // constant added to D for k = 0 only
+    int i, k;                                                       // loop index variables
+
+    for (i = W1; i <= OBP; i++){
+        shift_polynomial(&elp2000_arguments_coefficients[i * FULL_SERIES_TOTAL_TERMS], ARGUMENT_DEGREE, t0, n,
+                         full[i]);
+        shift_polynomial(&elp2000_arguments_coefficients[i * FULL_SERIES_TOTAL_TERMS], LINEAR_SERIES_TOTAL_TERMS - 1,
+                         t0, n, linear[i]);
+    }
+
+    // Delaunay arguments are linear combinations of ELP2000 arguments (see compute_delaunay_arguments), thus their
+    // coefficients are the same combinations of coefficients of ELP2000 arguments
+    for (k = 0; k <= n; k++){
+        constant = k == 0 ? 648000.0 : 0.0;
+        arguments[k].delaunay[D] = full[W1][k] - full[T][k] + constant;
+        arguments[k].delaunay[LP] = full[T][k] - full[OBP][k];
+        arguments[k].delaunay[L] = full[W1][k] - full[W2][k];
+        arguments[k].delaunay[F] = full[W1][k] - full[W3][k];
+        arguments[k].reduced_delaunay[D] = linear[W1][k] - linear[T][k] + constant;
+        arguments[k].reduced_delaunay[LP] = linear[T][k] - linear[OBP][k];
+        arguments[k].reduced_delaunay[L] = linear[W1][k] - linear[W2][k];
+        arguments[k].reduced_delaunay[F] = linear[W1][k] - linear[W3][k];
+        // ζ = W₁ + pt, W₁ reduced to linear terms
+        arguments[k].precession = linear[W1][k] +
+                                  (k == 0 ? precession_constant * t0 : k == 1 ? precession_constant : 0.0);
+    }
+    for (i = 0; i < TOTAL_PLANETARY_ARGUMENTS; i++){
+        shift_polynomial(&planetary_arguments_coefficients[i * LINEAR_SERIES_TOTAL_TERMS],
+                         LINEAR_SERIES_TOTAL_TERMS - 1, t0, n, planetary);
+        for (k = 0; k <= n; k++)
+            arguments[k].planetary[i] = planetary[k];
+    }
+}
+
+/*
+ * Computes Taylor coefficients around t0 of spherical coordinates of the Moon in the ELP 2000 reference frame:
+ * coordinates[l][k] is the coefficient of τᵏ of coordinate l.
+ */
+static void compute_spherical_series(double t0, int n, double coordinates[][TAYLOR_MAX_ORDER + 1])
+{
+    serie_arguments arguments[TAYLOR_MAX_ORDER + 1];    // series of arguments of the series
+    double u[ARGUMENT_DEGREE + 1];                      // series of the argument of a term, radians
+    double s[TAYLOR_MAX_ORDER + 1];                     // series of the sine of the argument
+    double c[TAYLOR_MAX_ORDER + 1];                     // series of the cosine of the argument
+    double sum[TAYLOR_MAX_ORDER + 1];                   // series of a serie
+    double power[TAYLOR_MAX_ORDER + 1];                 // series of a power of t
+    double w1[TAYLOR_MAX_ORDER + 1];                    // series of the mean mean longitude of the Moon
+    double amplitude;                                   // amplitude of a term
+    const serie *se;                                    // current serie
+    int degree;                                         // degree of the argument of terms of the current serie
+    int i, j, k;                                        // loop index variables
+
+    compute_argument_series(t0, n, arguments);
+
+    for (j = 0; j < TOTAL_SPHERICAL_COORDINATES; j++)
+        for (k = 0; k <= n; k++)
+            coordinates[j][k] = 0.0;
+
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        se = &elp2000_series[i];
+        degree = se->type == SERIE_A_SIN || se->type == SERIE_A_COS ? ARGUMENT_DEGREE : LINEAR_SERIES_TOTAL_TERMS - 1;
+        if (degree > n)
+            degree = n;
+
+        for (k = 0; k <= n; k++)
+            sum[k] = 0.0;
+
+        for (j = 0; j < se->n; j++){
+            // arguments are linear in the arguments of the series, thus each coefficient of the argument of a term
+            // is the argument computed from the corresponding coefficients of the arguments of the series
+            for (k = 0; k <= degree; k++)
+                u[k] = compute_serie_term_argument(se, &arguments[k], j) * (M_PI / 648000.0);
+            u[0] += serie_term_phase(se, j) * (M_PI / 648000.0);
+
+            sine_cosine_series(u, degree, n, s, c);
+
+            amplitude = serie_term_amplitude(se, j);
+            for (k = 0; k <= n; k++)
+                sum[k] += amplitude * s[k];
+        }
+
+        // multiplying the serie by its power of t = t0 + τ
+        for (k = 0; k <= n; k++)
+            power[k] = k == 0 ? t0 : k == 1 ? 1.0 : 0.0;
+        for (j = 0; j < se->power; j++)
+            multiply_series(sum, power, n, sum);
+
+        for (k = 0; k <= n; k++)
+            coordinates[se->coordinate][k] += sum[k];
+    }
+
+    // adding mean mean longitude of the Moon (W₁)
+    shift_polynomial(&elp2000_arguments_coefficients[W1 * FULL_SERIES_TOTAL_TERMS], ARGUMENT_DEGREE, t0, n, w1);
+    for (k = 0; k <= n; k++)
+        coordinates[LONGITUDE][k] += w1[k];
+}
+
+/*
+ * Bounds remainders of Taylor series of the given order around t0 of spherical coordinates of the Moon in the ELP 2000
+ * reference frame over |τ| ≤ h, writing them into the remainders array, and rates of the coordinates over the same
+ * interval into the rates array. The argument of each term is taken as linear at the greatest rate it reaches over
+ * the interval, ω, thus the remainder of order k of its sine is at most (ωh)ᵏ⁺¹/(k + 1)! by Lagrange's formula; the
+ * factor tᵖ = (t0 + τ)ᵖ of a serie is a polynomial of τ, whose coefficient of τⁱ multiplies the remainder of order
+ * k - i of the sine.
+ */
+static void compute_spherical_remainders(double t0, int n, double h, double remainders[], double rates[])
+{
+    serie_arguments arguments[ARGUMENT_DEGREE + 1];     // series of arguments of the series
+    double tails[TAYLOR_MAX_ORDER + 2];                 // sums of |A|(ωh)ᵐ/m! of the terms of a serie
+    double w1[ARGUMENT_DEGREE + 1];                     // series of the mean mean longitude of the Moon
+    double amplitudes;                                  // sum of |A| of the terms of a serie
+    double rate;                                        // greatest rate of the argument of a term, radians
+    double bound;                                       // |A|(ωh)ᵐ/m! of a term
+    double binomial;                                    // binomial coefficient of the power of t
+    double factor;                                      // coefficient of τⁱ of the power of t, times hⁱ
+    const serie *se;                                    // current serie
+    int degree;                                         // degree of the argument of terms of the current serie
+    int i, j, k, m;                                     // loop index variables
+
+    compute_argument_series(t0, ARGUMENT_DEGREE, arguments);
+
+    for (j = 0; j < TOTAL_SPHERICAL_COORDINATES; j++)
+        remainders[j] = rates[j] = 0.0;
+
+    for (i = 0; i < TOTAL_ELP2000_SERIES; i++){
+        se = &elp2000_series[i];
+        degree = se->type == SERIE_A_SIN || se->type == SERIE_A_COS ? ARGUMENT_DEGREE : LINEAR_SERIES_TOTAL_TERMS - 1;
+
+        for (m = 0; m <= n + 1; m++)
+            tails[m] = 0.0;
+
+        for (j = 0, amplitudes = 0.0; j < se->n; j++){
+            for (k = degree, rate = 0.0; k >= 1; k--)
+                rate = rate * h + k * fabs(compute_serie_term_argument(se, &arguments[k], j)) * (M_PI / 648000.0);
+
+            bound = fabs(serie_term_amplitude(se, j));
+            amplitudes += bound;
+            rates[se->coordinate] += bound * (rate * pow(fabs(t0) + h, se->power) +
+                                              se->power * pow(fabs(t0) + h, se->power - 1));
+            for (m = 1; m <= n + 1; m++){
+                bound *= rate * h / m;
+                tails[m] += bound;
+            }
+        }
+
+        // multiplying by (t0 + τ)ᵖ, whose coefficients past the order multiply the sine itself, bounded by one
+        for (k = 0, binomial = 1.0; k <= se->power; binomial = binomial * (se->power - k) / (k + 1), k++){
+            factor = binomial * pow(fabs(t0), se->power - k) * pow(h, k);
+            remainders[se->coordinate] += factor * (k <= n ? tails[n + 1 - k] : amplitudes);
+        }
+    }
+
+    // the mean mean longitude of the Moon (W₁) is a polynomial, whose remainder is made of its omitted coefficients
+    shift_polynomial(&elp2000_arguments_coefficients[W1 * FULL_SERIES_TOTAL_TERMS], ARGUMENT_DEGREE, t0,
+                     ARGUMENT_DEGREE, w1);
+    for (k = ARGUMENT_DEGREE; k >= 1; k--){
+        rates[LONGITUDE] += k * fabs(w1[k]) * pow(h, k - 1);
+        if (k > n)
+            remainders[LONGITUDE] += fabs(w1[k]) * pow(h, k);
+    }
+}
+
+/*
+ * Refers Taylor coefficients of spherical coordinates of the Moon in the ELP 2000 reference frame to the given frame,
+ * the same way as refer_to_frame of elp2000-82b.c refers positions.
+ */
+static void refer_series_to_frame(double t0, int n, int frame, double coordinates[][TAYLOR_MAX_ORDER + 1])
+{
+    double rotation[3][3][TAYLOR_MAX_ORDER + 1];    // series of the elements of the rotation to J2000
+    double cartesian[3][TAYLOR_MAX_ORDER + 1];      // series of rectangular coordinates
+    double sl[TAYLOR_MAX_ORDER + 1], cl[TAYLOR_MAX_ORDER + 1];  // series of sine and cosine of the longitude
+    double sb[TAYLOR_MAX_ORDER + 1], cb[TAYLOR_MAX_ORDER + 1];  // series of sine and cosine of the latitude
+    double p[TAYLOR_MAX_ORDER + 1], q[TAYLOR_MAX_ORDER + 1];    // series of Laskar's p and q
+    double pp[TAYLOR_MAX_ORDER + 1], qq[TAYLOR_MAX_ORDER + 1];  // series of p² and q²
+    double pq[TAYLOR_MAX_ORDER + 1];                            // series of pq
+    double root[TAYLOR_MAX_ORDER + 1];                          // series of sqrt(1 - p² - q²)
+    double x, y, z;                                             // coefficients of rectangular coordinates
+    int i, j, k;                                                // loop index variables
+
+    if (frame == ELP2000_SPHERICAL)
+        return;
+    if (frame == OF_DATE_SPHERICAL){
+        shift_polynomial(precession_coefficients, PRECESSION_TOTAL_TERMS - 1, t0, n, p);
+        for (k = 0; k <= n; k++)
+            coordinates[LONGITUDE][k] += p[k];
+        return;
+    }
+
+    // converting to rectangular coordinates: longitude and latitude are converted from arcseconds to radians
+    for (k = 0; k <= n; k++){
+        p[k] = coordinates[LONGITUDE][k] * (M_PI / 648000.0);
+        q[k] = coordinates[LATITUDE][k] * (M_PI / 648000.0);
+    }
+    sine_cosine_series(p, n, n, sl, cl);
+    sine_cosine_series(q, n, n, sb, cb);
+    multiply_series(coordinates[DISTANCE], cb, n, cartesian[0]);
+    multiply_series(cartesian[0], sl, n, cartesian[1]);
+    multiply_series(cartesian[0], cl, n, cartesian[0]);
+    multiply_series(coordinates[DISTANCE], sb, n, cartesian[2]);
+
+    if (frame != ELP2000_CARTESIAN){
+        // rotating ELP2000 reference frame into mean dynamical ecliptic and equinox of J2000
+        shift_polynomial(laskar_p_coefficients, LASKAR_TOTAL_TERMS - 1, t0, n, p);
+        shift_polynomial(laskar_q_coefficients, LASKAR_TOTAL_TERMS - 1, t0, n, q);
+        multiply_series(p, p, n, pp);
+        multiply_series(q, q, n, qq);
+        multiply_series(p, q, n, pq);
+        for (k = 0; k <= n; k++)
+            root[k] = (k == 0 ? 1.0 : 0.0) - pp[k] - qq[k];
+        square_root_series(root, n, root);
+
+        multiply_series(p, root, n, rotation[0][2]);
+        multiply_series(q, root, n, rotation[1][2]);
+        for (k = 0; k <= n; k++){
+            rotation[0][0][k] = (k == 0 ? 1.0 : 0.0) - 2.0 * pp[k];
+            rotation[0][1][k] = 2.0 * pq[k];
+            rotation[0][2][k] *= 2.0;
+            rotation[1][0][k] = 2.0 * pq[k];
+            rotation[1][1][k] = (k == 0 ? 1.0 : 0.0) - 2.0 * qq[k];
+            rotation[1][2][k] *= -2.0;
+            rotation[2][0][k] = -rotation[0][2][k];
+            rotation[2][1][k] = -rotation[1][2][k];
+            rotation[2][2][k] = (k == 0 ? 1.0 : 0.0) - 2.0 * pp[k] - 2.0 * qq[k];
+        }
+
+        for (i = 0; i < 3; i++){
+            for (k = 0; k <= n; k++)
+                coordinates[i][k] = 0.0;
+            for (j = 0; j < 3; j++){
+                multiply_series(rotation[i][j], cartesian[j], n, p);
+                for (k = 0; k <= n; k++)
+                    coordinates[i][k] += p[k];
+            }
+        }
+        for (i = 0; i < 3; i++)
+            for (k = 0; k <= n; k++)
+                cartesian[i][k] = coordinates[i][k];
+    }
+
+    for (k = 0; k <= n; k++){
+        x = cartesian[0][k];
+        y = cartesian[1][k];
+        z = cartesian[2][k];
+        if (frame == FK5_CARTESIAN){
+            // transforming to rectangular coordinates referred to the FK5 equator
+            for (i = 0; i < 3; i++)
+                coordinates[i][k] = fk5_rotation[i][0] * x + fk5_rotation[i][1] * y + fk5_rotation[i][2] * z;
+        } else {
+            coordinates[0][k] = x;
+            coordinates[1][k] = y;
+            coordinates[2][k] = z;
+        }
+    }
+}
+
+int geocentric_moon_taylor(double t0, int order, int frame, double coefficients[])
+{
+    double coordinates[TOTAL_SPHERICAL_COORDINATES][TAYLOR_MAX_ORDER + 1];  // series of coordinates
+    int k, l;                                                               // loop index variables
+
+    if (order < 0 || order > TAYLOR_MAX_ORDER || frame < 0 || frame >= TOTAL_ELP_FRAMES)
+        return -1;
+
+    compute_spherical_series(t0, order, coordinates);
+    refer_series_to_frame(t0, order, frame, coordinates);
+
+    for (k = 0; k <= order; k++)
+        for (l = 0; l < 3; l++)
+            coefficients[3 * k + l] = coordinates[l][k];
+
+    return 0;
+}
+
+int geocentric_moon_taylor_error(double t0, int order, int frame, double dt, double error[])
+{
+    double remainders[TOTAL_SPHERICAL_COORDINATES];     // remainders of spherical coordinates
+    double rates[TOTAL_SPHERICAL_COORDINATES];          // rates of spherical coordinates
+    double precession[PRECESSION_TOTAL_TERMS];          // series of the accumulated precession
+    double h;                                           // half-width of the interval
+    double x;                                           // greatest angle swept over the interval, radians
+    double bound;                                       // remainder of the rotation of a rectangular coordinate
+    int k;                                              // loop index variable
+
+    if (order < 0 || order > TAYLOR_MAX_ORDER || frame < 0 || frame >= TOTAL_ELP_FRAMES)
+        return -1;
+
+    h = fabs(dt);
+    compute_spherical_remainders(t0, order, h, remainders, rates);
+
+    if (frame == ELP2000_SPHERICAL || frame == OF_DATE_SPHERICAL){
+        if (frame == OF_DATE_SPHERICAL){
+            shift_polynomial(precession_coefficients, PRECESSION_TOTAL_TERMS - 1, t0, PRECESSION_TOTAL_TERMS - 1,
+                             precession);
+            for (k = order + 1; k < PRECESSION_TOTAL_TERMS; k++)
+                remainders[LONGITUDE] += fabs(precession[k]) * pow(h, k);
+        }
+        error[0] = remainders[0];
+        error[1] = remainders[1];
+        error[2] = remainders[2];
+        return 0;
+    }
+
+    // rectangular coordinates are of the form r·cos(λ)cos(β), thus besides the remainders of the coordinates referred
+    // the same way as errors of positions are (see geocentric_moon_truncation_error), their series have remainders of
+    // the rotation by the angles swept over the interval, bounded the same way as the ones of terms
+    x = ((rates[LONGITUDE] + rates[LATITUDE]) * (M_PI / 648000.0) + rates[DISTANCE] / MINIMUM_DISTANCE) * h;
+    for (k = 1, bound = MAXIMUM_DISTANCE; k <= order + 1; k++)
+        bound *= x / k;
+    error[0] = error[1] = error[2] = remainders[DISTANCE] + MAXIMUM_DISTANCE * (remainders[LONGITUDE] +
+                                     remainders[LATITUDE]) * (M_PI / 648000.0) + bound;
+
+    return 0;
+}
+
+void taylor_evaluate(const double coefficients[], int order, double dt, double position[], double velocity[])
+{
+    int k, l;                   // loop index variables
+
+    // evaluating polynomials and their derivatives by Horner's scheme
+    for (l = 0; l < 3; l++){
+        position[l] = coefficients[3 * order + l];
+        if (velocity != NULL)
+            velocity[l] = 0.0;
+        for (k = order - 1; k >= 0; k--){
+            if (velocity != NULL)
+                velocity[l] = velocity[l] * dt + position[l];
+            position[l] = position[l] * dt + coefficients[3 * k + l];
+        }
+    }
+}
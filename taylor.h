@@ -0,0 +1,62 @@
+/*
+ * taylor.h
+ *
+ * This file contains routines to expand positions of the Moon into Taylor polynomials around a given epoch, so that
+ * positions and velocities near the epoch are computed as values of polynomials.
+ *
+ * Each term of the series equals to At^psin(φ(t)), where the argument φ is a polynomial of t: a quartic one for the
+ * Main Problem and a linear one for the other series. Taylor coefficients of the argument around t₀ are found exactly
+ * from coefficients of the polynomials of the arguments of the theory, those of the sine follow from the recurrences
+ *
+ *                    s₀ = sin φ₀,  c₀ = cos φ₀,  sₖ = (1/k)Σjφⱼcₖ₋ⱼ,  cₖ = -(1/k)Σjφⱼsₖ₋ⱼ,
+ *
+ * (for linear arguments sₖ reduces to φ₁ᵏsin(φ₀ + kπ/2)/k!), and the series are summed coefficient by coefficient in a
+ * single pass over their terms. Coordinates of other frames are found by the same transformations as positions are,
+ * applied to truncated power series rather than to numbers.
+ *
+ * Polynomials are given in powers of τ = t - t₀ measured in Julian centuries: the coefficient of τᵏ of coordinate l
+ * has index 3k + l. Their accuracy is limited by the first omitted power of τ: an expansion of order 8 reproduces the
+ * series within a millimeter over ±12 hours around t₀, while its error grows as |τ|⁹ further away.
+ * geocentric_moon_taylor_error bounds the remainder over an interval by Lagrange's formula applied term by term.
+ */
+
+#ifndef TAYLOR_H
+#define TAYLOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TAYLOR_MAX_ORDER 16             // maximum order of Taylor polynomials
+
+/*
+ * Computes coefficients of Taylor polynomials of the given order of position of the Moon in the given frame (one of
+ * ELP_frames) around time instant t0 (Julian centuries since J2000), 3(order + 1) values in total.
+ * Returns zero on success or a negative value if the order or the frame is invalid.
+ */
+int geocentric_moon_taylor(double t0, int order, int frame, double coefficients[]);
+
+/*
+ * Estimates the error of Taylor polynomials of the given order found by geocentric_moon_taylor around t0 in the given
+ * frame over time instants t0 + τ with |τ| ≤ |dt|, writing three values in units of the coordinates into the given
+ * array. Each term of the series, taken with a linear argument at the greatest rate ω it reaches over the interval,
+ * adds |A|(ω|dt|)ⁿ⁺¹/(n + 1)! to the remainder of its coordinate by Lagrange's formula, n being the order. Rectangular
+ * coordinates are bounded by the error of distance and the errors of angles at the greatest distance of the Moon, plus
+ * the remainder of the rotation by the angles swept over the interval. Rounding errors, which grow with the magnitude
+ * of the longitude (a few microarcseconds five centuries away from J2000), are not included. A call costs about as
+ * much as geocentric_moon_taylor.
+ * Returns zero on success or a negative value if the order or the frame is invalid.
+ */
+int geocentric_moon_taylor_error(double t0, int order, int frame, double dt, double error[]);
+
+/*
+ * Computes position of the Moon and its velocity, measured in units of the coordinates per Julian century, at time
+ * instant t0 + dt from Taylor polynomials of the given order found by geocentric_moon_taylor. Velocity may be NULL.
+ */
+void taylor_evaluate(const double coefficients[], int order, double dt, double position[], double velocity[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TAYLOR_H
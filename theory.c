@@ -0,0 +1,7 @@
+/*
+ * theory.c
+ */
+
+#include "theorydata.h"
+
+const serie elp2000_series[TOTAL_ELP2000_SERIES] = ELP2000_SERIES_DATA;
@@ -0,0 +1,43 @@
+/*
+ * theory.h
+ *
+ * This file describes the whole set of series of the ELP theory. Each serie of the theory is given by a descriptor
+ * (see series.h) holding its type, the spherical coordinate it contributes to, the power of t it is multiplied by and
+ * its data arrays.
+ *
+ * Geocentric position of the Moon in the ELP 2000 reference frame is found by computing each serie, multiplying it by
+ * the corresponding power of t, adding it to its coordinate and finally adding Moon's mean mean longitude (W₁) to the
+ * longitude. Series are listed in the order they are added together.
+ */
+
+#ifndef THEORY_H
+#define THEORY_H
+
+#include "series.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOTAL_ELP2000_SERIES 36         // total amount of series of the ELP theory
+#define TOTAL_SPHERICAL_COORDINATES 3   // total amount of spherical coordinates: longitude, latitude and distance
+
+/*
+ * An enumeration indexing spherical coordinates computed by the ELP theory.
+ */
+enum Spherical_coordinates {
+    LONGITUDE = 0,      // longitude, measured in arcseconds
+    LATITUDE = 1,       // latitude, measured in arcseconds
+    DISTANCE = 2        // radial distance, measured in kilometers
+};
+
+/*
+ * Descriptors of all series of the ELP theory.
+ */
+extern const serie elp2000_series[TOTAL_ELP2000_SERIES];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // THEORY_H
@@ -0,0 +1,122 @@
+/*
+ * theorydata.h
+ *
+ * This file holds the initializer of the descriptors of all series of the ELP theory (see theory.h) referring to the
+ * data arrays of the theory. It is shared by theory.c, which builds the descriptors of the library, and C++ code which
+ * needs the descriptors at compile time (see kernels.hpp). Series are listed in the order they are added together.
+ */
+
+#ifndef THEORYDATA_H
+#define THEORYDATA_H
+
+#include "mainprob.h"
+#include "earthfig.h"
+#include "planetary1.h"
+#include "planetary2.h"
+#include "tidal.h"
+#include "moonfig.h"
+#include "relativistic.h"
+#include "solarecc.h"
+
+#include "theory.h"
+
+#define ELP2000_SERIES_DATA                                                                              \
+{                                                                                                        \
+    /* Main Problem */                                                                                   \
+    {SERIE_A_SIN, LONGITUDE, 0, main_problem_longitude_multipliers, main_problem_longitude_coefficients, \
+     TOTAL_MAIN_PROBLEM_LONGITUDE_TERMS},                                                                \
+    {SERIE_A_SIN, LATITUDE, 0, main_problem_latitude_multipliers, main_problem_latitude_coefficients,    \
+     TOTAL_MAIN_PROBLEM_LATITUDE_TERMS},                                                                 \
+    {SERIE_A_COS, DISTANCE, 0, main_problem_distance_multipliers, main_problem_distance_coefficients,    \
+     TOTAL_MAIN_PROBLEM_DISTANCE_TERMS},                                                                 \
+                                                                                                         \
+    /* Earth figure perturbations (constant) */                                                          \
+    {SERIE_B, LONGITUDE, 0, earth_figure_longitude_0_multipliers, earth_figure_longitude_0_coefficients, \
+     TOTAL_EARTH_FIGURE_LONGITUDE_0_TERMS},                                                              \
+    {SERIE_B, LATITUDE, 0, earth_figure_latitude_0_multipliers, earth_figure_latitude_0_coefficients,    \
+     TOTAL_EARTH_FIGURE_LATITUDE_0_TERMS},                                                               \
+    {SERIE_B, DISTANCE, 0, earth_figure_distance_0_multipliers, earth_figure_distance_0_coefficients,    \
+     TOTAL_EARTH_FIGURE_DISTANCE_0_TERMS},                                                               \
+                                                                                                         \
+    /* Earth figure perturbations (linear) */                                                            \
+    {SERIE_B, LONGITUDE, 1, earth_figure_longitude_0_multipliers, earth_figure_longitude_0_coefficients, \
+     TOTAL_EARTH_FIGURE_LONGITUDE_0_TERMS},                                                              \
+    {SERIE_B, LATITUDE, 1, earth_figure_latitude_0_multipliers, earth_figure_latitude_0_coefficients,    \
+     TOTAL_EARTH_FIGURE_LATITUDE_0_TERMS},                                                               \
+    {SERIE_B, DISTANCE, 1, earth_figure_distance_0_multipliers, earth_figure_distance_0_coefficients,    \
+     TOTAL_EARTH_FIGURE_DISTANCE_0_TERMS},                                                               \
+                                                                                                         \
+    /* planetary 1 perturbations (constant) */                                                           \
+    {SERIE_C, LONGITUDE, 0, planetary1_longitude_0_multipliers, planetary1_longitude_0_coefficients,     \
+     TOTAL_PLANETARY1_LONGITUDE_0_TERMS},                                                                \
+    {SERIE_C, LATITUDE, 0, planetary1_latitude_0_multipliers, planetary1_latitude_0_coefficients,        \
+     TOTAL_PLANETARY1_LATITUDE_0_TERMS},                                                                 \
+    {SERIE_C, DISTANCE, 0, planetary1_distance_0_multipliers, planetary1_distance_0_coefficients,        \
+     TOTAL_PLANETARY1_DISTANCE_0_TERMS},                                                                 \
+                                                                                                         \
+    /* planetary 1 perturbations (linear) */                                                             \
+    {SERIE_C, LONGITUDE, 1, planetary1_longitude_1_multipliers, planetary1_longitude_1_coefficients,     \
+     TOTAL_PLANETARY1_LONGITUDE_1_TERMS},                                                                \
+    {SERIE_C, LATITUDE, 1, planetary1_latitude_1_multipliers, planetary1_latitude_1_coefficients,        \
+     TOTAL_PLANETARY1_LATITUDE_1_TERMS},                                                                 \
+    {SERIE_C, DISTANCE, 1, planetary1_distance_1_multipliers, planetary1_distance_1_coefficients,        \
+     TOTAL_PLANETARY1_DISTANCE_1_TERMS},                                                                 \
+                                                                                                         \
+    /* planetary 2 perturbations (constant) */                                                           \
+    {SERIE_D, LONGITUDE, 0, planetary2_longitude_0_multipliers, planetary2_longitude_0_coefficients,     \
+     TOTAL_PLANETARY2_LONGITUDE_0_TERMS},                                                                \
+    {SERIE_D, LATITUDE, 0, planetary2_latitude_0_multipliers, planetary2_latitude_0_coefficients,        \
+     TOTAL_PLANETARY2_LATITUDE_0_TERMS},                                                                 \
+    {SERIE_D, DISTANCE, 0, planetary2_distance_0_multipliers, planetary2_distance_0_coefficients,        \
+     TOTAL_PLANETARY2_DISTANCE_0_TERMS},                                                                 \
+                                                                                                         \
+    /* planetary 2 perturbations (linear) */                                                             \
+    {SERIE_D, LONGITUDE, 1, planetary2_longitude_1_multipliers, planetary2_longitude_1_coefficients,     \
+     TOTAL_PLANETARY2_LONGITUDE_1_TERMS},                                                                \
+    {SERIE_D, LATITUDE, 1, planetary2_latitude_1_multipliers, planetary2_latitude_1_coefficients,        \
+     TOTAL_PLANETARY2_LATITUDE_1_TERMS},                                                                 \
+    {SERIE_D, DISTANCE, 1, planetary2_distance_1_multipliers, planetary2_distance_1_coefficients,        \
+     TOTAL_PLANETARY2_DISTANCE_1_TERMS},                                                                 \
+                                                                                                         \
+    /* tidal effects (constant) */                                                                       \
+    {SERIE_B, LONGITUDE, 0, tidal_longitude_0_multipliers, tidal_longitude_0_coefficients,               \
+     TOTAL_TIDAL_LONGITUDE_0_TERMS},                                                                     \
+    {SERIE_B, LATITUDE, 0, tidal_latitude_0_multipliers, tidal_latitude_0_coefficients,                  \
+     TOTAL_TIDAL_LATITUDE_0_TERMS},                                                                      \
+    {SERIE_B, DISTANCE, 0, tidal_distance_0_multipliers, tidal_distance_0_coefficients,                  \
+     TOTAL_TIDAL_DISTANCE_0_TERMS},                                                                      \
+                                                                                                         \
+    /* tidal effects (linear) */                                                                         \
+    {SERIE_B, LONGITUDE, 1, tidal_longitude_1_multipliers, tidal_longitude_1_coefficients,               \
+     TOTAL_TIDAL_LONGITUDE_1_TERMS},                                                                     \
+    {SERIE_B, LATITUDE, 1, tidal_latitude_1_multipliers, tidal_latitude_1_coefficients,                  \
+     TOTAL_TIDAL_LATITUDE_1_TERMS},                                                                      \
+    {SERIE_B, DISTANCE, 1, tidal_distance_1_multipliers, tidal_distance_1_coefficients,                  \
+     TOTAL_TIDAL_DISTANCE_1_TERMS},                                                                      \
+                                                                                                         \
+    /* Moon figure perturbations */                                                                      \
+    {SERIE_B, LONGITUDE, 0, moon_figure_longitude_multipliers, moon_figure_longitude_coefficients,       \
+     TOTAL_MOON_FIGURE_LONGITUDE_TERMS},                                                                 \
+    {SERIE_B, LATITUDE, 0, moon_figure_latitude_multipliers, moon_figure_latitude_coefficients,          \
+     TOTAL_MOON_FIGURE_LATITUDE_TERMS},                                                                  \
+    {SERIE_B, DISTANCE, 0, moon_figure_distance_multipliers, moon_figure_distance_coefficients,          \
+     TOTAL_MOON_FIGURE_DISTANCE_TERMS},                                                                  \
+                                                                                                         \
+    /* relativistic perturbations */                                                                     \
+    {SERIE_B, LONGITUDE, 0, relativistic_longitude_multipliers, relativistic_longitude_coefficients,     \
+     TOTAL_RELATIVISTIC_LONGITUDE_TERMS},                                                                \
+    {SERIE_B, LATITUDE, 0, relativistic_latitude_multipliers, relativistic_latitude_coefficients,        \
+     TOTAL_RELATIVISTIC_LATITUDE_TERMS},                                                                 \
+    {SERIE_B, DISTANCE, 0, relativistic_distance_multipliers, relativistic_distance_coefficients,        \
+     TOTAL_RELATIVISTIC_DISTANCE_TERMS},                                                                 \
+                                                                                                         \
+    /* planetary perturbations (solar eccentricity) (quadratic) */                                       \
+    {SERIE_B, LONGITUDE, 2, planetary_longitude_2_multipliers, planetary_longitude_2_coefficients,       \
+     TOTAL_PLANETARY_LONGITUDE_2_TERMS},                                                                 \
+    {SERIE_B, LATITUDE, 2, planetary_latitude_2_multipliers, planetary_latitude_2_coefficients,          \
+     TOTAL_PLANETARY_LATITUDE_2_TERMS},                                                                  \
+    {SERIE_B, DISTANCE, 2, planetary_distance_2_multipliers, planetary_distance_2_coefficients,          \
+     TOTAL_PLANETARY_DISTANCE_2_TERMS}                                                                   \
+}
+
+#endif // THEORYDATA_H
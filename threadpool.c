@@ -0,0 +1,282 @@
+/*
+ * threadpool.c
+ */
+
+#define _GNU_SOURCE
+
+#include "threadpool.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define POOL_SPIN_LIMIT 20000           // amount of spins an idle worker waits for a job before going to sleep
+
+/*
+ * A datatype holding a range of tasks of a participant of a job: index of the first task in its upper half and index
+ * past the last task in its lower half. It is aligned to a cache line, as ranges are modified concurrently.
+ */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t tasks;
+} task_range;
+
+/*
+ * State of the pool. Tasks of a job are split into contiguous ranges, one per participant: the calling thread has the
+ * first range and each worker has its own. A participant takes tasks from the beginning of its range and, once it is
+ * empty, steals the second half of the range of another participant. Ranges are only modified with atomic
+ * compare-and-swap. Fields of a job are written before its ranges are filled, thus a task taken from a range always
+ * belongs to the job the fields describe.
+ */
+static struct {
+    pthread_t threads[MAX_POOL_THREADS];    // worker threads
+    int size;                               // amount of worker threads
+    atomic_int running;                     // non zero while the pool is running
+    atomic_flag busy;                       // set while a job is running
+
+    pool_task task;                         // task routine of the current job
+    void *context;                          // context of the current job
+    task_range ranges[MAX_POOL_THREADS + 1];// ranges of tasks of the calling thread and each worker
+    atomic_uint generation;                 // generation of the current job
+    atomic_int done;                        // amount of finished tasks of the current job
+
+    pthread_mutex_t mutex;                  // mutex and condition sleeping workers wait on
+    pthread_cond_t condition;
+    atomic_int sleepers;                    // amount of sleeping workers
+} pool = {.busy = ATOMIC_FLAG_INIT, .mutex = PTHREAD_MUTEX_INITIALIZER, .condition = PTHREAD_COND_INITIALIZER};
+
+#define RANGE(first, last) ((uint64_t)(uint32_t)(first) << 32 | (uint32_t)(last))
+#define RANGE_FIRST(range) ((int)(uint32_t)((range) >> 32))
+#define RANGE_LAST(range) ((int)(uint32_t)(range))
+
+/*
+ * Takes the first task of the range of the given participant. Returns the index of the task or -1 if range is empty.
+ */
+static int take_task(int participant)
+{
+    _Atomic uint64_t *tasks = &pool.ranges[participant].tasks;
+    uint64_t range;             // current value of the range
+
+    range = atomic_load_explicit(tasks, memory_order_acquire);
+    while (RANGE_FIRST(range) < RANGE_LAST(range)){
+        if (atomic_compare_exchange_weak_explicit(tasks, &range, RANGE(RANGE_FIRST(range) + 1, RANGE_LAST(range)),
+                                                  memory_order_acq_rel, memory_order_acquire))
+            return RANGE_FIRST(range);
+    }
+
+    return -1;
+}
+
+/*
+ * Steals the second half of the range of another participant into the range of the given one, which is expected to
+ * be empty. Returns non zero if anything was stolen. Stolen tasks are run right away if the range of the participant
+ * was refilled meanwhile by the next job.
+ */
+static int steal_tasks(int participant)
+{
+    _Atomic uint64_t *tasks;    // range of the victim
+    uint64_t range;             // current value of the range of the victim
+    uint64_t own;               // current value of the range of the participant
+    int participants;           // amount of participants of a job
+    int i, half;                // loop index variable and amount of stolen tasks
+
+    own = atomic_load_explicit(&pool.ranges[participant].tasks, memory_order_acquire);
+    if (RANGE_FIRST(own) < RANGE_LAST(own))
+        return 1;
+
+    participants = pool.size + 1;
+    for (i = 1; i < participants; i++){
+        tasks = &pool.ranges[(participant + i) % participants].tasks;
+        range = atomic_load_explicit(tasks, memory_order_acquire);
+        while (RANGE_FIRST(range) < RANGE_LAST(range)){
+            half = (RANGE_LAST(range) - RANGE_FIRST(range) + 1) / 2;
+            if (!atomic_compare_exchange_weak_explicit(tasks, &range,
+                                                       RANGE(RANGE_FIRST(range), RANGE_LAST(range) - half),
+                                                       memory_order_acq_rel, memory_order_acquire))
+                continue;
+
+            if (!atomic_compare_exchange_strong_explicit(&pool.ranges[participant].tasks, &own,
+                                                         RANGE(RANGE_LAST(range) - half, RANGE_LAST(range)),
+                                                         memory_order_acq_rel, memory_order_acquire)){
+                for (i = RANGE_LAST(range) - half; i < RANGE_LAST(range); i++){
+                    pool.task(pool.context, i);
+                    atomic_fetch_add_explicit(&pool.done, 1, memory_order_release);
+                }
+            }
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Runs tasks of the current job on behalf of the given participant until no task is left to take or steal.
+ */
+static void run_tasks(int participant)
+{
+    int index;                  // index of the taken task
+
+    do {
+        while ((index = take_task(participant)) >= 0){
+            pool.task(pool.context, index);
+            atomic_fetch_add_explicit(&pool.done, 1, memory_order_release);
+        }
+    } while (steal_tasks(participant));
+}
+
+static void *worker(void *argument)
+{
+    int participant;            // index of the range of the worker
+    unsigned int seen;          // generation of the last job seen by the worker
+    unsigned int generation;    // generation of the current job
+    int spins;                  // amount of spins made waiting for a job
+
+    participant = (int)(intptr_t)argument;
+    spins = 0;
+    seen = atomic_load(&pool.generation);
+
+    while (atomic_load_explicit(&pool.running, memory_order_relaxed)){
+        generation = atomic_load_explicit(&pool.generation, memory_order_acquire);
+
+        if (generation == seen){
+            // waiting for the next job: spinning first, then sleeping until the job is published
+            if (++spins < POOL_SPIN_LIMIT){
+                if (spins % 64 == 0)
+                    sched_yield();
+                continue;
+            }
+
+            pthread_mutex_lock(&pool.mutex);
+            atomic_fetch_add(&pool.sleepers, 1);
+            while (atomic_load(&pool.running) && atomic_load(&pool.generation) == seen)
+                pthread_cond_wait(&pool.condition, &pool.mutex);
+            atomic_fetch_sub(&pool.sleepers, 1);
+            pthread_mutex_unlock(&pool.mutex);
+            spins = 0;
+            continue;
+        }
+
+        seen = generation;
+        spins = 0;
+        run_tasks(participant);
+    }
+
+    return NULL;
+}
+
+int thread_pool_start(int threads, int pin)
+{
+    int i;                      // loop index variable
+    long cpus;                  // amount of online processor cores
+    cpu_set_t set;              // processor core set of a worker
+
+    if (atomic_load(&pool.running) || threads < 1 || threads > MAX_POOL_THREADS)
+        return -1;
+
+    atomic_store(&pool.running, 1);
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (i = 0; i < threads; i++){
+        if (pthread_create(&pool.threads[i], NULL, worker, (void *)(intptr_t)(i + 1)) != 0)
+            break;
+
+        // pinning workers to cores following the calling thread, which is expected to run on the first one
+        if (pin && cpus > 0){
+            CPU_ZERO(&set);
+            CPU_SET((i + 1) % cpus, &set);
+            pthread_setaffinity_np(pool.threads[i], sizeof(set), &set);
+        }
+    }
+    pool.size = i;
+
+    if (pool.size < threads){
+        thread_pool_stop();
+        return -1;
+    }
+
+    return 0;
+}
+
+int thread_pool_start_from_environment(int threads)
+{
+    const char *value;          // value of an environment variable
+    long total;                 // total amount of threads including the calling one
+    int pin;                    // non zero if workers are to be pinned
+
+    value = getenv("ELP2000_THREADS");
+    total = value != NULL ? strtol(value, NULL, 10) : threads > 0 ? threads : sysconf(_SC_NPROCESSORS_ONLN);
+    value = getenv("ELP2000_PIN_THREADS");
+    pin = value != NULL && strtol(value, NULL, 10) != 0;
+
+    if (total > MAX_POOL_THREADS + 1)
+        total = MAX_POOL_THREADS + 1;
+
+    // a single thread needs no pool, tasks are run by the calling thread
+    return total > 1 ? thread_pool_start((int)total - 1, pin) : 0;
+}
+
+void thread_pool_stop(void)
+{
+    int i;                      // loop index variable
+
+    if (!atomic_load(&pool.running))
+        return;
+
+    // waking up sleeping workers to let them see the pool is stopped
+    pthread_mutex_lock(&pool.mutex);
+    atomic_store(&pool.running, 0);
+    pthread_cond_broadcast(&pool.condition);
+    pthread_mutex_unlock(&pool.mutex);
+
+    for (i = 0; i < pool.size; i++)
+        pthread_join(pool.threads[i], NULL);
+    pool.size = 0;
+}
+
+int thread_pool_size(void)
+{
+    return atomic_load(&pool.running) ? pool.size : 0;
+}
+
+void thread_pool_run(pool_task task, void *context, int n)
+{
+    int i;                      // loop index variable
+    int participants;           // amount of participants of the job
+    int spins;                  // amount of spins made waiting for workers
+
+    // running tasks in the calling thread if there is no one to share them with
+    if (n <= 1 || thread_pool_size() == 0 || atomic_flag_test_and_set_explicit(&pool.busy, memory_order_acquire)){
+        for (i = 0; i < n; i++)
+            task(context, i);
+        return;
+    }
+
+    // publishing the job: fields are written first, then tasks are split evenly between participants
+    pool.task = task;
+    pool.context = context;
+    atomic_store_explicit(&pool.done, 0, memory_order_relaxed);
+    participants = pool.size + 1;
+    for (i = 0; i < participants; i++)
+        atomic_store_explicit(&pool.ranges[i].tasks, RANGE((long)n * i / participants, (long)n * (i + 1) / participants),
+                              memory_order_release);
+    atomic_fetch_add(&pool.generation, 1);
+
+    if (atomic_load(&pool.sleepers) > 0){
+        pthread_mutex_lock(&pool.mutex);
+        pthread_cond_broadcast(&pool.condition);
+        pthread_mutex_unlock(&pool.mutex);
+    }
+
+    // taking part in the job and waiting for the tasks taken by workers, yielding now and then so that workers
+    // sharing the core of the caller get to finish them
+    run_tasks(0);
+    for (spins = 1; atomic_load_explicit(&pool.done, memory_order_acquire) < n; spins++)
+        if (spins % 64 == 0)
+            sched_yield();
+
+    atomic_flag_clear_explicit(&pool.busy, memory_order_release);
+}
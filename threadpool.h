@@ -0,0 +1,65 @@
+/*
+ * threadpool.h
+ *
+ * This file contains routines to manage a persistent pool of worker threads used to spread computations of the ELP
+ * theory over several processor cores.
+ *
+ * The pool runs one job at a time. A job is a set of n independent tasks given by a task routine, which is called with
+ * a user defined context and the index of a task. The calling thread takes part in the job and returns only when all
+ * tasks are finished (fork/join). Tasks are split into contiguous ranges, one per thread; a thread that runs out of
+ * tasks steals half of the range of another one (work stealing). No locks are taken while a job is running. Idle
+ * workers spin for a short while waiting for the next job and then go to sleep.
+ *
+ * If the pool is not started, or it is already busy with a job of another thread, all tasks are run by the calling
+ * thread itself, so the pool may be used from any thread and from within tasks.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_POOL_THREADS 256            // maximum amount of worker threads in the pool
+
+/*
+ * A datatype defining a task routine, which is given a job context and the index of a task.
+ */
+typedef void (*pool_task)(void *context, int index);
+
+/*
+ * Starts the pool with the given amount of worker threads, not counting the calling thread. If pin is non zero each
+ * worker is pinned to its own processor core.
+ * Returns zero on success, or a negative value if the pool is already started or threads could not be created.
+ */
+int thread_pool_start(int threads, int pin);
+
+/*
+ * Starts the pool with the amount of threads given by environment variable ELP2000_THREADS, counting the calling
+ * thread, or with the given amount of threads if the variable is not set, zero meaning one thread per online processor
+ * core. Workers are pinned if environment variable ELP2000_PIN_THREADS is set to a non zero value.
+ * Returns zero on success, or a negative value if the pool is already started or threads could not be created.
+ */
+int thread_pool_start_from_environment(int threads);
+
+/*
+ * Stops the pool and joins all of its worker threads. Must not be called while a job is running.
+ */
+void thread_pool_stop(void);
+
+/*
+ * Returns the amount of worker threads in the pool, zero if the pool is not started.
+ */
+int thread_pool_size(void);
+
+/*
+ * Runs n tasks of a job in the pool and waits for all of them to finish.
+ */
+void thread_pool_run(pool_task task, void *context, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // THREADPOOL_H
@@ -34,6 +34,8 @@
 #ifndef TIDAL_H
 #define TIDAL_H
 
+#include "series.h"
+
 #define TOTAL_TIDAL_LONGITUDE_0_TERMS 3
 #define TOTAL_TIDAL_LATITUDE_0_TERMS 2
 #define TOTAL_TIDAL_DISTANCE_0_TERMS 2
@@ -42,35 +44,35 @@
 #define TOTAL_TIDAL_LATITUDE_1_TERMS 4
 #define TOTAL_TIDAL_DISTANCE_1_TERMS 5
 
-int tidal_longitude_0_multipliers[TOTAL_TIDAL_LONGITUDE_0_TERMS * 5] = {
+ELP_DATA int tidal_longitude_0_multipliers[TOTAL_TIDAL_LONGITUDE_0_TERMS * 5] = {
     0, 1, 1, -1, -1,
     0, 1, 1, 0, -1,
     0, 1, 1, 1, -1
 };
-int tidal_latitude_0_multipliers[TOTAL_TIDAL_LATITUDE_0_TERMS * 5] = {
+ELP_DATA int tidal_latitude_0_multipliers[TOTAL_TIDAL_LATITUDE_0_TERMS * 5] = {
     0, 1, 1, 0, -2,
     0, 1, 1, 0, 0
 };
-int tidal_distance_0_multipliers[TOTAL_TIDAL_DISTANCE_0_TERMS * 5] = {
+ELP_DATA int tidal_distance_0_multipliers[TOTAL_TIDAL_DISTANCE_0_TERMS * 5] = {
     0, 1, 1, -1, -1,
     0, 1, 1, 1, -1
 };
 
-double tidal_longitude_0_coefficients[TOTAL_TIDAL_LONGITUDE_0_TERMS * 3] = {
+ELP_DATA double tidal_longitude_0_coefficients[TOTAL_TIDAL_LONGITUDE_0_TERMS * 3] = {
     192.93665, 0.00004, 0.075,
     192.93665, 0.00082, 18.600,
     192.93665, 0.00004, 0.076
 };
-double tidal_latitude_0_coefficients[TOTAL_TIDAL_LATITUDE_0_TERMS * 3] = {
+ELP_DATA double tidal_latitude_0_coefficients[TOTAL_TIDAL_LATITUDE_0_TERMS * 3] = {
     192.93663, 0.00004, 0.074,
     192.93664, 0.00004, 0.075
 };
-double tidal_distance_0_coefficients[TOTAL_TIDAL_DISTANCE_0_TERMS * 3] = {
+ELP_DATA double tidal_distance_0_coefficients[TOTAL_TIDAL_DISTANCE_0_TERMS * 3] = {
     282.93665, 0.00004, 0.075,
     102.93665, 0.00004, 0.076
 };
 
-int tidal_longitude_1_multipliers[TOTAL_TIDAL_LONGITUDE_1_TERMS * 5] = {
+ELP_DATA int tidal_longitude_1_multipliers[TOTAL_TIDAL_LONGITUDE_1_TERMS * 5] = {
     0, 0, 0, 1, 0,
     0, 0, 0, 2, 0,
     0, 2, 0, -2, 0,
@@ -78,13 +80,13 @@ int tidal_longitude_1_multipliers[TOTAL_TIDAL_LONGITUDE_1_TERMS * 5] = {
     0, 2, 0, 0, 0,
     0, 2, 0, 1, 0
 };
-int tidal_latitude_1_multipliers[TOTAL_TIDAL_LATITUDE_1_TERMS * 5] = {
+ELP_DATA int tidal_latitude_1_multipliers[TOTAL_TIDAL_LATITUDE_1_TERMS * 5] = {
     0, 0, 0, 0, 1,
     0, 0, 0, 1, -1,
     0, 0, 0, 1, 1,
     0, 2, 0, 0, -1
 };
-int tidal_distance_1_multipliers[TOTAL_TIDAL_DISTANCE_1_TERMS * 5] = {
+ELP_DATA int tidal_distance_1_multipliers[TOTAL_TIDAL_DISTANCE_1_TERMS * 5] = {
     0, 0, 0, 0, 0,
     0, 0, 0, 1, 0,
     0, 0, 0, 2, 0,
@@ -92,7 +94,7 @@ int tidal_distance_1_multipliers[TOTAL_TIDAL_DISTANCE_1_TERMS * 5] = {
     0, 2, 0, 0, 0
 };
 
-double tidal_longitude_1_coefficients[TOTAL_TIDAL_LONGITUDE_1_TERMS * 3] = {
+ELP_DATA double tidal_longitude_1_coefficients[TOTAL_TIDAL_LONGITUDE_1_TERMS * 3] = {
     0.00000, 0.00058, 0.075,
     0.00000, 0.00004, 0.038,
     0.00000, 0.00002, 0.564,
@@ -100,13 +102,13 @@ double tidal_longitude_1_coefficients[TOTAL_TIDAL_LONGITUDE_1_TERMS * 3] = {
     0.00000, 0.00009, 0.040,
     0.00000, 0.00001, 0.026
 };
-double tidal_latitude_1_coefficients[TOTAL_TIDAL_LATITUDE_1_TERMS * 3] = {
+ELP_DATA double tidal_latitude_1_coefficients[TOTAL_TIDAL_LATITUDE_1_TERMS * 3] = {
     180.00000, 0.00005, 0.075,
     0.00000, 0.00003, 5.997,
     0.00000, 0.00003, 0.037,
     0.00000, 0.00001, 0.088
 };
-double tidal_distance_1_coefficients[TOTAL_TIDAL_DISTANCE_1_TERMS * 3] = {
+ELP_DATA double tidal_distance_1_coefficients[TOTAL_TIDAL_DISTANCE_1_TERMS * 3] = {
     90.00000, 0.00356, 99999.999,
     270.00000, 0.00072, 0.075,
     270.00000, 0.00003, 0.038,
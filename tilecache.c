@@ -0,0 +1,487 @@
+/*
+ * tilecache.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "tilecache.h"
+#include "chebfile.h"
+#include "elp2000-82b.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TILE_MAGIC "ELPTILE"                // signature of the keys of tiles
+#define TILE_KEY_VERSION 1                  // version of the keys, changed whenever content of a key may change
+#define TILE_NAME_SIZE 22                   // size of the name of a tile: 16 hexadecimal digits, ".elpc" and zero
+#define SLOT_HASH 0x9e3779b97f4a7c15ULL     // multiplier of Fibonacci hashing
+#define MAX_GRANULE_INDEX 4503599627370496.0    // 2⁵², bound of indices of granules, beyond which t has no fraction
+
+/*
+ * A datatype describing everything determining content of a tile; its checksum is the name of the tile.
+ */
+typedef struct {
+    char magic[8];              // TILE_MAGIC
+    uint32_t version;           // TILE_KEY_VERSION
+    int32_t frame;              // frame of the tile
+    int32_t degree;             // degree of the polynomials
+    int32_t granules;           // amount of granules of the tile
+    double granule;             // length of a granule, Julian centuries
+    int64_t index;              // index of the tile
+} tile_key;
+
+/*
+ * A datatype describing a tile used by the process: mapped from the directory or, if the directory is not writable,
+ * fitted in memory.
+ */
+typedef struct {
+    int64_t index;                      // index of the tile
+    int frame;                          // frame of the tile
+    int mapped;                         // non zero if the tile is mapped from a file
+    chebyshev_file file;                // mapped file of the tile
+    chebyshev_ephemeris ephemeris;      // approximation of the tile
+} tile;
+
+/*
+ * A datatype describing a tile being loaded by a thread, so that other threads needing it wait for it instead of
+ * loading it again.
+ */
+typedef struct tile_loading {
+    int64_t index;                      // index of the tile
+    int frame;                          // frame of the tile
+    struct tile_loading *next;          // next tile being loaded
+} tile_loading;
+
+/*
+ * A datatype describing an open addressed table of tiles used by the process. Tables are grown by doubling; outgrown
+ * ones are kept until the cache is closed, since readers may still probe them.
+ */
+typedef struct tile_table {
+    size_t size;                        // amount of slots, a power of two
+    size_t count;                       // amount of tiles in the table
+    struct tile_table *previous;        // outgrown table, NULL for the first one
+    tile *_Atomic slots[];              // tiles, NULL for empty slots
+} tile_table;
+
+/*
+ * State of the cache.
+ */
+typedef struct {
+    char *directory;                    // directory holding the tiles
+    double granule;                     // length of a granule, Julian centuries
+    int degree;                         // degree of the polynomials
+    int granules;                       // amount of granules of a tile
+    pthread_mutex_t lock;               // lock serializing insertion of tiles and growth of the table
+    pthread_cond_t loaded;              // condition signalled whenever loading of a tile finishes
+    tile_loading *loading;              // tiles being loaded
+    tile_table *_Atomic table;          // table of tiles used by the process
+    atomic_ulong hits;
+    atomic_ulong loads;
+    atomic_ulong fits;
+    atomic_ulong corrupted;
+} tile_cache;
+
+static tile_cache *_Atomic cache;   // open cache, NULL if the cache is closed
+
+/*
+ * Allocates an empty table of tiles of the given amount of slots. Returns NULL if memory could not be allocated.
+ */
+static tile_table *create_table(size_t size)
+{
+    tile_table *table;          // new table
+    size_t i;                   // loop index variable
+
+    if ((table = malloc(sizeof(tile_table) + sizeof(tile *) * size)) == NULL)
+        return NULL;
+
+    table->size = size;
+    table->count = 0;
+    table->previous = NULL;
+    for (i = 0; i < size; i++)
+        atomic_init(&table->slots[i], NULL);
+
+    return table;
+}
+
+/*
+ * Returns the first slot probed for the tile with the given index and frame in a table of the given size.
+ */
+static size_t first_slot(int64_t index, int frame, size_t size)
+{
+    uint64_t key = (uint64_t)index * TOTAL_ELP_FRAMES + frame;  // key of the tile in the table
+
+    return (size_t)((key * SLOT_HASH) >> 32) & (size - 1);
+}
+
+/*
+ * Stores the given tile into the first empty slot of its probe sequence. The table must have an empty slot.
+ */
+static void place_tile(tile_table *table, tile *p)
+{
+    size_t slot;                // current slot of the table
+
+    slot = first_slot(p->index, p->frame, table->size);
+    while (atomic_load_explicit(&table->slots[slot], memory_order_relaxed) != NULL)
+        slot = (slot + 1) & (table->size - 1);
+    atomic_store_explicit(&table->slots[slot], p, memory_order_release);
+    table->count++;
+}
+
+/*
+ * Releases a tile.
+ */
+static void free_tile(tile *p)
+{
+    if (p->mapped)
+        chebyshev_file_unmap(&p->file);
+    else
+        chebyshev_free(&p->ephemeris);
+    free(p);
+}
+
+int tile_cache_open(const char *directory, double granule, int degree, int granules)
+{
+    tile_cache *c;              // new cache
+    tile_cache *expected;       // expected state of the cache
+
+    granule = granule == 0.0 ? TILE_CACHE_GRANULE : granule;
+    degree = degree == 0 ? TILE_CACHE_DEGREE : degree;
+    granules = granules == 0 ? TILE_CACHE_GRANULES : granules;
+    if (!(granule > 0.0) || degree < CHEBYSHEV_MIN_DEGREE || degree > CHEBYSHEV_MAX_DEGREE || granules < 1)
+        return -1;
+    if (atomic_load(&cache) != NULL || (c = calloc(1, sizeof(tile_cache))) == NULL)
+        return -1;
+    if ((c->directory = strdup(directory)) == NULL || (c->table = create_table(TILE_CACHE_SLOTS)) == NULL){
+        free(c->directory);
+        free(c);
+        return -1;
+    }
+
+    c->granule = granule;
+    c->degree = degree;
+    c->granules = granules;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->loaded, NULL);
+
+    expected = NULL;
+    if (!atomic_compare_exchange_strong(&cache, &expected, c)){
+        pthread_mutex_destroy(&c->lock);
+        pthread_cond_destroy(&c->loaded);
+        free(c->table);
+        free(c->directory);
+        free(c);
+        return -1;
+    }
+
+    return 0;
+}
+
+void tile_cache_close(void)
+{
+    tile_cache *c = atomic_exchange(&cache, NULL);
+    tile_table *table;          // current table
+    tile_table *previous;       // table outgrown by the current one
+    tile *p;                    // current tile
+    size_t i;                   // loop index variable
+
+    if (c == NULL)
+        return;
+
+    // the last table holds all tiles
+    table = atomic_load(&c->table);
+    for (i = 0; i < table->size; i++)
+        if ((p = atomic_load(&table->slots[i])) != NULL)
+            free_tile(p);
+    for (; table != NULL; table = previous){
+        previous = table->previous;
+        free(table);
+    }
+    pthread_mutex_destroy(&c->lock);
+    pthread_cond_destroy(&c->loaded);
+    free(c->directory);
+    free(c);
+}
+
+int tile_cache_running(void)
+{
+    return atomic_load_explicit(&cache, memory_order_acquire) != NULL;
+}
+
+/*
+ * Looks for the tile with the given index and frame among tiles used by the process. Returns NULL if it is not found.
+ */
+static tile *find_tile(tile_cache *c, int64_t index, int frame)
+{
+    tile_table *table = atomic_load_explicit(&c->table, memory_order_acquire);  // current table
+    size_t slot;                // current slot of the table
+    tile *p;                    // tile of the current slot
+
+    // tables are at most half full, thus every probe sequence ends at an empty slot
+    for (slot = first_slot(index, frame, table->size); ; slot = (slot + 1) & (table->size - 1)){
+        if ((p = atomic_load_explicit(&table->slots[slot], memory_order_acquire)) == NULL)
+            return NULL;
+        if (p->index == index && p->frame == frame)
+            return p;
+    }
+}
+
+/*
+ * Inserts the given tile into the table of tiles used by the process, doubling the table when it gets half full.
+ * Must be called with the lock held. Returns zero on success or a negative value if memory could not be allocated.
+ */
+static int insert_tile(tile_cache *c, tile *p)
+{
+    tile_table *table = atomic_load_explicit(&c->table, memory_order_relaxed);  // current table
+    tile_table *grown;          // doubled table
+    tile *q;                    // tile of the current slot
+    size_t i;                   // loop index variable
+
+    if (2 * (table->count + 1) > table->size){
+        if ((grown = create_table(2 * table->size)) == NULL)
+            return -1;
+        for (i = 0; i < table->size; i++)
+            if ((q = atomic_load_explicit(&table->slots[i], memory_order_relaxed)) != NULL)
+                place_tile(grown, q);
+        grown->previous = table;
+        atomic_store_explicit(&c->table, grown, memory_order_release);
+        table = grown;
+    }
+    place_tile(table, p);
+
+    return 0;
+}
+
+/*
+ * Writes the path of the file of the tile with the given index and frame into the given buffer of at least
+ * strlen(c->directory) + TILE_NAME_SIZE + 1 bytes.
+ */
+static void tile_path(const tile_cache *c, int64_t index, int frame, char path[])
+{
+    tile_key key;               // key of the tile
+
+    memset(&key, 0, sizeof(key));
+    memcpy(key.magic, TILE_MAGIC, sizeof(TILE_MAGIC));
+    key.version = TILE_KEY_VERSION;
+    key.frame = frame;
+    key.degree = c->degree;
+    key.granules = c->granules;
+    key.granule = c->granule;
+    key.index = index;
+
+    sprintf(path, "%s/%016" PRIx64 ".elpc", c->directory, chebyshev_file_checksum(&key, sizeof(key)));
+}
+
+/*
+ * Maps the file of the tile with the given index and frame and checks that it holds the tile and is intact.
+ * Returns zero on success or one of Chebyshev_file_errors.
+ */
+static int map_tile(const tile_cache *c, const char *path, tile *p)
+{
+    const chebyshev_file_header *header;    // header of the mapped file
+    int error;                              // error of mapping or checking the file
+
+    if ((error = chebyshev_file_map(path, &p->file)) < 0)
+        return error;
+
+    header = p->file.header;
+    if (header->frame != p->frame || header->degree != c->degree || header->granules != c->granules ||
+        header->granule != c->granule || header->start != (double)p->index * c->granules * c->granule)
+        error = CHEBYSHEV_FILE_FORMAT_ERROR;
+    else
+        error = chebyshev_file_verify(&p->file);
+
+    if (error < 0)
+        chebyshev_file_unmap(&p->file);
+
+    return error;
+}
+
+/*
+ * Reads the tile with the given index and frame: maps its file if the directory holds an intact one, or fits the tile
+ * and writes its file otherwise. Returns NULL if the tile could not be read.
+ */
+static tile *read_tile(tile_cache *c, int64_t index, int frame)
+{
+    chebyshev_ephemeris fit;    // approximation of a fitted tile
+    char *path;                 // path of the file of the tile
+    double start;               // beginning of the tile, Julian centuries
+    tile *p;                    // read tile
+    int error;                  // error of mapping the file
+
+    if ((p = malloc(sizeof(tile))) == NULL || (path = malloc(strlen(c->directory) + TILE_NAME_SIZE + 1)) == NULL){
+        free(p);
+        return NULL;
+    }
+    p->index = index;
+    p->frame = frame;
+    tile_path(c, index, frame, path);
+
+    if ((error = map_tile(c, path, p)) == 0){
+        atomic_fetch_add_explicit(&c->loads, 1, memory_order_relaxed);
+    } else {
+        // a file that exists but cannot be used is removed, so that the tile is written again
+        if (error != CHEBYSHEV_FILE_IO_ERROR){
+            atomic_fetch_add_explicit(&c->corrupted, 1, memory_order_relaxed);
+            unlink(path);
+        }
+
+        // the end of the time span is put in the middle of the last granule, so that rounding cannot add a granule
+        start = (double)index * c->granules * c->granule;
+        if (chebyshev_fit(start, start + (c->granules - 0.5) * c->granule, frame, c->granule, c->degree, &fit) < 0){
+            free(path);
+            free(p);
+            return NULL;
+        }
+        atomic_fetch_add_explicit(&c->fits, 1, memory_order_relaxed);
+
+        // the tile is used from its file once written, and kept in memory if the directory is not writable
+        error = chebyshev_file_write(path, &fit) == 0 ? map_tile(c, path, p) : CHEBYSHEV_FILE_IO_ERROR;
+        if (error == 0)
+            chebyshev_free(&fit);
+        else
+            p->ephemeris = fit;
+    }
+    p->mapped = error == 0;
+    if (p->mapped)
+        p->ephemeris = p->file.ephemeris;
+    free(path);
+
+    return p;
+}
+
+/*
+ * Loads the tile with the given index and frame (see read_tile) into the table. The lock is not held while the tile is
+ * mapped or fitted, thus threads loading other tiles proceed concurrently, while threads needing the same tile wait for
+ * it. Returns NULL if the tile could not be loaded.
+ */
+static tile *load_tile(tile_cache *c, int64_t index, int frame)
+{
+    tile_loading loading;       // entry of the tile among tiles being loaded
+    tile_loading **entry;       // link to an entry of tiles being loaded
+    tile *p;                    // loaded tile
+
+    // waiting while other thread loads the tile, which it might have finished meanwhile
+    pthread_mutex_lock(&c->lock);
+    for (;;){
+        if ((p = find_tile(c, index, frame)) != NULL){
+            pthread_mutex_unlock(&c->lock);
+            return p;
+        }
+        for (entry = &c->loading; *entry != NULL && ((*entry)->index != index || (*entry)->frame != frame);
+             entry = &(*entry)->next)
+            ;
+        if (*entry == NULL)
+            break;
+        pthread_cond_wait(&c->loaded, &c->lock);
+    }
+    loading.index = index;
+    loading.frame = frame;
+    loading.next = c->loading;
+    c->loading = &loading;
+    pthread_mutex_unlock(&c->lock);
+
+    p = read_tile(c, index, frame);
+
+    // publishing the tile and waking threads waiting for it, which load it themselves if loading failed
+    pthread_mutex_lock(&c->lock);
+    if (p != NULL && insert_tile(c, p) < 0){
+        free_tile(p);
+        p = NULL;
+    }
+    for (entry = &c->loading; *entry != &loading; entry = &(*entry)->next)
+        ;
+    *entry = loading.next;
+    pthread_cond_broadcast(&c->loaded);
+    pthread_mutex_unlock(&c->lock);
+
+    return p;
+}
+
+/*
+ * Returns the tile holding the granule covering time instant t in the given frame, loading it if it is not used yet.
+ * Index of the granule within the tile is stored into the given variable. Returns NULL if t is not finite or too far
+ * from J2000 for granules to be indexed, or if the tile could not be loaded.
+ */
+static tile *get_tile(tile_cache *c, double t, int frame, int *offset)
+{
+    double u;                   // time since J2000 measured in granules
+    int64_t granule;            // index of the granule
+    int64_t index;              // index of the tile
+    tile *p;                    // tile holding the granule
+
+    // the bound is applied before the conversion, which is undefined for values out of the range of int64_t
+    u = floor(t / c->granule);
+    if (!isfinite(u) || fabs(u) > MAX_GRANULE_INDEX)
+        return NULL;
+    granule = (int64_t)u;
+
+    index = granule >= 0 ? granule / c->granules : -((-granule - 1) / c->granules) - 1;
+    *offset = (int)(granule - index * c->granules);
+
+    if ((p = find_tile(c, index, frame)) != NULL){
+        atomic_fetch_add_explicit(&c->hits, 1, memory_order_relaxed);
+        return p;
+    }
+
+    return load_tile(c, index, frame);
+}
+
+void tile_cache_position(double t, int frame, double position[], double velocity[], double error[])
+{
+    tile_cache *c = atomic_load_explicit(&cache, memory_order_acquire);
+    int offset;                 // index of the granule within the tile
+    tile *p;                    // tile covering t
+
+    if ((p = get_tile(c, t, frame, &offset)) == NULL){
+        geocentric_moon_positions(&t, 1, frame, position);
+        if (velocity != NULL)
+            velocity[0] = velocity[1] = velocity[2] = NAN;
+        if (error != NULL)
+            error[0] = error[1] = error[2] = 0.0;
+        return;
+    }
+
+    chebyshev_evaluate(&p->ephemeris, t, position, velocity);
+    if (error != NULL)
+        chebyshev_residual(&p->ephemeris, t, error);
+}
+
+int tile_cache_segment(double t, int frame, double granule, int degree, double coefficients[])
+{
+    tile_cache *c = atomic_load_explicit(&cache, memory_order_acquire);
+    int offset;                 // index of the granule within the tile
+    int n;                      // amount of coefficients of a granule
+    tile *p;                    // tile covering t
+
+    if (c == NULL || granule != c->granule || degree != c->degree)
+        return -1;
+    if ((p = get_tile(c, t, frame, &offset)) == NULL)
+        return -1;
+
+    n = 3 * (degree + 1);
+    memcpy(coefficients, &p->ephemeris.coefficients[offset * n], sizeof(double) * n);
+
+    return 0;
+}
+
+void tile_cache_get_counters(tile_cache_counters *counters)
+{
+    tile_cache *c = atomic_load_explicit(&cache, memory_order_acquire);
+
+    if (c == NULL){
+        counters->hits = counters->loads = counters->fits = counters->corrupted = 0;
+        return;
+    }
+
+    counters->hits = atomic_load_explicit(&c->hits, memory_order_relaxed);
+    counters->loads = atomic_load_explicit(&c->loads, memory_order_relaxed);
+    counters->fits = atomic_load_explicit(&c->fits, memory_order_relaxed);
+    counters->corrupted = atomic_load_explicit(&c->corrupted, memory_order_relaxed);
+}
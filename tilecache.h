@@ -0,0 +1,92 @@
+/*
+ * tilecache.h
+ *
+ * This file contains routines to manage an opt-in persistent cache of Chebyshev approximations (see chebyshev.h) kept
+ * in a directory, so that restarted processes find positions computed by their predecessors instead of computing the
+ * series again.
+ *
+ * Time is split into tiles of a fixed amount of granules counted from J2000. Each tile is a Chebyshev file (see
+ * chebfile.h) holding the approximation of a single tile in a single frame. Tiles are immutable and content addressed:
+ * the name of a tile is the checksum of everything determining its content (layout version, frame, granule length,
+ * degree, amount of granules and index of the tile), thus tiles of different accuracies or frames share a directory,
+ * and a tile is never rewritten with other content. Tiles are written under temporary names and renamed when complete
+ * (see chebyshev_file_write), so that any number of processes fill and read a directory concurrently; processes racing
+ * for the same tile write identical files. A tile is mapped once per process and its checksum is checked before first
+ * use; corrupted tiles are removed and fitted again. Tiles stay mapped until the cache is closed, the table of tiles
+ * growing as needed, so that a restarted process never computes the series for a tile found in the directory. Tiles are
+ * fitted without holding the lock of the cache, thus threads using other tiles are not delayed.
+ *
+ * While the cache is open geocentric_moon_position and geocentric_moon_position_in_frame (as well as the routines
+ * built upon geocentric_moon_position) return positions computed from the tiles, and the in-memory cache of segments
+ * (see segcache.h) takes its segments from the tiles if it uses the same granule length and degree. Batch and parallel
+ * routines always compute the series.
+ */
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TILE_CACHE_GRANULES 256                 // default amount of granules of a tile
+#define TILE_CACHE_GRANULE (4.0 / 36525.0)      // default granule length, Julian centuries (4 days)
+#define TILE_CACHE_DEGREE 14                    // default degree of the polynomials
+#define TILE_CACHE_SLOTS 4096                   // initial amount of slots of the table of tiles, a power of two
+
+/*
+ * A datatype holding counters of the cache.
+ */
+typedef struct {
+    unsigned long hits;         // queries computed from a tile mapped before
+    unsigned long loads;        // tiles found in the directory and mapped
+    unsigned long fits;         // tiles fitted and written into the directory
+    unsigned long corrupted;    // tiles found corrupted and fitted again
+} tile_cache_counters;
+
+/*
+ * Opens the cache in the given directory, which must exist, with tiles of the given amount of granules of the given
+ * length (Julian centuries) approximated by polynomials of the given degree. Zero granule, degree or granules select
+ * defaults TILE_CACHE_GRANULE, TILE_CACHE_DEGREE and TILE_CACHE_GRANULES.
+ * Returns zero on success or a negative value if the cache is already open, the arguments are invalid or memory could
+ * not be allocated.
+ */
+int tile_cache_open(const char *directory, double granule, int degree, int granules);
+
+/*
+ * Closes the cache and unmaps its tiles. Must not be called while other threads query positions.
+ */
+void tile_cache_close(void);
+
+/*
+ * Returns non zero if the cache is open.
+ */
+int tile_cache_running(void);
+
+/*
+ * Computes position of the Moon at time instant t in the given frame (one of ELP_frames) and its velocity, measured in
+ * units of the coordinates per Julian century, from the tile covering t, loading or fitting it if it is not mapped yet.
+ * The estimate of the error of the tile at t (see chebyshev_residual) is written into the error array. Velocity and
+ * error may be NULL; velocity is set to NAN and error to zero if t is not finite or too far from J2000 to be split into
+ * granules, or the tile could not be loaded or fitted, and the position is computed from the series. The cache must be
+ * open.
+ */
+void tile_cache_position(double t, int frame, double position[], double velocity[], double error[]);
+
+/*
+ * Copies coefficients of the granule of the given length and degree covering time instant t in the given frame from
+ * its tile. Returns zero on success or a negative value if the cache is not open, it uses another granule length or
+ * degree, or the tile could not be loaded or fitted.
+ */
+int tile_cache_segment(double t, int frame, double granule, int degree, double coefficients[]);
+
+/*
+ * Reads counters of the cache.
+ */
+void tile_cache_get_counters(tile_cache_counters *counters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TILECACHE_H